@@ -0,0 +1,15 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+
+//minimum time spent on each case so the numbers are stable
+#define MIN_SECONDS 0.5
+
+//wall clock in seconds, clock() would add up the time of every thread and
+//miss the time spent waiting for the gpu
+inline double now(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
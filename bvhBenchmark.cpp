@@ -0,0 +1,190 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "scene/BVH.h"
+using namespace std;
+
+//atoms in the synthetic scene unless given on the command line
+#define DEFAULT_ATOMS 2000000
+//lattice spacing, close enough for neighbours along x to be bonded
+#define ATOM_SPACING 1.5
+//queries checked against a linear scan over every primitive
+#define CHECK_QUERIES 20
+
+float randomFloat(){
+	return rand() / (float)RAND_MAX;
+}
+
+//a jittered cubic lattice of ball & stick atoms, each bonded to the next
+//one along x, like one huge molecule
+void generateScene(vector<struct bvhPrimitive>& primitives, int numAtoms, int* dim){
+	*dim = (int)ceil(cbrt((double)numAtoms));
+	primitives.clear();
+	primitives.reserve(numAtoms * 2);
+	vector<GLfloat> positions(numAtoms * 3);
+	for(int i = 0; i < numAtoms; i++){
+		int x = i % *dim;
+		int y = i / *dim % *dim;
+		int z = i / (*dim * *dim);
+		positions[i*3] = x * ATOM_SPACING + (randomFloat() - 0.5) * 0.3;
+		positions[i*3+1] = y * ATOM_SPACING + (randomFloat() - 0.5) * 0.3;
+		positions[i*3+2] = z * ATOM_SPACING + (randomFloat() - 0.5) * 0.3;
+		struct bvhPrimitive atom;
+		for(int axis = 0; axis < 3; axis++){
+			atom.start[axis] = positions[i*3+axis];
+			atom.end[axis] = positions[i*3+axis];
+		}
+		atom.radius = 0.5;
+		atom.type = SPHERE_PRIMITIVE;
+		atom.index = i;
+		primitives.push_back(atom);
+	}
+	int numBonds = 0;
+	for(int i = 0; i + 1 < numAtoms; i++){
+		if((i + 1) % *dim == 0) continue;
+		struct bvhPrimitive bond;
+		for(int axis = 0; axis < 3; axis++){
+			bond.start[axis] = positions[i*3+axis];
+			bond.end[axis] = positions[(i+1)*3+axis];
+		}
+		bond.radius = 0.166;
+		bond.type = CAPSULE_PRIMITIVE;
+		bond.index = numBonds++;
+		primitives.push_back(bond);
+	}
+}
+
+//rays start outside the lattice and aim at a random point inside it
+void randomRay(int dim, GLfloat* origin, GLfloat* direction){
+	float size = dim * ATOM_SPACING;
+	GLfloat target[3];
+	for(int axis = 0; axis < 3; axis++){
+		target[axis] = randomFloat() * size;
+		direction[axis] = randomFloat() - 0.5;
+	}
+	float length = sqrt(direction[0]*direction[0] + direction[1]*direction[1] + direction[2]*direction[2]);
+	for(int axis = 0; axis < 3; axis++){
+		direction[axis] /= length;
+		origin[axis] = target[axis] - direction[axis] * size * 2;
+	}
+}
+
+void randomPoint(int dim, GLfloat* point){
+	for(int axis = 0; axis < 3; axis++){
+		point[axis] = randomFloat() * dim * ATOM_SPACING;
+	}
+}
+
+//a tree over a single primitive answers the same query as the primitive
+//itself, which gives a linear scan without exposing the intersection tests
+void bruteForce(const vector<struct bvhPrimitive>& primitives, const GLfloat* origin, const GLfloat* direction,
+                const GLfloat* point, GLint* rayIndex, GLint* pointIndex){
+	float bestRay = 1e30;
+	float bestPoint = 1e30;
+	*rayIndex = -1;
+	*pointIndex = -1;
+	BVH single;
+	int numPrimitives = primitives.size();
+	for(int i = 0; i < numPrimitives; i++){
+		single.build(&(primitives[i]),1);
+		struct bvhHit hit;
+		if(single.raycast(origin,direction,bestRay,&hit) && hit.distance < bestRay){
+			bestRay = hit.distance;
+			*rayIndex = primitives[i].type * numPrimitives + primitives[i].index;
+		}
+		if(single.closestPrimitive(point,bestPoint,&hit) && hit.distance < bestPoint){
+			bestPoint = hit.distance;
+			*pointIndex = primitives[i].type * numPrimitives + primitives[i].index;
+		}
+	}
+}
+
+int main (int argc, char** argv){
+	int numAtoms = argc > 1 ? atoi(argv[1]) : DEFAULT_ATOMS;
+	int dim;
+	vector<struct bvhPrimitive> primitives;
+	srand(1);
+	generateScene(primitives,numAtoms,&dim);
+	int numPrimitives = primitives.size();
+	printf("%d atoms %d primitives\n",numAtoms,numPrimitives);
+
+	BVH bvh;
+	int maxThreads = bvh.getNumThreads();
+	for(int threads = 1; ; threads *= 2){
+		if(threads > maxThreads) threads = maxThreads;
+		bvh.setNumThreads(threads);
+		double start = now();
+		bvh.build(&primitives[0],numPrimitives);
+		printf("build %2d threads %9.2f ms  %d nodes\n",threads,(now() - start) * 1000.0,bvh.getNumNodes());
+		if(threads == maxThreads) break;
+	}
+
+	//every primitive moves a little, the tree keeps its topology
+	BVHPrimitive sorted = bvh.getPrimitives();
+	for(int i = 0; i < numPrimitives; i++){
+		float shift = (randomFloat() - 0.5) * 0.2;
+		for(int axis = 0; axis < 3; axis++){
+			sorted[i].start[axis] += shift;
+			sorted[i].end[axis] += shift;
+		}
+	}
+	double start = now();
+	bvh.refit();
+	printf("refit           %9.2f ms\n",(now() - start) * 1000.0);
+
+	const char* names[3] = {"nearest ray","all hits","closest point"};
+	vector<struct bvhHit> hits;
+	for(int query = 0; query < 3; query++){
+		int queries = 0;
+		long found = 0;
+		double elapsed = 0;
+		start = now();
+		while(elapsed < MIN_SECONDS){
+			for(int i = 0; i < 1000; i++){
+				GLfloat origin[3];
+				GLfloat direction[3];
+				struct bvhHit hit;
+				if(query == 2){
+					randomPoint(dim,origin);
+					found += bvh.closestPrimitive(origin,1e30,&hit);
+					continue;
+				}
+				randomRay(dim,origin,direction);
+				if(query == 0) found += bvh.raycast(origin,direction,1e30,&hit);
+				else found += bvh.raycastAll(origin,direction,1e30,hits);
+			}
+			queries += 1000;
+			elapsed = now() - start;
+		}
+		printf("%-14s %12.0f queries/s %8.3f us/query  %.2f found/query\n",
+			names[query],
+			queries / elapsed,
+			elapsed * 1e6 / queries,
+			(double)found / queries
+		);
+	}
+
+	//the refit tree against a linear scan over the moved primitives
+	vector<struct bvhPrimitive> moved(sorted,sorted + numPrimitives);
+	int errors = 0;
+	for(int i = 0; i < CHECK_QUERIES; i++){
+		GLfloat origin[3];
+		GLfloat direction[3];
+		GLfloat point[3];
+		randomRay(dim,origin,direction);
+		randomPoint(dim,point);
+		GLint rayIndex;
+		GLint pointIndex;
+		bruteForce(moved,origin,direction,point,&rayIndex,&pointIndex);
+		struct bvhHit hit;
+		GLint index = bvh.raycast(origin,direction,1e30,&hit) ? hit.type * numPrimitives + hit.index : -1;
+		if(index != rayIndex) errors++;
+		index = bvh.closestPrimitive(point,1e30,&hit) ? hit.type * numPrimitives + hit.index : -1;
+		if(index != pointIndex) errors++;
+	}
+	printf("%d/%d queries differ from a linear scan\n",errors,CHECK_QUERIES * 2);
+	return 0;
+}
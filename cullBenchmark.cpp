@@ -0,0 +1,237 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cmath>
+#include <list>
+#include <vector>
+#include "benchmark.h"
+#include "object/Mesh.h"
+#include "scene/Camera.h"
+#include "scene/Octree.h"
+#include "scene/Scene.h"
+#include "scene/MoleculeGrid.h"
+#include "math/Frustum.h"
+using namespace std;
+
+//objects are spread over a cube this wide, inside the scene octree
+#define WORLD_SIZE 120.0
+//largest object count, every case uses a prefix of the same objects
+#define MAX_OBJECTS 65536
+//frames the moving scene is checked against brute force after timing
+#define CHECK_FRAMES 100
+//time between frames of the moving scene in milliseconds, 60 frames a second
+#define FRAME_MILLISECONDS 16
+
+//previous OctreeNode::calculateVisibility test: the 8 corners are projected
+//and the screen space box is compared against the unit cube
+bool legacyVisible(const Mat4& viewProjection, BoundingBox box){
+	GLfloat vertices[24];
+	GLfloat min[3] = {9999,9999,9999};
+	GLfloat max[3] = {-9999,-9999,-9999};
+	for(int i = 0; i < 8 ; i++){
+		vertices[i*3] = box->x[(i & 1 ? 1 :0)];
+		vertices[i*3+1] = box->y[(i & 2 ? 1 :0)];
+		vertices[i*3+2] = box->z[(i & 4 ? 1 :0)];
+	}
+	Mat4::transformPoints(viewProjection,vertices,vertices,8,3,1,true);
+	for(int i = 0; i < 8 ; i++){
+		for(int axis = 0; axis < 3; axis++){
+			min[axis] = fmin(min[axis],vertices[i*3+axis]);
+			max[axis] = fmax(max[axis],vertices[i*3+axis]);
+		}
+	}
+	return min[0] < 1 && min[1] < 1 && min[2] < 1 &&
+	       max[0] > -1 && max[1] > -1 && max[2] > -1;
+}
+
+//the camera turns a little every frame so the frustum is rebuilt each time
+void moveCamera(Camera* camera, Frustum* frustum, int frame){
+	float angle = frame * 0.01;
+	camera->setPosition(Vec3(sin(angle) * 70.0,10,cos(angle) * 70.0));
+	camera->updateWorldMatrix();
+	frustum->setFromMatrix(*(camera->getProjectionMatrix()) * *(camera->getWorldMatrix()));
+}
+
+void benchmark(vector<Mesh*>& meshes, int numObjects, Camera* camera, int depth){
+	list<Object3D*> objects(meshes.begin(),meshes.begin() + numObjects);
+	vector<BoundingBox> boxes(numObjects);
+	for(int i = 0; i < numObjects; i++){
+		boxes[i] = meshes[i]->getBoundingBox();
+	}
+	Octree octree(Vec3(0,0,0),128,depth);
+	Frustum frustum;
+	vector<Object3D*> visible;
+	visible.reserve(numObjects);
+
+	clock_t start = clock();
+	octree.build(objects);
+	double buildTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	//every case runs over the same camera path
+	double times[3];
+	int counts[3];
+	for(int method = 0; method < 3; method++){
+		int frames = 0;
+		double elapsed = 0;
+		start = clock();
+		while(elapsed < MIN_SECONDS){
+			moveCamera(camera,&frustum,frames);
+			int count = 0;
+			if(method == 0){
+				Mat4 viewProjection = *(camera->getProjectionMatrix()) * *(camera->getWorldMatrix());
+				for(int i = 0; i < numObjects; i++){
+					if(legacyVisible(viewProjection,boxes[i])) count++;
+				}
+			}
+			else if(method == 1){
+				for(int i = 0; i < numObjects; i++){
+					GLfloat min[3] = {boxes[i]->x[0],boxes[i]->y[0],boxes[i]->z[0]};
+					GLfloat max[3] = {boxes[i]->x[1],boxes[i]->y[1],boxes[i]->z[1]};
+					if(frustum.intersectsBounds(min,max)) count++;
+				}
+			}
+			else{
+				count = octree.cull(frustum,visible);
+			}
+			if(frames == 0) counts[method] = count;
+			frames++;
+			elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+		}
+		times[method] = elapsed * 1000.0 / frames;
+	}
+	//the octree runs the same plane test per object as the brute force
+	//case, on the first frame both have to find the same objects
+	bool mismatch = counts[1] != counts[2];
+	CullStats stats = octree.getStats();
+	printf("%6d objects  build %7.3f ms  project %8.4f ms  planes %8.4f ms  octree %8.4f ms"
+	       "  visible %d/%d/%d  nodes %d tests %d%s\n",
+		numObjects,
+		buildTime * 1000.0,
+		times[0],
+		times[1],
+		times[2],
+		counts[0],
+		counts[1],
+		counts[2],
+		stats->nodesVisited,
+		stats->objectsTested,
+		mismatch ? "  MISMATCH" : ""
+	);
+}
+
+int bruteForceCount(Scene* scene){
+	list<Object3D*> objects = scene->getObjects();
+	list<Object3D*>::iterator it = objects.begin();
+	int count = 0;
+	for(;it != objects.end();it++){
+		BoundingBox box = ((Mesh*)(*it))->getBoundingBox();
+		GLfloat min[3] = {box->x[0],box->y[0],box->z[0]};
+		GLfloat max[3] = {box->x[1],box->y[1],box->z[1]};
+		if(scene->getFrustum()->intersectsBounds(min,max)) count++;
+	}
+	return count;
+}
+
+//a dim^3 grid of molecules with three child meshes each like main.cpp,
+//all of them moved every frame, the octree is rebuilt every frame or
+//updated in place
+void benchmarkMoving(Geometry* cube, int dim, int depth){
+	int numMolecules = dim*dim*dim;
+	Scene* scene = new Scene();
+	scene->getOctree()->setDepth(depth);
+	vector<Object3D*> molecules(numMolecules);
+	for(int i = 0; i < numMolecules; i++){
+		molecules[i] = new Object3D();
+		for(int child = 0; child < 3; child++){
+			Mesh* mesh = new Mesh(cube,NULL);
+			mesh->setScale(Vec3(6,6,6));
+			mesh->setParent(molecules[i]);
+			molecules[i]->objects.push_back(mesh);
+			scene->addObject(mesh);
+		}
+	}
+	Camera* camera = scene->getCamera();
+	camera->setPosition(Vec3(0,0,60));
+	camera->setTarget(Vec3(0,0,0));
+	camera->updateWorldMatrix();
+	vector<Object3D*> visible;
+
+	const char* modes[3] = {"static","rebuild","update"};
+	for(int mode = 0; mode < 3; mode++){
+		int frames = 0;
+		long moved = 0;
+		int count = 0;
+		double elapsed = 0;
+		clock_t cullTime = 0;
+		clock_t start = clock();
+		while(elapsed < MIN_SECONDS){
+			if(mode != 0){
+				for(int i = 0; i < numMolecules; i++){
+					MoleculeGrid::move(molecules[i],i,dim,frames * FRAME_MILLISECONDS);
+				}
+			}
+			scene->updateMatrices();
+			//octree maintenance and culling, the matrices are not included
+			clock_t cullStart = clock();
+			if(mode == 1){
+				scene->generateOctree();
+			}
+			count = scene->cullObjects(visible);
+			cullTime += clock() - cullStart;
+			moved += scene->getOctree()->getStats()->objectsMoved;
+			frames++;
+			elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+		}
+		printf("%4d molecules %-8s %8.4f ms/frame  %8.4f ms octree and cull  %6.1f relinked/frame  visible %d\n",
+			numMolecules,
+			modes[mode],
+			elapsed * 1000.0 / frames,
+			(double)cullTime * 1000.0 / CLOCKS_PER_SEC / frames,
+			(double)moved / frames,
+			count
+		);
+	}
+
+	int errors = 0;
+	for(int frame = 0; frame < CHECK_FRAMES; frame++){
+		for(int i = 0; i < numMolecules; i++){
+			MoleculeGrid::move(molecules[i],i,dim,frame * 7 * FRAME_MILLISECONDS);
+		}
+		scene->updateMatrices();
+		if(scene->cullObjects(visible) != bruteForceCount(scene)) errors++;
+	}
+	printf("%4d molecules %d/%d frames differ from brute force\n",numMolecules,errors,CHECK_FRAMES);
+	//like the meshes below, the scene is not deleted
+}
+
+int main (int argc, char** argv){
+	int depth = argc > 1 ? atoi(argv[1]) : OCTREE_DEFAULT_DEPTH;
+	Geometry* cube = Geometry::generateCubeGeometry(1);
+	vector<Mesh*> meshes(MAX_OBJECTS);
+	srand(1);
+	for(int i = 0; i < MAX_OBJECTS; i++){
+		meshes[i] = new Mesh(cube,NULL);
+		meshes[i]->setPosition(Vec3(
+			(rand() / (float)RAND_MAX - 0.5) * WORLD_SIZE,
+			(rand() / (float)RAND_MAX - 0.5) * WORLD_SIZE,
+			(rand() / (float)RAND_MAX - 0.5) * WORLD_SIZE
+		));
+		float scale = 0.5 + rand() / (float)RAND_MAX * 2.0;
+		meshes[i]->setScale(Vec3(scale,scale,scale));
+		meshes[i]->updateModelMatrix();
+	}
+	Camera* camera = new Camera();
+	camera->setProjectionMatrix(Mat4::perspectiveMatrix(30.0, 1280.0/720.0, 0.1, 100.0));
+	camera->setTarget(Vec3(0,0,0));
+
+	printf("octree depth %d, visible counts are projected/planes/octree\n",depth);
+	for(int numObjects = 256; numObjects <= MAX_OBJECTS; numObjects *= 4){
+		benchmark(meshes,numObjects,camera,depth);
+	}
+	benchmarkMoving(cube,4,depth);
+	benchmarkMoving(cube,8,depth);
+	//the meshes share one geometry whose destructor needs a gl context,
+	//they are left for the os to reclaim
+	delete camera;
+	return 0;
+}
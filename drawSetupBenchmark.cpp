@@ -0,0 +1,190 @@
+#include <vector>
+
+#include "glBenchmark.h"
+#include "object/Geometry.h"
+#include "render/GLProgram.h"
+using namespace std;
+
+//small so the draw setup weighs more than the pixels
+#define SCREEN_WIDTH 64
+#define SCREEN_HEIGHT 64
+//cylinders of different segment counts, every draw switches geometry
+#define NUM_GEOMETRIES 64
+#define FIRST_SEGMENTS 8
+//draws in one frame
+#define NUM_DRAWS 4096
+//every layout feeds the same vertices to the same shader
+#define PIXEL_TOLERANCE 0
+
+//the old layout, positions and normals in buffers of their own with the
+//pointers set again for every draw
+#define SETUP_SEPARATE 0
+//one interleaved buffer, still with the pointers set for every draw
+#define SETUP_INTERLEAVED 1
+//one interleaved buffer and a vertex array per geometry
+#define SETUP_VERTEX_ARRAY 2
+
+const char* vertexSource =
+	"#version 330 core\n"
+	"in vec3 position;\n"
+	"in vec3 normal;\n"
+	"uniform vec2 offset;\n"
+	"out vec3 color;\n"
+	"void main(){\n"
+	"	color = normal * 0.5 + 0.5;\n"
+	"	gl_Position = vec4(position.xy * 0.1 + offset,position.z * 0.1,1.0);\n"
+	"}\n";
+
+const char* fragmentSource =
+	"#version 330 core\n"
+	"in vec3 color;\n"
+	"out vec4 fragColor;\n"
+	"void main(){\n"
+	"	fragColor = vec4(color,1.0);\n"
+	"}\n";
+
+//buffers of one geometry for every layout
+struct setupBuffers{
+	GLuint positionBuffer;
+	GLuint normalBuffer;
+	GLuint vertexBuffer;
+	GLuint elementBuffer;
+	GLuint vertexArray;
+	int numElements;
+	GLenum elementType;
+};
+
+typedef struct setupBuffers* SetupBuffers;
+
+GLuint makeBuffer(GLenum target, const void* data, GLsizeiptr size){
+	GLuint buffer;
+	glGenBuffers(1,&buffer);
+	glBindBuffer(target,buffer);
+	glBufferData(target,size,data,GL_STATIC_DRAW);
+	glBindBuffer(target,0);
+	return buffer;
+}
+
+//the interleaved vertices split back into the arrays the old layout had
+void makeBuffers(Geometry* geometry, SetupBuffers buffers){
+	int numVertices = geometry->getNumVertices();
+	GLfloat* vertices = geometry->getVertices();
+	vector<GLfloat> positions(numVertices * 3);
+	vector<GLfloat> normals(numVertices * 3);
+	for(int i = 0; i < numVertices; i++){
+		for(int c = 0; c < 3; c++){
+			positions[i*3 + c] = vertices[i*GEOMETRY_VERTEX_SIZE + c];
+			normals[i*3 + c] = vertices[i*GEOMETRY_VERTEX_SIZE + GEOMETRY_NORMAL_OFFSET + c];
+		}
+	}
+	buffers->positionBuffer = makeBuffer(GL_ARRAY_BUFFER,&positions[0],positions.size() * sizeof(GLfloat));
+	buffers->normalBuffer = makeBuffer(GL_ARRAY_BUFFER,&normals[0],normals.size() * sizeof(GLfloat));
+	buffers->vertexBuffer = makeBuffer(GL_ARRAY_BUFFER,vertices,numVertices * GEOMETRY_VERTEX_SIZE * sizeof(GLfloat));
+	buffers->elementBuffer = makeBuffer(GL_COPY_WRITE_BUFFER,geometry->getElements(),
+	                                    geometry->getNumElements() * geometry->getElementSize());
+	buffers->vertexArray = GLProgram::makeVertexArray(buffers->vertexBuffer,buffers->elementBuffer);
+	buffers->numElements = geometry->getNumElements();
+	buffers->elementType = geometry->getElementType();
+}
+
+void deleteBuffers(SetupBuffers buffers){
+	GLuint names[4] = {buffers->positionBuffer,buffers->normalBuffer,buffers->vertexBuffer,buffers->elementBuffer};
+	glDeleteBuffers(4,names);
+	glDeleteVertexArrays(1,&(buffers->vertexArray));
+}
+
+//the state every draw of the case sets up before drawing
+void setupDraw(int setup, SetupBuffers buffers){
+	if(setup == SETUP_VERTEX_ARRAY){
+		glBindVertexArray(buffers->vertexArray);
+		return;
+	}
+	if(setup == SETUP_SEPARATE){
+		glBindBuffer(GL_ARRAY_BUFFER,buffers->positionBuffer);
+		glVertexAttribPointer(ATTRIBUTE_POSITION,3,GL_FLOAT,GL_FALSE,0,(void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER,buffers->normalBuffer);
+		glVertexAttribPointer(ATTRIBUTE_NORMAL,3,GL_FLOAT,GL_FALSE,0,(void*)0);
+	}
+	else{
+		GLsizei stride = GEOMETRY_VERTEX_SIZE * sizeof(GLfloat);
+		glBindBuffer(GL_ARRAY_BUFFER,buffers->vertexBuffer);
+		glVertexAttribPointer(ATTRIBUTE_POSITION,3,GL_FLOAT,GL_FALSE,stride,(void*)0);
+		glVertexAttribPointer(ATTRIBUTE_NORMAL,3,GL_FLOAT,GL_FALSE,stride,(void*)(GEOMETRY_NORMAL_OFFSET * sizeof(GLfloat)));
+	}
+	glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+	glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,buffers->elementBuffer);
+}
+
+//the pointer cases share one vertex array like the renderer used to
+void renderFrame(int setup, vector<struct setupBuffers>& buffers, GLuint sharedArray, GLint unifOffset){
+	glClearColor(1.0f,1.0f,1.0f,1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if(setup != SETUP_VERTEX_ARRAY){
+		glBindVertexArray(sharedArray);
+	}
+	for(int i = 0; i < NUM_DRAWS; i++){
+		SetupBuffers geometry = &buffers[i % NUM_GEOMETRIES];
+		setupDraw(setup,geometry);
+		glUniform2f(unifOffset,(i % 61) / 30.0f - 1.0f,(i % 53) / 26.0f - 1.0f);
+		glDrawElements(GL_TRIANGLES,geometry->numElements,geometry->elementType,(void*)0);
+	}
+	glBindVertexArray(0);
+}
+
+void benchmark(const char* name, int setup, vector<struct setupBuffers>& buffers, GLuint sharedArray,
+               GLint unifOffset, vector<unsigned char>& reference){
+	vector<unsigned char> pixels;
+	renderFrame(setup,buffers,sharedArray,unifOffset);
+	readFrame(pixels);
+	double seconds = timeFrames([&](){ renderFrame(setup,buffers,sharedArray,unifOffset); });
+	int differing = differingPixels(reference,pixels,PIXEL_TOLERANCE);
+	printf("%-16s %9.3f ms/frame  %7.1f ns/draw  differing pixels %d%s\n",
+		name,
+		seconds * 1000.0,
+		seconds * 1e9 / NUM_DRAWS,
+		differing,
+		differing > 0 ? "  MISMATCH" : ""
+	);
+}
+
+int main(int argc, char** argv){
+	if(!initializeContext("draw setup",SCREEN_WIDTH,SCREEN_HEIGHT)) return -1;
+	printf("%s\n",glGetString(GL_RENDERER));
+	GLProgram* program = new GLProgram();
+	GLuint vertexShader = program->compileShader(GL_VERTEX_SHADER,(char*)vertexSource);
+	GLuint fragmentShader = program->compileShader(GL_FRAGMENT_SHADER,(char*)fragmentSource);
+	GLuint prog = program->linkProgram(vertexShader,fragmentShader);
+	if(prog == 0) return -1;
+	glUseProgram(prog);
+	GLint unifOffset = glGetUniformLocation(prog,"offset");
+
+	vector<struct setupBuffers> buffers(NUM_GEOMETRIES);
+	for(int i = 0; i < NUM_GEOMETRIES; i++){
+		Geometry* geometry = Geometry::generateCylinder(FIRST_SEGMENTS + i);
+		geometry->retain();
+		makeBuffers(geometry,&buffers[i]);
+		geometry->release();
+	}
+	GLuint sharedArray;
+	glGenVertexArrays(1,&sharedArray);
+	printf("%d geometries, %d draws per frame\n",NUM_GEOMETRIES,NUM_DRAWS);
+
+	vector<unsigned char> reference;
+	renderFrame(SETUP_SEPARATE,buffers,sharedArray,unifOffset);
+	readFrame(reference);
+	benchmark("separate",SETUP_SEPARATE,buffers,sharedArray,unifOffset,reference);
+	benchmark("interleaved",SETUP_INTERLEAVED,buffers,sharedArray,unifOffset,reference);
+	benchmark("vertex array",SETUP_VERTEX_ARRAY,buffers,sharedArray,unifOffset,reference);
+
+	for(int i = 0; i < NUM_GEOMETRIES; i++){
+		deleteBuffers(&buffers[i]);
+	}
+	glDeleteVertexArrays(1,&sharedArray);
+	glDeleteProgram(prog);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	delete program;
+	destroyContext();
+	return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef GLBENCHMARK_H
+#define GLBENCHMARK_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define NO_SDL_GLEXT
+#include <SDL2/SDL.h>
+#include <GL/glew.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "benchmark.h"
+
+//the gl benchmarks draw into a hidden window of their own. with
+//LIBGL_ALWAYS_SOFTWARE=1 mesa's llvmpipe provides everything they use, so
+//no gpu is required
+static SDL_Window* window = NULL;
+static SDL_GLContext context = NULL;
+static int screenWidth = 0;
+static int screenHeight = 0;
+
+//a 4.4 core context with depth testing, the renderer sets up the rest
+inline bool initializeContext(const char* title, int width, int height){
+	if(SDL_Init(SDL_INIT_VIDEO) < 0){
+		printf("SDL could not initialize! SDL_Error: %s\n",SDL_GetError());
+		return false;
+	}
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,4);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,4);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE,24);
+	window = SDL_CreateWindow(title,SDL_WINDOWPOS_UNDEFINED,SDL_WINDOWPOS_UNDEFINED,
+	                          width,height,SDL_WINDOW_HIDDEN | SDL_WINDOW_OPENGL);
+	if(window == NULL){
+		printf("Window could not be created! SDL_Error: %s\n",SDL_GetError());
+		return false;
+	}
+	context = SDL_GL_CreateContext(window);
+	if(context == NULL){
+		printf("OpenGL context could not be created! SDL Error: %s\n",SDL_GetError());
+		return false;
+	}
+	glewExperimental = GL_TRUE;
+	if(glewInit() != GLEW_OK) return false;
+	screenWidth = width;
+	screenHeight = height;
+	glViewport(0,0,width,height);
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LEQUAL);
+	return true;
+}
+
+inline void destroyContext(){
+	SDL_GL_DeleteContext(context);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+}
+
+inline void readFrame(std::vector<unsigned char>& pixels){
+	pixels.resize(screenWidth * screenHeight * 4);
+	glReadPixels(0,0,screenWidth,screenHeight,GL_RGBA,GL_UNSIGNED_BYTE,&pixels[0]);
+}
+
+//pixels with a color channel that differs by more than tolerance, paths
+//that shade the same pixels with different instructions may round
+//differently
+inline int differingPixels(std::vector<unsigned char>& a, std::vector<unsigned char>& b, int tolerance){
+	int count = 0;
+	for(int i = 0; i < screenWidth * screenHeight; i++){
+		for(int channel = 0; channel < 3; channel++){
+			if(abs(a[i*4 + channel] - b[i*4 + channel]) > tolerance){
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+//seconds per frame of render, called until MIN_SECONDS have passed.
+//frames are finished before the clock is read, the gpu time is included
+template<class Render> inline double timeFrames(Render render){
+	int frames = 0;
+	double elapsed = 0;
+	double start = now();
+	while(elapsed < MIN_SECONDS){
+		render();
+		glFinish();
+		frames++;
+		elapsed = now() - start;
+	}
+	return elapsed / frames;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include <cmath>
+#include <list>
+#include <vector>
+
+#include "glBenchmark.h"
+#include "scene/Scene.h"
+#include "scene/MoleculeGrid.h"
+#include "render/Renderer.h"
+#include "Molecule.h"
+using namespace std;
+
+#define SCREEN_WIDTH 640
+#define SCREEN_HEIGHT 360
+//same molecule grid as main.cpp
+#define DIM 4
+//views around the grid where the culled frames are checked
+#define NUM_VIEWS 8
+//distance of the views from the center of the grid
+#define VIEW_DISTANCE 30.0
+//culled draws read their instances through other shaders than the reference
+#define PIXEL_TOLERANCE 2
+
+void renderFrame(Renderer* renderer, Scene* scene){
+	glClearColor(1.0f,1.0f,1.0f,1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	renderer->render(scene);
+}
+
+//the sphere test of the compute pass done on the cpu, bonds are bounded by
+//the sphere around both ends
+int frustumReference(Scene* scene){
+	Camera* camera = scene->getCamera();
+	Frustum frustum;
+	frustum.setFromMatrix(*(camera->getProjectionMatrix()) * *(camera->getWorldMatrix()));
+	list<Object3D*> objects = scene->getObjects();
+	list<Object3D*>::iterator it = objects.begin();
+	int visible = 0;
+	for(;it != objects.end();it++){
+		InstancedMesh* mesh = (InstancedMesh*)(*it);
+		if(!mesh->getVisible()) continue;
+		const GLfloat* m = mesh->getModelMatrix()->getElements();
+		GLfloat scale = sqrt(m[0]*m[0] + m[4]*m[4] + m[8]*m[8]);
+		for(int i = 0; i < mesh->getNumInstances(); i++){
+			GLfloat center[3];
+			GLfloat radius;
+			if(mesh->getInstanceType() == SPHERE_INSTANCE){
+				SphereInstance sphere = &(mesh->getSpheres()[i]);
+				Mat4::transformPoints(*(mesh->getModelMatrix()),sphere->position,center,1);
+				radius = sphere->radius;
+			}
+			else{
+				CylinderInstance cylinder = &(mesh->getCylinders()[i]);
+				GLfloat length = 0;
+				for(int axis = 0; axis < 3; axis++){
+					GLfloat delta = cylinder->end[axis] - cylinder->start[axis];
+					length += delta * delta;
+					center[axis] = (cylinder->start[axis] + cylinder->end[axis]) * 0.5 + cylinder->offset[axis];
+				}
+				Mat4::transformPoints(*(mesh->getModelMatrix()),center,center,1);
+				radius = cylinder->radius + sqrt(length) * 0.5;
+			}
+			radius *= scale;
+			bool inside = true;
+			for(int plane = 0; plane < 6 && inside; plane++){
+				const GLfloat* p = frustum.getPlane(plane);
+				inside = p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] >= -radius;
+			}
+			if(inside) visible++;
+		}
+	}
+	return visible;
+}
+
+void setView(Scene* scene, int view){
+	float angle = 2 * 3.1415927 * view / NUM_VIEWS;
+	Camera* camera = scene->getCamera();
+	camera->setPosition(Vec3(sin(angle) * VIEW_DISTANCE,VIEW_DISTANCE * 0.3,cos(angle) * VIEW_DISTANCE));
+	camera->setTarget(Vec3(0,0,0));
+}
+
+//every view is drawn through the multi draw path without culling as
+//reference, then culled by the frustum alone and with the depth of a
+//previous frame of the view, only hidden instances may go
+void checkViews(Renderer* renderer, Scene* scene, int numInstances){
+	vector<unsigned char> reference;
+	vector<unsigned char> culled;
+	int errors = 0;
+	for(int view = 0; view < NUM_VIEWS; view++){
+		setView(scene,view);
+		renderer->setMultiDraw(true);
+		renderer->setGpuCulling(false);
+		renderFrame(renderer,scene);
+		readFrame(reference);
+
+		renderer->setGpuCulling(true);
+		renderFrame(renderer,scene);
+		renderer->getInstanceCuller()->setOcclusion(false);
+		renderFrame(renderer,scene);
+		readFrame(culled);
+		int frustumVisible = renderer->getInstanceCuller()->readVisibleInstances();
+		int frustumPixels = differingPixels(reference,culled,PIXEL_TOLERANCE);
+		int cpuVisible = frustumReference(scene);
+
+		//the first frame leaves the depth the second one is tested against
+		renderer->getInstanceCuller()->setOcclusion(true);
+		renderFrame(renderer,scene);
+		renderFrame(renderer,scene);
+		readFrame(culled);
+		int occlusionVisible = renderer->getInstanceCuller()->readVisibleInstances();
+		int occlusionPixels = differingPixels(reference,culled,PIXEL_TOLERANCE);
+
+		bool mismatch = frustumVisible != cpuVisible || frustumPixels > 0 || occlusionPixels > 0;
+		if(mismatch) errors++;
+		printf("view %d  %6d instances  frustum %6d (cpu %6d)  occlusion %6d  differing pixels %d/%d%s\n",
+			view,
+			numInstances,
+			frustumVisible,
+			cpuVisible,
+			occlusionVisible,
+			frustumPixels,
+			occlusionPixels,
+			mismatch ? "  MISMATCH" : ""
+		);
+	}
+	printf("%d/%d views differ from the reference\n",errors,NUM_VIEWS);
+}
+
+void benchmark(const char* name, Renderer* renderer, Scene* scene, bool multiDraw, bool gpuCulling, bool occlusion){
+	renderer->setMultiDraw(multiDraw);
+	renderer->setGpuCulling(gpuCulling);
+	if(renderer->getInstanceCuller() != NULL){
+		renderer->getInstanceCuller()->setOcclusion(occlusion);
+	}
+	setView(scene,1);
+	renderFrame(renderer,scene);
+	glFinish();
+	double seconds = timeFrames([&](){ renderFrame(renderer,scene); });
+	RenderStats stats = renderer->getStats();
+	printf("%-16s %9.3f ms/frame  %d draw calls  %d instances submitted\n",
+		name,
+		seconds * 1000.0,
+		stats->drawCalls,
+		stats->instances
+	);
+}
+
+int main(int argc, char** argv){
+	if(!initializeContext("gpu culling",SCREEN_WIDTH,SCREEN_HEIGHT)) return -1;
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+	glFrontFace(GL_CCW);
+	printf("%s\n",glGetString(GL_RENDERER));
+	if(!Renderer::isGpuCullingSupported()){
+		printf("compute culling needs multi draw indirect, shader draw parameters and compute shaders\n");
+		return -1;
+	}
+	Scene* scene = new Scene();
+	Molecule* mol = new Molecule(argc > 1 ? argv[1] : "caffeine.pdb");
+	vector<Molecule*> molecules(DIM*DIM*DIM);
+	for(int index = 0; index < DIM*DIM*DIM; index++){
+		molecules[index] = new Molecule(*mol);
+		MoleculeGrid::place(molecules[index],index,DIM);
+		molecules[index]->addToScene(scene);
+	}
+	DirectionalLight* light = new DirectionalLight();
+	light->setPosition(Vec3(2,4,5));
+	light->getColor()->setRGB(1,1,1);
+	scene->addDirectionalLight(light);
+	Renderer* renderer = new Renderer();
+	//the compute pass sees every instance, not what the octree left
+	renderer->setCulling(false);
+	renderFrame(renderer,scene);
+	int numInstances = renderer->getStats()->instances;
+
+	checkViews(renderer,scene,numInstances);
+	benchmark("instanced",renderer,scene,false,false,false);
+	benchmark("multi draw",renderer,scene,true,false,false);
+	benchmark("gpu frustum",renderer,scene,true,true,false);
+	benchmark("gpu occlusion",renderer,scene,true,true,true);
+
+	//the scene deletes the meshes, the molecules are left like in main.cpp
+	delete renderer;
+	delete scene;
+	destroyContext();
+	return 0;
+}
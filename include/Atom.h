@@ -1,19 +1,25 @@
 #ifndef ATOM_H
 #define ATOM_H
-#include "object/Mesh.h"
+#include "AtomTable.h"
 
+//lightweight view over one row of an AtomTable
 class Atom{
 private:
-	char* symbol;
-	Mesh* mesh;
+	AtomTable* table;
+	int index;
 public:
-	Atom(const char* symbol, Mesh * mesh);
-	Atom(const Atom& atom);
-	~Atom();
-    char* getSymbol();
-    void setSymbol(const char* symbol);
-    Mesh* getMesh();
-    void setMesh(Mesh* mesh);
+	Atom(AtomTable* table, int index);
+	int getIndex();
+	const char* getSymbol();
+	float getX();
+	float getY();
+	float getZ();
+	float getRadius();
+	unsigned int getColor();
+	int getResidue();
+	char getChain();
+	bool isHydrogen();
+	float distance(Atom atom);
 };
 
 #endif
\ No newline at end of file
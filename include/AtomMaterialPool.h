@@ -2,18 +2,34 @@
 #define ATOMMATERIALPOOL_H
 #include <map>
 #include "material/Material.h"
+#include "material/MaterialTable.h"
+#include "material/ImpostorMaterial.h"
+#include "object/InstancedMesh.h"
 #include <string>
 using namespace std;
 
+//element colors are rows of the material table, atoms and bonds of every
+//element point at their rows and are drawn by the shared instanced and
+//impostor materials, so changing a color is only a table update
 class AtomMaterialPool{
 private:
 	static AtomMaterialPool* instance;
 	map<string,Material *> pool;
+	//row of the atom material, the bond material is the next one
+	map<string,int> rows;
+	int defaultRow;
+	static int addRows(Material* material);
+	Material* instancedMaterials[2];
+	Material* impostorMaterials[2];
 	static void RGBfromHexString(float* result, const char* hexColor);
 	AtomMaterialPool();
 public:
 	static AtomMaterialPool* getInstance();
     Material* getAtomMaterial(char* element);
+    int getAtomMaterialRow(const char* element);
+    int getBondMaterialRow(const char* element);
+    Material* getInstancedMaterial(InstanceType instanceType);
+    Material* getImpostorMaterial(ImpostorShape shape);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef ATOMTABLE_H
+#define ATOMTABLE_H
+#include <vector>
+#include <string>
+#include <map>
+#include <cstddef>
+using namespace std;
+//structure of arrays holding every per-atom attribute of a molecule
+//representations (ball & stick, spacefill, bonds) read from here
+
+#define ATOM_HETATM 1
+#define ATOM_HYDROGEN 2
+#define ATOM_HIDDEN 4
+
+class AtomTable{
+private:
+	vector<float> positions;
+	vector<unsigned char> elements;
+	vector<float> radii;
+	vector<unsigned int> colors;
+	vector<int> residues;
+	vector<char> chains;
+	vector<unsigned char> flags;
+	vector<string> elementSymbols;
+	map<string,unsigned char> elementIds;
+	unsigned char getElementId(const char* symbol);
+public:
+	AtomTable();
+	void reserve(int numAtoms);
+	int addAtom(const char* symbol, float x, float y, float z, float radius, unsigned int color, int residue, char chain, unsigned char flags);
+	int getNumAtoms();
+	float* getPositions();
+	float* getPosition(int index);
+	unsigned char getElement(int index);
+	const char* getSymbol(int index);
+	const char* getElementSymbol(unsigned char element);
+	int getNumElements();
+	float* getRadii();
+	float getRadius(int index);
+	unsigned int* getColors();
+	unsigned int getColor(int index);
+	int getResidue(int index);
+	char getChain(int index);
+	unsigned char getFlags(int index);
+	void setFlags(int index, unsigned char flags);
+	bool isHydrogen(int index);
+	size_t getMemoryUsage();
+	static unsigned int packColor(float r, float g, float b, float a = 1.0);
+};
+
+#endif
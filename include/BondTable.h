@@ -0,0 +1,40 @@
+#ifndef BONDTABLE_H
+#define BONDTABLE_H
+#include <vector>
+#include <cstddef>
+using namespace std;
+//sparse bond storage, bonds are collected as an edge list and
+//build() turns them into a sorted bond list plus CSR adjacency
+
+struct bond{
+	int atom1;
+	int atom2;
+	int order;
+};
+
+typedef struct bond* Bond;
+
+class BondTable{
+private:
+	int numAtoms;
+	bool built;
+	vector<struct bond> bonds;
+	vector<int> offsets;
+	vector<int> neighbors;
+	vector<int> neighborBonds;
+	static bool compareBonds(const struct bond& b1, const struct bond& b2);
+public:
+	BondTable(int numAtoms);
+	void addBond(int atom1, int atom2, int order = 1);
+	void build();
+	int getNumAtoms();
+	int getNumBonds();
+	Bond getBond(int index);
+	int getNumNeighbors(int atom);
+	const int* getNeighbors(int atom);
+	const int* getNeighborBonds(int atom);
+	int getBondOrder(int atom1, int atom2);
+	size_t getMemoryUsage();
+};
+
+#endif
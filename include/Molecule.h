@@ -2,41 +2,79 @@
 #define MOLECULE_H
 #include <vector>
 #include "Atom.h"
+#include "AtomTable.h"
+#include "BondTable.h"
+#include "object/Mesh.h"
+#include "object/InstancedMesh.h"
 #include "scene/Scene.h"
+#include "scene/BVH.h"
 #include "object/Object3D.h"
 using namespace std;
 
+#define MIN_BOND_DISTANCE 0.4
+#define MAX_BOND_DISTANCE 1.9
+#define MAX_H_BOND_DISTANCE 1.2
+#define BOND_RADIUS 0.166
+#define BOND_SPACING 0.25
+#define BOND_SEGMENTS 16
+//names the atom and bond geometries are shared under in the GeometryRegistry
+#define ATOM_GEOMETRY_FILE "highres-icosphere.mesh"
+#define SPHERE_IMPOSTOR_GEOMETRY "generated quad 2"
+#define BOND_GEOMETRY "generated bond cylinder"
+#define CYLINDER_IMPOSTOR_GEOMETRY "generated cube 2"
+
 class Molecule : public Object3D{
 private:
-	vector<Atom*> atoms;
-	vector<Atom*> spacefill;
-	vector<Mesh*> bonds;
-	char ** connections;
-	char* substr(const char* source, int i, int n);
+	AtomTable* atomTable;
+	BondTable* bondTable;
+	//one instance per atom, built from the atom table
+	InstancedMesh* atoms;
+	InstancedMesh* spacefill;
+	InstancedMesh* bonds;
+	Geometry* atomGeometry;
+	Geometry* bondGeometry;
+	Geometry* sphereImpostorGeometry;
+	Geometry* cylinderImpostorGeometry;
+	bool impostors;
+	bool spacefillMode;
+	//atoms and bonds in local space for picking, built on first use
+	BVH* bvh;
+	bool bvhSpacefill;
 	float x;
 	float y;
 	float z;
 	int numAtoms;
-	void initConnectionMatrix(int numAtoms,char value);
+	void createAtomMeshes();
+	void createBondMeshes();
+	void bondNormal(int atom1, int atom2, float* normal);
+	void updateVisibility();
+	void buildBVH();
 public:
 	Molecule(const char* filename);
 	Molecule(const Molecule& molecule);
 	~Molecule();
 	void readPDB(const char* filename);
-	vector<Atom*> getAtoms();
-	vector<Atom*> getSpacefill();
-	vector<Mesh*> getBonds();
-	Mesh* createBond(Atom* a1, Atom* a2, int numLinks);
-	static Vec3* getBondPos(Vec3* atomPos1, Vec3* atomPos2);
-	char** getConnections();
+	AtomTable* getAtomTable();
+	Atom getAtom(int index);
+	InstancedMesh* getAtoms();
+	InstancedMesh* getSpacefill();
+	InstancedMesh* getBonds();
+	BondTable* getConnections();
 	void calculateConnections(int num);
 	int getNumAtoms();
-	static bool atomsConnected(Atom* a1, Atom* a2);
+	static bool atomsConnected(Atom a1, Atom a2);
+	static bool atomsConnected(float distance, bool hydrogen);
 	void addToScene(Scene* scene);
 	float getX();
 	float getY();
 	float getZ();
 	void toggleSpaceFill();
+	bool getImpostors();
+	void setImpostors(bool impostors);
+	bool getSpacefillMode();
+	BVH* getBVH();
+	bool raycast(const Vec3& origin, const Vec3& direction, float maxDistance, BVHHit hit);
+	bool closestPrimitive(const Vec3& point, float maxDistance, BVHHit hit);
 };
 
 #endif
\ No newline at end of file
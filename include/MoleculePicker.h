@@ -0,0 +1,45 @@
+#ifndef MOLECULEPICKER_H
+#define MOLECULEPICKER_H
+#include <vector>
+#include "Molecule.h"
+#include "scene/Camera.h"
+#include "scene/BVH.h"
+using namespace std;
+
+//what a pick hit, index is an atom or a bond depending on type
+struct pickResult{
+	Molecule* molecule;
+	GLint moleculeIndex;
+	GLint type;
+	GLint index;
+	GLfloat distance;
+};
+
+typedef struct pickResult* PickResult;
+
+//two level picking: a tree over the bounding sphere of every molecule, kept
+//up to date by refitting as they move, and each molecule's own tree of atoms
+//and bonds in local space
+class MoleculePicker{
+private:
+	vector<Molecule*> molecules;
+	vector<unsigned int> versions;
+	vector<bool> spacefillModes;
+	vector<struct bvhPrimitive> bounds;
+	vector<struct bvhHit> hits;
+	BVH moleculeTree;
+	bool dirty;
+	void moleculeBounds(int index, BVHPrimitive primitive);
+	void update();
+public:
+	MoleculePicker();
+	void addMolecule(Molecule* molecule);
+	void clear();
+	int getNumMolecules();
+	Molecule* getMolecule(int index);
+	bool raycast(const Vec3& origin, const Vec3& direction, float maxDistance, PickResult result);
+	bool pick(Camera* camera, float x, float y, PickResult result);
+	bool closestPrimitive(const Vec3& point, float maxDistance, PickResult result);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PDBREADER_H
+#define PDBREADER_H
+#include <cstddef>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+//reads PDB fixed-column records straight from a memory mapped file
+//no per-field allocations, atoms are written into one preallocated array
+
+struct pdbAtom{
+	int serial;
+	int residue;
+	char chain;
+	bool hetatm;
+	char element[4];
+	float x;
+	float y;
+	float z;
+};
+
+typedef struct pdbAtom* PDBAtom;
+
+struct pdbConect{
+	int serial;
+	int bonded[4];
+};
+
+typedef struct pdbConect* PDBConect;
+
+class PDBReader{
+private:
+	const char* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int file;
+#endif
+	PDBAtom atoms;
+	int numAtoms;
+	PDBConect conects;
+	int numConects;
+	bool mapFile(const char* filename);
+	void unmapFile();
+	void clear();
+	static void parseElement(const char* line, int length, char* element);
+public:
+	PDBReader();
+	~PDBReader();
+	bool read(const char* filename);
+	PDBAtom getAtoms();
+	int getNumAtoms();
+	PDBConect getConects();
+	int getNumConects();
+	size_t getFileSize();
+	static float parseFixedFloat(const char* field, int width);
+	static int parseFixedInt(const char* field, int width);
+};
+
+#endif
@@ -18,14 +18,16 @@ class DirectionalLight : public Light{
 private:
 	Object3D * target;
 	GLfloat intensity;
+	unsigned int targetVersion;
 public:
 	DirectionalLight();
 	~DirectionalLight();
 	Object3D* getTarget();
 	GLfloat getIntensity();
 	void setIntensity(GLfloat intensity);
-	DirLight getAsStruct(Camera* camera);
-	GLfloat* getVectorToLightAsArray(Camera* camera);
+	void getAsStruct(Camera* camera, DirLight light);
+	void getVectorToLightAsArray(Camera* camera, GLfloat* vec);
+	unsigned int getVersion();
 };
 
 #endif
\ No newline at end of file
@@ -7,11 +7,19 @@
 class Light : public Object3D {
 private:
 	Color * color;
+	//bumped by the setters of every light type, changes of the color and
+	//the position are folded in when the version is asked for
+	unsigned int version;
+	unsigned int colorVersion;
+	unsigned int positionVersion;
+protected:
+	void markChanged();
 public:
 	Light();
 	virtual ~Light();
 	Color* getColor();
 	void setColor(Color* color);
+	virtual unsigned int getVersion();
 };
 
 #endif
\ No newline at end of file
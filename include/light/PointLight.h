@@ -24,7 +24,7 @@ class PointLight : public Light{
     void setAttenuation(GLfloat attenuation);
     GLfloat getAttenuation();
   	~PointLight();
-  	PLight getAsStruct(Camera* camera);
+  	void getAsStruct(Camera* camera, PLight light);
 };
 
 #endif
\ No newline at end of file
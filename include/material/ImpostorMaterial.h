@@ -0,0 +1,21 @@
+#ifndef IMPOSTORMATERIAL_H
+#define IMPOSTORMATERIAL_H
+#include "material/Material.h"
+//draws each instance as a bounding primitive and ray-casts the exact
+//sphere or cylinder in the fragment shader, writing its depth
+
+enum ImpostorShape {SPHERE_IMPOSTOR,CYLINDER_IMPOSTOR};
+
+class ImpostorMaterial:public Material{
+private:
+	ImpostorShape shape;
+	bool multiDraw;
+	ImpostorMaterial* multiDrawMaterial;
+public:
+	ImpostorMaterial(ImpostorShape shape, bool multiDraw = false);
+	~ImpostorMaterial();
+	ImpostorShape getShape();
+	Material* getMultiDrawMaterial();
+};
+
+#endif
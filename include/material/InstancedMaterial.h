@@ -0,0 +1,18 @@
+#ifndef INSTANCEDMATERIAL_H
+#define INSTANCEDMATERIAL_H
+#include "material/Material.h"
+#include "object/InstancedMesh.h"
+	
+class InstancedMaterial:public Material{
+private:
+	InstanceType instanceType;
+	bool multiDraw;
+	InstancedMaterial* multiDrawMaterial;
+public:
+	InstancedMaterial(InstanceType instanceType = SPHERE_INSTANCE, bool multiDraw = false);
+	~InstancedMaterial();
+	InstanceType getInstanceType();
+	Material* getMultiDrawMaterial();
+};
+
+#endif
\ No newline at end of file
@@ -2,12 +2,14 @@
 #define MATERIAL_H
 #include <GL/glew.h>
 #include "render/GLProgram.h"
+#include "render/ProgramCache.h"
 #include "math/Color.h"
-//materials own shaders (vertex, fragment), programs and uniforms
+//materials own shaders (vertex, fragment) and uniforms, programs are shared
+//through the program cache by materials with the same shaders
 //future adds -> opacity, bumpmaps, textures, normal maps
 //future -> make material memory self managed
 
-enum MaterialType {BASIC_MATERIAL,GOURAUD_MATERIAL,PHONG_MATERIAL,TESS_MATERIAL,CEL_MATERIAL,POINT_MATERIAL,LINE_MATERIAL};
+enum MaterialType {BASIC_MATERIAL,GOURAUD_MATERIAL,PHONG_MATERIAL,TESS_MATERIAL,CEL_MATERIAL,POINT_MATERIAL,LINE_MATERIAL,INSTANCED_MATERIAL,IMPOSTOR_MATERIAL};
 
 struct materialStruct{
 	GLfloat diffuseColor[4];
@@ -23,10 +25,15 @@ protected:
 	Color* diffuseColor;
 	Color* specularColor;
 	GLfloat shininess;
+	//changes to the colors are folded in when the version is asked for
+	unsigned int version;
+	unsigned int diffuseVersion;
+	unsigned int specularVersion;
 	GLchar* vertexShaderSource;
 	GLchar* fragmentShaderSource;
 	GLProgram* program;
 	MaterialType type;
+	static void makeMultiDrawSources(GLchar** vertexSource, GLchar** fragmentSource);
 public:
 	Material();
 	virtual ~Material();
@@ -42,7 +49,9 @@ public:
 	Color* getSpecularColor();
 	void setShininess(GLfloat shininess);
 	GLfloat getShininess();
-	MaterialStruct getAsStruct();
+	void getAsStruct(MaterialStruct material);
+	unsigned int getVersion();
 	MaterialType getType();
+	virtual Material* getMultiDrawMaterial();
 };
 #endif
\ No newline at end of file
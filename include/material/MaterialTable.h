@@ -0,0 +1,32 @@
+#ifndef MATERIALTABLE_H
+#define MATERIALTABLE_H
+
+#include <GL/glew.h>
+#include <vector>
+#include "material/Material.h"
+using namespace std;
+
+//uniform block binding of the table, after the camera and lights
+#define MATERIAL_TABLE_BINDING 4
+//rows in the block, MAX_MATERIALS in the shaders reading it
+#define MATERIAL_TABLE_SIZE 256
+
+//colors and shininess of every material an instance can point at, kept in
+//one uniform block so instances of any color share a program and a draw.
+//rows are std140 materialStructs in the order they were added
+class MaterialTable{
+private:
+	static MaterialTable* instance;
+	vector<Material*> materials;
+	unsigned int version;
+	MaterialTable();
+public:
+	static MaterialTable* getInstance();
+	int addMaterial(Material* material);
+	Material* getMaterial(int index);
+	int getNumMaterials();
+	unsigned int getVersion();
+	void write(MaterialStruct rows);
+};
+
+#endif
@@ -9,6 +9,8 @@ private:
 	GLfloat g;
 	GLfloat b;
 	GLfloat a;
+	//bumped by every setter
+	unsigned int version;
 public:
 	Color();
 	Color(GLfloat r, GLfloat g, GLfloat b);
@@ -16,8 +18,9 @@ public:
 	void setRGB(GLfloat r, GLfloat g, GLfloat b);
 	void setComponent(char component, GLfloat value);
 	void addColor(Color * color);
-	GLfloat* getAsArray();
+	void getAsArray(GLfloat* array);
 	GLfloat getComponent(char component);
+	unsigned int getVersion();
 };
 
 #endif
\ No newline at end of file
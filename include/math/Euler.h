@@ -14,20 +14,19 @@ private:
 	GLfloat x;
 	GLfloat y;
 	GLfloat z;
-	char * order;
+	char order[4];
 	Quaternion* quaternion;
 
 public:
 	Euler(GLfloat x, GLfloat y, GLfloat z, const char* order);
 	Euler(GLfloat x, GLfloat y, GLfloat z);
 	Euler(const Euler& euler);
-	~Euler();
-	char* getOrder();
-	GLfloat getX();
+	const char* getOrder() const;
+	GLfloat getX() const;
 	void setX(GLfloat x);
-	GLfloat getY();
+	GLfloat getY() const;
 	void setY(GLfloat y);
-	GLfloat getZ();
+	GLfloat getZ() const;
 	void setZ(GLfloat z);
 	void setFromQuaternion(Quaternion* q, const char* order, bool update = true);
 };
@@ -0,0 +1,26 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+#include <GL/glew.h>
+#include "math/Mat4.h"
+
+//bit set for every plane a box still has to be tested against
+#define FRUSTUM_ALL_PLANES 0x3f
+//returned by classifyBox when the box is completely behind one plane
+#define FRUSTUM_OUTSIDE -1
+
+//six clip planes taken from a view projection matrix, normals point inside
+//so a point is in the frustum when every plane gives a positive distance
+class Frustum{
+private:
+	GLfloat planes[6][4];
+	GLfloat absNormals[6][3];
+public:
+	Frustum();
+	void setFromMatrix(const Mat4& viewProjection);
+	const GLfloat* getPlane(int index) const;
+	int classifyBox(const GLfloat* center, const GLfloat* halfSize, int mask = FRUSTUM_ALL_PLANES) const;
+	int classifyBounds(const GLfloat* min, const GLfloat* max, int mask = FRUSTUM_ALL_PLANES) const;
+	bool intersectsBounds(const GLfloat* min, const GLfloat* max) const;
+};
+
+#endif
@@ -1,29 +1,44 @@
 #ifndef MAGLfloat4_H
 #define MAGLfloat4_H
 #include <math.h>
-#include "math/Quaternion.h"
-#include "math/Vec3.h"
+#include <GL/glew.h>
 
-class Mat4{
+class Quaternion;
+class Vec3;
+
+//instruction sets the multiply and transform kernels can run on
+#define SIMD_SCALAR 0
+#define SIMD_SSE 1
+#define SIMD_AVX2 2
+
+//row major 4x4 matrix stored inline, copy it around as a value
+class alignas(16) Mat4{
 private:
-	GLfloat * elements;
-	void setElements(GLfloat* elements);
+	GLfloat elements[16];
 public:
-	Mat4(GLfloat value);
+	Mat4();
+	explicit Mat4(GLfloat value);
 	GLfloat * getElements();
-	~Mat4();
-	static Mat4 * identityMatrix();
-	static Mat4 * translationMatrix(GLfloat x, GLfloat y , GLfloat z);
-	static Mat4 * rotationMatrixFromQuaternion(Quaternion* q);
-	static Mat4 * scaleMatrix(GLfloat x, GLfloat y , GLfloat z);
+	const GLfloat * getElements() const;
+	static Mat4 identityMatrix();
+	static Mat4 translationMatrix(GLfloat x, GLfloat y , GLfloat z);
+	static Mat4 rotationMatrixFromQuaternion(Quaternion q);
+	static Mat4 scaleMatrix(GLfloat x, GLfloat y , GLfloat z);
 	void scalarProduct(GLfloat scalar);
-	Mat4 * copy();
-	static Mat4 * rotationMatrix(GLfloat x , GLfloat y, GLfloat z);
-	static Mat4 * perspectiveMatrix(GLfloat fov, GLfloat aspectRatio, GLfloat zNear, GLfloat zFar);
-	static Mat4 * crossProductMatrices(Mat4 * m1, Mat4 * m2);
-	void crossProduct(Mat4 * mat);
-	Mat4 * getTraspose();
-	static Mat4* lookAt(Vec3* eye, Vec3* target, Vec3* up);
+	static Mat4 rotationMatrix(GLfloat x , GLfloat y, GLfloat z);
+	static Mat4 perspectiveMatrix(GLfloat fov, GLfloat aspectRatio, GLfloat zNear, GLfloat zFar);
+	static Mat4 crossProductMatrices(const Mat4& m1, const Mat4& m2);
+	static void multiply(const GLfloat* a, const GLfloat* b, GLfloat* result);
+	static void transformPoints(const Mat4& matrix, const GLfloat* points, GLfloat* result, int count, int stride = 3, GLfloat w = 1, bool divide = false);
+	static int getSupportedSimdLevel();
+	static int getSimdLevel();
+	static void setSimdLevel(int level);
+	void crossProduct(const Mat4& mat);
+	Mat4 operator*(const Mat4& mat) const;
+	Mat4& operator*=(const Mat4& mat);
+	Mat4 getTraspose() const;
+	Mat4 getInverse() const;
+	static Mat4 lookAt(const Vec3& eye, const Vec3& target, const Vec3& up);
 };
 
 #endif
\ No newline at end of file
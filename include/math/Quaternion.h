@@ -7,7 +7,8 @@ class Euler;
 class Mat4;
 class Vec3;
 
-class Quaternion{
+//value type, the euler pointer only links it to the Euler of an Object3D
+class alignas(16) Quaternion{
 	friend class Object3D;
 	friend class Euler;
 private:
@@ -17,29 +18,29 @@ private:
 	GLfloat w;
 	Euler* euler;
 public:
-	Quaternion();
-	Quaternion(GLfloat x, GLfloat y, GLfloat z,GLfloat w);
+	constexpr Quaternion() : x(0), y(0), z(0), w(1), euler(NULL){}
+	constexpr Quaternion(GLfloat x, GLfloat y, GLfloat z,GLfloat w) : x(x), y(y), z(z), w(w), euler(NULL){}
 	void setX(GLfloat x);
 	void setY(GLfloat y);
 	void setZ(GLfloat z);
 	void setW(GLfloat w);
-	GLfloat getX();
-	GLfloat getY();
-	GLfloat getZ();
-	GLfloat getW();
+	constexpr GLfloat getX() const{ return this->x; }
+	constexpr GLfloat getY() const{ return this->y; }
+	constexpr GLfloat getZ() const{ return this->z; }
+	constexpr GLfloat getW() const{ return this->w; }
 	void setComponent(int index, GLfloat value);
-	GLfloat getComponent(int index);
+	GLfloat getComponent(int index) const;
 	void setFromEuler(Euler* euler , bool update = true);
-	void setFromMat4(Mat4* mat4);
-	Quaternion * conjugate();
-	Quaternion * inverse();
+	void setFromMat4(const Mat4& mat4);
+	Quaternion conjugate() const;
+	Quaternion inverse() const;
 	void normalize();
-	GLfloat length();
-	static Quaternion* multiplyQuaternions(Quaternion* q1, Quaternion* q2);
-	void  multiply(Quaternion* q);
-	GLfloat dotProduct(Quaternion* q);
-	static GLfloat dotProductQuaternion(Quaternion* q1, Quaternion* q2);
-	static Quaternion* rotationBetweenVectors(Vec3* vec1, Vec3* vec2);
+	GLfloat length() const;
+	static Quaternion multiplyQuaternions(const Quaternion& q1, const Quaternion& q2);
+	void  multiply(const Quaternion& q);
+	GLfloat dotProduct(const Quaternion& q) const;
+	static GLfloat dotProductQuaternion(const Quaternion& q1, const Quaternion& q2);
+	static Quaternion rotationBetweenVectors(const Vec3& vec1, const Vec3& vec2);
 	void setEuler(Euler* euler);
 };
 
@@ -10,15 +10,15 @@ private:
 	float r;
 public:
 	SphericalCoord();
-	SphericalCoord(Vec3* cartesian, Vec3* relOrigin=NULL);
+	SphericalCoord(const Vec3& cartesian, const Vec3& relOrigin = Vec3());
 	float getPhi();
 	float getTheta();
 	float getR();
 	void setPhi(float phi);
 	void setTheta(float theta);
 	void setR(float r);
-	void setFromCartesian(Vec3 * position, Vec3* relOrigin = NULL);
-	Vec3* getCartesian(Vec3 * relOrigin = NULL);
+	void setFromCartesian(const Vec3& position, const Vec3& relOrigin = Vec3());
+	Vec3 getCartesian(const Vec3& relOrigin = Vec3());
 };
 
 
@@ -1,34 +1,43 @@
 #ifndef VEC3_H
-#define VEC3_H 
+#define VEC3_H
 #include <GL/glew.h>
 #include <math/Mat4.h>
 
-class Vec3{
+//value type, padded to 16 bytes so arrays of them stay aligned
+class alignas(16) Vec3{
 private:
 	GLfloat x;
 	GLfloat y;
 	GLfloat z;
 public:
-	Vec3();
-	Vec3(GLfloat x, GLfloat y, GLfloat z);
+	constexpr Vec3() : x(0), y(0), z(0){}
+	constexpr Vec3(GLfloat x, GLfloat y, GLfloat z) : x(x), y(y), z(z){}
+	void set(GLfloat x, GLfloat y, GLfloat z);
 	void setX(GLfloat x);
 	void setY(GLfloat y);
 	void setZ(GLfloat z);
-	GLfloat getX();
-	GLfloat getY();
-	GLfloat getZ();
+	constexpr GLfloat getX() const{ return this->x; }
+	constexpr GLfloat getY() const{ return this->y; }
+	constexpr GLfloat getZ() const{ return this->z; }
 	void setComponent(int index, GLfloat value);
-	GLfloat getComponent(int index);
-	Vec3* applyMatrix(Mat4* matrix, GLfloat w, bool normalize = false);
-	void crossProduct(Vec3* vec);
-	static Vec3* crossProductVectors(Vec3* v1, Vec3* v2);
-	static Vec3* addVectors(Vec3* v1, Vec3* v2);
-	static Vec3* subVectors(Vec3* v1, Vec3* v2);
-	GLfloat dotProduct(Vec3* vec);
-	GLfloat distance(Vec3* vec);
+	GLfloat getComponent(int index) const;
+	Vec3 applyMatrix(const Mat4& matrix, GLfloat w, bool normalize = false) const;
+	void crossProduct(const Vec3& vec);
+	static Vec3 crossProductVectors(const Vec3& v1, const Vec3& v2);
+	static Vec3 addVectors(const Vec3& v1, const Vec3& v2);
+	static Vec3 subVectors(const Vec3& v1, const Vec3& v2);
+	GLfloat dotProduct(const Vec3& vec) const;
+	GLfloat distance(const Vec3& vec) const;
 	void normalize();
-	GLfloat length();
-	bool insideUnitCube();
+	GLfloat length() const;
+	bool insideUnitCube() const;
+	constexpr Vec3 operator+(const Vec3& v) const{ return Vec3(this->x + v.x, this->y + v.y, this->z + v.z); }
+	constexpr Vec3 operator-(const Vec3& v) const{ return Vec3(this->x - v.x, this->y - v.y, this->z - v.z); }
+	constexpr Vec3 operator-() const{ return Vec3(-this->x, -this->y, -this->z); }
+	constexpr Vec3 operator*(GLfloat s) const{ return Vec3(this->x * s, this->y * s, this->z * s); }
+	Vec3& operator+=(const Vec3& v);
+	Vec3& operator-=(const Vec3& v);
+	Vec3& operator*=(GLfloat s);
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,12 @@
 #include <GL/glew.h>
 //Geometry owns Buffers (Vertex, Normal, UVs)
 //Future add -> facesArray, bounding box, normals array
+
+//floats per vertex, the position then the normal
+#define GEOMETRY_VERTEX_SIZE 6
+#define GEOMETRY_NORMAL_OFFSET 3
+//vertices 16 bit indices can reach, bigger meshes get 32 bit indices
+#define GEOMETRY_SHORT_INDEX_VERTICES 65536
 struct bounds{
 	GLfloat x[2];
 	GLfloat y[2];
@@ -11,44 +17,76 @@ struct bounds{
 
 typedef struct bounds* BoundingBox;
 
+#define MESH_BINARY_MAGIC 0x4853454d
+#define MESH_BINARY_VERSION 1
+//text meshes are cached next to themselves with this appended
+#define MESH_BINARY_SUFFIX "b"
+
+//start of a binary mesh file, followed by numVertices vertices laid out
+//like Geometry keeps them and numElements indices of indexSize bytes, 2 or
+//4. everything is stored as it is used, loading is mapping the file and
+//copying
+struct meshBinaryHeader{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int numVertices;
+	unsigned int numElements;
+	unsigned int indexSize;
+	struct bounds bounds;
+};
+
+typedef struct meshBinaryHeader* MeshBinaryHeader;
+
 class Geometry{
 private:
+	//GEOMETRY_VERTEX_SIZE floats per vertex, uploaded to one buffer as they are
 	GLfloat* vertices;
 	int numVertices;
-	GLushort* elements;
+	//GLushort or GLuint indices, the narrowest type that holds every index
+	GLvoid* elements;
+	GLenum elementType;
 	int numElements;
-	GLfloat* normals;
-	int numNormals;
-	int numMeshes;
+	int references;
+	//never reused, unlike the address of a deleted geometry
+	unsigned int id;
+	static unsigned int lastId;
 	GLuint vertexBuffer;
 	GLuint elementBuffer;
-	GLuint normalBuffer;
+	//attribute layout of the buffers, built once when they are uploaded
+	GLuint vertexArray;
 	BoundingBox boundingBox;
 	~Geometry();
+	void clearData();
 public:
 	Geometry();
 	int getNumElements();
-	GLushort* getElements();
+	GLvoid* getElements();
+	GLenum getElementType();
+	int getElementSize();
 	void setElements(GLushort* elements, int numElements);
+	void setElements(GLuint* elements, int numElements);
 	GLfloat* getVertices();
 	void setVertices(GLfloat* vertices, int numVertices);
 	int getNumVertices();
-	GLfloat* getNormals();
-	void setNormals(GLfloat* normals, int numNormals);
-	int getNumNormals();
-	void setNumMeshes(int numMeshes);
-	int getNumMeshes();
-	void requestDelete();
+	void retain();
+	void release();
+	int getReferences();
+	unsigned int getId();
 	GLuint getVertexBuffer();
 	void setVertexBuffer(GLuint vertexBuffer);
 	GLuint getElementBuffer();
-	GLuint getNormalBuffer();
-	void setNormalBuffer(GLuint normalBuffer);
 	void setElementBuffer(GLuint elementBuffer);
+	GLuint getVertexArray();
+	void setVertexArray(GLuint vertexArray);
 	void loadDataFromFile(const char* filename);
+	bool loadTextFile(const char* filename);
+	bool loadBinaryFile(const char* filename);
+	bool saveBinaryFile(const char* filename);
 	BoundingBox getBoundingBox();
 	static Geometry* generateCubeGeometry(float size);
 	static Geometry* generateCubeWireframe(float size);
+	static Geometry* generateQuad(float size);
+	static Geometry* generateCylinder(int segments);
 };
 
 #endif
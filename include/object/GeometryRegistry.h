@@ -0,0 +1,31 @@
+#ifndef GEOMETRYREGISTRY_H
+#define GEOMETRYREGISTRY_H
+
+#include <map>
+#include <string>
+#include "object/Geometry.h"
+using namespace std;
+
+//geometries shared by name, files are loaded once and every mesh asking
+//for the same path gets the same arrays and buffers. generated geometries
+//can be added under a name of their own. the registry holds no reference,
+//geometries leave it when their last reference is released
+class GeometryRegistry{
+private:
+	static GeometryRegistry* instance;
+	map<string,Geometry*> geometries;
+	int loads;
+	int hits;
+	GeometryRegistry();
+public:
+	static GeometryRegistry* getInstance();
+	Geometry* getGeometry(const char* filename);
+	Geometry* findGeometry(const char* name);
+	Geometry* addGeometry(const char* name, Geometry* geometry);
+	void removeGeometry(Geometry* geometry);
+	int getNumGeometries();
+	int getLoads();
+	int getHits();
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef INSTANCEDMESH_H
+#define INSTANCEDMESH_H
+#include <vector>
+#include "object/Mesh.h"
+using namespace std;
+//one geometry drawn many times, instances are placed in the mesh's local
+//space and carry the row of their material in the material table
+//spheres are scaled by their radius, cylinders span two endpoints moved by
+//an offset (multiple bonds) and take one material per half
+
+enum InstanceType {SPHERE_INSTANCE,CYLINDER_INSTANCE};
+
+struct sphereInstance{
+	GLfloat position[3];
+	GLfloat radius;
+	GLuint material;
+};
+
+typedef struct sphereInstance* SphereInstance;
+
+struct cylinderInstance{
+	GLfloat start[3];
+	GLfloat radius;
+	GLfloat end[3];
+	GLuint material;
+	GLfloat offset[3];
+	GLuint endMaterial;
+};
+
+typedef struct cylinderInstance* CylinderInstance;
+
+class InstancedMesh : public Mesh{
+private:
+	InstanceType instanceType;
+	vector<struct sphereInstance> spheres;
+	vector<struct cylinderInstance> cylinders;
+	struct bounds instanceBounds;
+	bool boundsDirty;
+	unsigned int instanceVersion;
+	static unsigned int lastInstanceVersion;
+public:
+	InstancedMesh(Geometry* geometry, Material* material, InstanceType instanceType = SPHERE_INSTANCE);
+	InstancedMesh(const InstancedMesh& mesh);
+	InstanceType getInstanceType();
+	void reserve(int numInstances);
+	int addSphere(GLfloat x, GLfloat y, GLfloat z, GLfloat radius, GLuint material);
+	int addCylinder(GLfloat* start, GLfloat* end, GLfloat* offset, GLfloat radius, GLuint material, GLuint endMaterial);
+	void setSpherePosition(int index, GLfloat x, GLfloat y, GLfloat z);
+	void setSphereRadius(int index, GLfloat radius);
+	int getNumInstances();
+	SphereInstance getSpheres();
+	CylinderInstance getCylinders();
+	void clearInstances();
+	//call after writing through getSpheres or getCylinders
+	void instancesChanged();
+	unsigned int getInstanceVersion();
+	void getLocalBounds(BoundingBox bounds);
+};
+
+#endif
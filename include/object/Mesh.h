@@ -22,6 +22,7 @@ public:
 	~Mesh();
 	BoundingBox getBoundingBox();
 	void updateBoundingBox();
+	virtual void getLocalBounds(BoundingBox bounds);
 };
 
 #endif
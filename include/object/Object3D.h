@@ -9,19 +9,33 @@
 
 using namespace std;
 
-class OctreeNode;
-
 class Object3D{
 private:
-	Vec3* position;
-	Euler* rotation;
-	Quaternion* quaternion;
-	Vec3* scale;
-	Mat4 * modelMatrix;
+	Vec3 position;
+	Euler rotation;
+	Quaternion quaternion;
+	Vec3 scale;
+	//local matrix and the transform it was built from, edits made through
+	//the pointer getters are caught by comparing against this snapshot
+	Mat4 localMatrix;
+	Vec3 localPosition;
+	Quaternion localQuaternion;
+	Vec3 localScale;
+	bool localDirty;
+	//world matrix, rebuilt when the local matrix or the parent's changed
+	Mat4 modelMatrix;
+	bool worldDirty;
+	unsigned int worldVersion;
+	unsigned int parentVersion;
+	unsigned int updateFrame;
 	bool visible;
-	OctreeNode* octreeNode;
 	Object3D* parent;
 	float distanceToCamera;
+	static unsigned int localMatrixUpdates;
+	static unsigned int worldMatrixUpdates;
+	bool transformChanged();
+	void updateLocalMatrix();
+	void updateWorldMatrixFromParent();
 public:
 	list<Object3D*> objects;
 	Object3D();
@@ -30,20 +44,26 @@ public:
 	Vec3* getPosition();
 	Euler* getRotation();
 	Vec3* getScale();
-	void setPosition(Vec3* position);
-	void setRotation(Euler* rotation);
-	void setScale(Vec3* scale);
+	void setPosition(const Vec3& position);
+	void setRotation(const Euler& rotation);
+	void setScale(const Vec3& scale);
 	Mat4 * getModelMatrix();
+	Mat4 * getLocalMatrix();
 	void updateModelMatrix();
-	void setQuaternion(Quaternion* quaternion);
+	void updateMatrixHierarchy();
+	void markDirty();
+	unsigned int getWorldVersion();
+	unsigned int getUpdateFrame();
+	void setUpdateFrame(unsigned int updateFrame);
+	static unsigned int getLocalMatrixUpdates();
+	static unsigned int getWorldMatrixUpdates();
+	static void resetMatrixUpdates();
+	void setQuaternion(const Quaternion& quaternion);
 	Quaternion* getQuaternion();
 	bool getVisible();
 	void setVisible(bool visible);
-	OctreeNode* getOctreeNode();
-	void setOctreeNode(OctreeNode* octreeNode);
 	Object3D* getParent();
 	void setParent(Object3D* parent);
-	void updateOctreeNode();
 	float getDistanceToCamera();
 	void setDistanceToCamera(float distanceToCamera);
 };
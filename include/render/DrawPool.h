@@ -0,0 +1,115 @@
+#ifndef DRAWPOOL_H
+#define DRAWPOOL_H
+
+#include <GL/glew.h>
+#include <vector>
+#include <map>
+#include "object/Geometry.h"
+#include "object/InstancedMesh.h"
+#include "material/Material.h"
+#include "render/FrameRing.h"
+using namespace std;
+
+//shader storage binding of the per draw data
+#define DRAW_DATA_BINDING 0
+
+//layout glMultiDrawElementsIndirect reads
+struct drawCommand{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+typedef struct drawCommand* DrawCommand;
+
+//std430 entry of the per draw buffer, the matrix is column major
+struct drawData{
+	GLfloat modelMatrix[16];
+	GLfloat scale;
+	GLfloat padding[3];
+};
+
+typedef struct drawData* DrawData;
+
+//where a geometry or a mesh's instances live in the shared buffers
+struct poolRange{
+	GLint first;
+	GLint count;
+	GLint baseVertex;
+	unsigned int version;
+};
+
+typedef struct poolRange* PoolRange;
+
+//every command of a group is submitted with one multi draw call
+struct drawGroup{
+	Material* material;
+	InstanceType type;
+	GLint firstDraw;
+	GLint numDraws;
+	GLint numInstances;
+	GLint maxDrawInstances;
+};
+
+typedef struct drawGroup* DrawGroup;
+
+//geometry and instances of every multi drawn mesh packed into shared
+//buffers, instances stay in local space and are only uploaded again when a
+//mesh changes them, per frame only the commands and model matrices move and
+//they are written into the frame ring. instances find their materials in
+//the material table
+class DrawPool{
+private:
+	vector<GLfloat> vertices;
+	//kept 32 bit, uploaded 16 bit until a geometry needs more
+	vector<GLuint> elements;
+	GLenum elementType;
+	//keyed by id, a geometry allocated where a released one was must not
+	//get the released one's range
+	map<unsigned int,struct poolRange> geometries;
+	vector<struct sphereInstance> spheres;
+	vector<struct cylinderInstance> cylinders;
+	//one map per instance type, a stale entry is never dereferenced
+	map<InstancedMesh*,struct poolRange> instances[2];
+	int unusedInstances[2];
+	vector<pair<InstancedMesh*,Material*> > frameMeshes;
+	vector<struct drawCommand> commands;
+	vector<struct drawData> draws;
+	vector<struct drawGroup> groups;
+	GLuint vertexBuffer;
+	GLuint elementBuffer;
+	GLuint vertexArray;
+	GLuint instanceBuffers[2];
+	//where this frame's commands were written in the ring
+	GLuint commandBuffer;
+	GLintptr commandOffset;
+	bool geometryDirty;
+	bool instancesDirty[2];
+	int uploadedBytes;
+	PoolRange addGeometry(Geometry* geometry);
+	PoolRange addInstances(InstancedMesh* mesh);
+	void compactInstances(InstanceType type);
+	void uploadBuffer(GLenum target, GLuint* buffer, const void* data, GLsizeiptr size, GLenum usage);
+public:
+	DrawPool();
+	~DrawPool();
+	void begin();
+	void add(InstancedMesh* mesh, Material* material);
+	void upload(FrameRing* ring);
+	int getNumGroups();
+	DrawGroup getGroup(int index);
+	int getNumDraws();
+	int getUploadedBytes();
+	GLuint getVertexBuffer();
+	GLuint getElementBuffer();
+	GLuint getVertexArray();
+	GLenum getElementType();
+	GLuint getInstanceBuffer(InstanceType type);
+	int getNumInstances(InstanceType type);
+	GLuint getCommandBuffer();
+	GLintptr getCommandOffset();
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <GL/glew.h>
+#include <vector>
+using namespace std;
+
+//frames the cpu may write ahead of the gpu, one region of the ring each
+#define FRAME_RING_FRAMES 3
+//bytes per region before the first frame asks for more
+#define FRAME_RING_INITIAL_SIZE 65536
+
+//a buffer mapped once for its whole life, split in one region per frame in
+//flight. everything the renderer streams each frame is written straight
+//into the region of the current frame, a fence tells when the gpu is done
+//with a region so it can be written again. without ARB_buffer_storage the
+//regions are written to a copy in memory and uploaded when bound
+class FrameRing{
+private:
+	GLuint buffer;
+	GLubyte* data;
+	GLsync fences[FRAME_RING_FRAMES];
+	GLsizeiptr regionSize;
+	GLint alignment;
+	int frame;
+	GLsizeiptr offset;
+	bool persistent;
+	//replaced by bigger buffers in the middle of a frame, the frame still
+	//reads them so they are only deleted when the next one begins
+	vector<GLuint> retiredBuffers;
+	vector<GLubyte*> retiredData;
+	int waits;
+	void create(GLsizeiptr regionSize);
+	void release(GLuint buffer, GLubyte* data);
+	void grow(GLsizeiptr size);
+public:
+	FrameRing();
+	~FrameRing();
+	void begin();
+	void* allocate(GLsizeiptr size, GLintptr* offset);
+	void flush(GLintptr offset, GLsizeiptr size);
+	void bind(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size);
+	void end();
+	GLuint getBuffer();
+	GLsizeiptr getRegionSize();
+	GLsizeiptr getUsedBytes();
+	bool isPersistent();
+	int getWaits();
+	static bool isPersistentSupported();
+};
+
+#endif
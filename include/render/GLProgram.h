@@ -3,16 +3,28 @@
 
 #include <GL/glew.h>
 
+//attribute locations bound before linking, every program reads geometry
+//and instances from the same ones so a vertex array works with all of them
+#define ATTRIBUTE_POSITION 0
+#define ATTRIBUTE_NORMAL 1
+#define ATTRIBUTE_INSTANCE_POSITION 2
+#define ATTRIBUTE_INSTANCE_END 3
+#define ATTRIBUTE_INSTANCE_OFFSET 4
+#define ATTRIBUTE_INSTANCE_MATERIAL 5
+#define ATTRIBUTE_INSTANCE_END_MATERIAL 6
+
 struct uniforms {
 	GLuint unifModelMatrix;
 	GLuint unifBlockMatrices;
 	GLuint unifBlockDirectionalLights;
 	GLuint unifBlockPointLights;
 	GLuint unifBlockAmbientLight;
+	GLuint unifBlockMaterialTable;
 	GLuint unifDiffuseColor;
 	GLuint unifSpecularColor;
 	GLuint unifShininess;
 	GLuint unifDistanceToCamera;
+	GLuint unifFirstDraw;
 };
 
 typedef struct uniforms* Uniforms;
@@ -24,15 +36,32 @@ private:
 	GLuint tessEvaluationShader;
 	GLuint tessControlShader;
 	GLuint program;
+	bool retrievable;
 	GLuint attrPosition;
 	GLuint attrNormal;
+	GLuint attrInstancePosition;
+	GLuint attrInstanceEnd;
+	GLuint attrInstanceOffset;
+	GLuint attrInstanceMaterial;
+	GLuint attrInstanceEndMaterial;
 	Uniforms uniforms;
+	static void bindAttributeLocations(GLuint program);
 public:
 	GLProgram();
 	GLuint getAttrPosition();
 	void setAttrPosition(GLuint attrPosition);
 	GLuint getAttrNormal();
 	void setAttrNormal(GLuint attrNormal);
+	GLuint getAttrInstancePosition();
+	void setAttrInstancePosition(GLuint attrInstancePosition);
+	GLuint getAttrInstanceEnd();
+	void setAttrInstanceEnd(GLuint attrInstanceEnd);
+	GLuint getAttrInstanceOffset();
+	void setAttrInstanceOffset(GLuint attrInstanceOffset);
+	GLuint getAttrInstanceMaterial();
+	void setAttrInstanceMaterial(GLuint attrInstanceMaterial);
+	GLuint getAttrInstanceEndMaterial();
+	void setAttrInstanceEndMaterial(GLuint attrInstanceEndMaterial);
 	GLuint getVertexShader();
 	GLuint getFragmentShader();
 	GLuint getTessControlShader();
@@ -47,6 +76,11 @@ public:
 	GLuint compileShader(GLenum type, char* source);
 	GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader);
 	GLuint linkProgramTessellation(GLuint vertexShader, GLuint fragmentShader, GLuint tessControlShader, GLuint tessEvaluationShader);
+	GLuint linkProgramCompute(GLuint computeShader);
+	void setRetrievable(bool retrievable);
+	GLuint loadProgramBinary(GLenum format, const void* binary, GLsizei length);
+	void findLocations();
+	static GLuint makeVertexArray(GLuint vertexBuffer, GLuint elementBuffer);
 	void show_info_log(GLuint object,PFNGLGETSHADERIVPROC glGet__iv,PFNGLGETSHADERINFOLOGPROC glGet__InfoLog);
 	Uniforms getUniforms();
 	void setUniforms(Uniforms uniforms);
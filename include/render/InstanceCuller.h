@@ -0,0 +1,61 @@
+#ifndef INSTANCECULLER_H
+#define INSTANCECULLER_H
+
+#include <GL/glew.h>
+#include "render/GLProgram.h"
+#include "render/DrawPool.h"
+#include "math/Mat4.h"
+#include "math/Frustum.h"
+
+//shader storage bindings of the cull pass, 0 and 1 hold the draw data and
+//material table of the pool
+#define CULL_COMMAND_BINDING 2
+#define CULL_OUTPUT_COMMAND_BINDING 3
+#define CULL_INSTANCE_BINDING 4
+#define CULL_OUTPUT_INSTANCE_BINDING 5
+//invocations per work group, the pyramid pass uses a square of 8x8
+#define CULL_GROUP_SIZE 64
+#define PYRAMID_GROUP_SIZE 8
+
+//tests every instance of the draw pool against the frustum and a depth
+//pyramid of the previous frame on the gpu, the survivors are compacted into
+//a copy of the instance buffers and the instance counts of a copy of the
+//indirect commands, the cpu never looks at single instances
+class InstanceCuller{
+private:
+	GLProgram* resetProgram;
+	GLProgram* cullProgram;
+	GLProgram* pyramidProgram;
+	GLuint commandBuffer;
+	GLuint instanceBuffers[2];
+	GLsizeiptr commandBufferSize;
+	int numDraws;
+	GLsizeiptr instanceBufferSizes[2];
+	//depth of the last frame, copied out of the framebuffer and reduced to
+	//the farthest depth under each texel of every level
+	GLuint depthTexture;
+	GLuint depthFramebuffer;
+	GLuint pyramidTexture;
+	GLenum depthFormat;
+	GLint width;
+	GLint height;
+	GLint pyramidLevels;
+	bool hasPyramid;
+	bool occlusion;
+	Mat4 pyramidViewProjection;
+	static GLProgram* makeProgram(const char* source);
+	void reserveBuffer(GLuint* buffer, GLsizeiptr* bufferSize, GLsizeiptr size);
+	void resizePyramid(GLint width, GLint height, GLenum depthFormat);
+public:
+	InstanceCuller();
+	~InstanceCuller();
+	void cull(DrawPool* pool, const Frustum& frustum);
+	void buildDepthPyramid(const Mat4& viewProjection);
+	int readVisibleInstances();
+	GLuint getCommandBuffer();
+	GLuint getInstanceBuffer(InstanceType type);
+	bool getOcclusion();
+	void setOcclusion(bool occlusion);
+};
+
+#endif
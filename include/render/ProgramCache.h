@@ -0,0 +1,80 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <GL/glew.h>
+#include <map>
+#include <string>
+#include "render/GLProgram.h"
+using namespace std;
+
+#define PROGRAM_CACHE_DIRECTORY "shadercache"
+#define PROGRAM_BINARY_MAGIC 0x4d505242
+//raised when linking changes what a binary holds, like bound attribute
+//locations, older files are then compiled again
+#define PROGRAM_BINARY_VERSION 1
+
+//a linked program, the sources it was built from and how many materials
+//use it
+struct cachedProgram{
+	GLProgram* program;
+	string sources;
+	int references;
+};
+
+typedef struct cachedProgram* CachedProgram;
+
+//start of a program binary file, followed by the sources, the driver and
+//the binary itself
+struct programBinaryHeader{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int sourcesLength;
+	unsigned int driverLength;
+	GLenum format;
+	GLint length;
+};
+
+typedef struct programBinaryHeader* ProgramBinaryHeader;
+
+//programs shared by every material built from the same shader sources,
+//materials of one type then only differ in their uniforms. programs are
+//found by a hash of the sources of every stage and deleted when the last
+//material using them releases them. linked programs are also saved to
+//disk with glGetProgramBinary, next runs load them instead of compiling as
+//long as the sources and the driver are the same
+class ProgramCache{
+private:
+	static ProgramCache* instance;
+	map<unsigned long long,struct cachedProgram> programs;
+	int compiles;
+	int hits;
+	int loads;
+	string directory;
+	string driver;
+	bool diskCache;
+	bool driverChecked;
+	ProgramCache();
+	void checkDriver();
+	string binaryPath(const string& sources);
+	GLuint loadBinary(GLProgram* program, const string& sources);
+	void saveBinary(GLuint prog, const string& sources);
+	static string keySources(const char* vertexSource, const char* fragmentSource,
+	                         const char* tessControlSource, const char* tessEvaluationSource);
+	static unsigned long long hashSources(const string& sources);
+	GLProgram* findProgram(const char* vertexSource, const char* fragmentSource,
+	                       const char* tessControlSource, const char* tessEvaluationSource);
+	static void deleteProgram(GLProgram* program);
+public:
+	static ProgramCache* getInstance();
+	GLProgram* getProgram(const char* vertexSource, const char* fragmentSource);
+	GLProgram* getTessellationProgram(const char* vertexSource, const char* fragmentSource,
+	                                  const char* tessControlSource, const char* tessEvaluationSource);
+	void releaseProgram(GLProgram* program);
+	void setDirectory(const char* directory);
+	int getNumPrograms();
+	int getCompiles();
+	int getHits();
+	int getLoads();
+};
+
+#endif
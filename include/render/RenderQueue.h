@@ -0,0 +1,53 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <GL/glew.h>
+#include <vector>
+#include <map>
+#include "object/Mesh.h"
+#include "material/Material.h"
+#include "render/GLProgram.h"
+using namespace std;
+
+//meshes drawn one by one with their own model matrix
+#define RENDER_PASS_OPAQUE 0
+//instanced meshes, runs with the same key are merged into one draw
+#define RENDER_PASS_INSTANCED 1
+
+//key fields from the most significant bit down, pass, program, geometry,
+//material and the camera distance
+#define RENDER_KEY_PASS_BITS 4
+#define RENDER_KEY_PROGRAM_BITS 10
+#define RENDER_KEY_GEOMETRY_BITS 16
+#define RENDER_KEY_MATERIAL_BITS 16
+#define RENDER_KEY_DEPTH_BITS 18
+//bits sorted per radix pass
+#define RENDER_RADIX_BITS 8
+
+struct renderItem{
+	unsigned long long key;
+	Mesh* mesh;
+};
+
+typedef struct renderItem* RenderItem;
+
+//per frame draw list, sorted so meshes sharing a program, geometry and
+//material end up next to each other and opaque meshes go front to back
+//inside each group
+class RenderQueue{
+private:
+	vector<struct renderItem> items;
+	vector<struct renderItem> sortBuffer;
+	map<GLProgram*,unsigned int> programIds;
+	map<Geometry*,unsigned int> geometryIds;
+	map<Material*,unsigned int> materialIds;
+public:
+	void clear();
+	void add(Mesh* mesh, int pass);
+	void sort();
+	int getNumItems();
+	RenderItem getItems();
+	static unsigned long long makeKey(unsigned int pass, unsigned int program, unsigned int geometry, unsigned int material, float depth);
+};
+
+#endif
@@ -4,33 +4,123 @@
 #include <GL/glew.h>
 #include "light/DirectionalLight.h"
 #include "material/Material.h"
-#include "scene/OctreeNode.h"
+#include "material/MaterialTable.h"
+#include "object/InstancedMesh.h"
+#include "render/RenderQueue.h"
+#include "render/DrawPool.h"
+#include "render/InstanceCuller.h"
+#include "render/FrameRing.h"
+#include "render/UniformBlock.h"
+#include <vector>
 
 struct dirLightsChunk{
   struct dirLight lights[10];
   GLint numDirLights;
 };
 
+typedef struct dirLightsChunk* DirLightsChunk;
+
 struct pLightsChunk{
   struct pLight lights[10];
   GLint numPLights;
 };
 
+typedef struct pLightsChunk* PLightsChunk;
+
+//per frame counters, reset at the start of every render call
+struct renderStats{
+  GLint drawCalls;
+  GLint meshes;
+  GLint instances;
+  GLint batches;
+  GLint localMatrices;
+  GLint worldMatrices;
+  GLint culledObjects;
+  GLint movedObjects;
+  GLint programBinds;
+  GLint bufferBinds;
+  GLint uniformUploads;
+  //bytes written to buffers, uniforms set one by one only count above
+  GLint uploadedBytes;
+};
+
+typedef struct renderStats* RenderStats;
+
 class Renderer{
 private:
-	GLuint vao;
+	vector<struct sphereInstance> sphereData;
+	vector<struct cylinderInstance> cylinderData;
+	bool instancing;
+	bool culling;
+	bool multiDraw;
+	bool gpuCulling;
+	vector<Object3D*> visibleObjects;
+	RenderQueue queue;
+	vector<InstancedMesh*> batch;
+	DrawPool drawPool;
+	//per draw data of the frames in flight
+	FrameRing frameRing;
+	//camera and lights, only written again when their versions change
+	UniformBlock matricesBlock;
+	UniformBlock directionalLightsBlock;
+	UniformBlock ambientLightBlock;
+	UniformBlock pointLightsBlock;
+	//rows instanced materials read, written again when any of them changes
+	UniformBlock materialTableBlock;
+	unsigned int materialTableVersion;
+	Camera* camera;
+	unsigned int cameraVersion;
+	bool cameraChanged;
+	Light* ambientLight;
+	unsigned int ambientLightVersion;
+	vector<pair<Light*,unsigned int> > directionalLightVersions;
+	vector<pair<Light*,unsigned int> > pointLightVersions;
+	//created with the first culled frame, it compiles compute programs
+	InstanceCuller* instanceCuller;
+	//state left bound by the last draw, a change in any of them is the
+	//only reason to touch the gl state again
+	GLProgram* currentProgram;
+	Geometry* currentGeometry;
+	Material* currentMaterial;
+	struct renderStats stats;
 	void calculateGlobalMatrices(Scene* scene);
 	void calculateDirectionalLights(Scene* scene);
 	void calculateAmbientLights(Scene* scene);
 	void calculatePointLights(Scene* scene);
+	void updateMaterialTable();
 	void setMaterialUniforms(Material* material);
+	void makeGeometryBuffers(Geometry* geometry);
+	void bindGeometry(Geometry* geometry);
+	void useProgram(GLProgram* program);
+	void resetState();
+	void renderMesh(Mesh* mesh);
+	void appendInstances(InstancedMesh* mesh);
+	int uploadInstances(InstanceType type, GLintptr* offset);
+	void bindInstanceAttributes(GLProgram* program, InstanceType type, GLuint buffer, GLintptr offset);
+	void unbindInstanceAttributes(GLProgram* program);
+	void renderInstanced(Geometry* geometry, Material* material, vector<InstancedMesh*>& meshes);
+	void renderInstancesSeparately(InstancedMesh* mesh);
+	void renderMultiDraw(const Mat4& viewProjection);
+	static bool isInstanced(Material* material);
 public:
 	Renderer();
+	~Renderer();
 	void render(Scene* scene);
 	GLuint makeBuffer(GLenum target, void* bufferData, GLsizei bufferSize);
-	GLuint makeUBO(void* bufferData, GLsizei bufferSize);
 	GLuint makePointBuffer(GLenum target, void* bufferData, GLsizei bufferSize);
-	void renderOctreeNode(OctreeNode* node);
+	bool getInstancing();
+	void setInstancing(bool instancing);
+	bool getCulling();
+	void setCulling(bool culling);
+	bool getMultiDraw();
+	void setMultiDraw(bool multiDraw);
+	static bool isMultiDrawSupported();
+	bool getGpuCulling();
+	void setGpuCulling(bool gpuCulling);
+	static bool isGpuCullingSupported();
+	InstanceCuller* getInstanceCuller();
+	FrameRing* getFrameRing();
+	RenderStats getStats();
 };
 
 #endif
\ No newline at end of file
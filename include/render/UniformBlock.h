@@ -0,0 +1,31 @@
+#ifndef UNIFORMBLOCK_H
+#define UNIFORMBLOCK_H
+
+#include <GL/glew.h>
+#include "render/FrameRing.h"
+
+//a uniform block that is only written when its contents change, unlike the
+//frame ring which is written every frame. the block has one copy per frame
+//in flight and each change goes to the next one: written at most once per
+//frame, a copy is reused after three changes, so the last frame reading it
+//is at least FRAME_RING_FRAMES frames old and the frame ring waited for it
+class UniformBlock{
+private:
+	GLuint buffer;
+	GLubyte* data;
+	GLuint binding;
+	GLsizeiptr size;
+	GLsizeiptr stride;
+	int current;
+	bool persistent;
+	void create();
+public:
+	UniformBlock(GLuint binding, GLsizeiptr size);
+	~UniformBlock();
+	void* map();
+	void unmap();
+	void bind();
+	GLsizeiptr getSize();
+};
+
+#endif
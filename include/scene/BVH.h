@@ -0,0 +1,98 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <GL/glew.h>
+#include <vector>
+using namespace std;
+
+//most primitives a leaf holds, splits are forced above it
+#define BVH_MAX_LEAF 4
+//centroid bins tried per axis when looking for the cheapest split
+#define BVH_BINS 16
+//cost of visiting a node relative to testing one primitive
+#define BVH_TRAVERSAL_COST 1.0
+//smallest range handed to another thread while building
+#define BVH_PARALLEL_THRESHOLD 8192
+//pending nodes during a query, one per level is enough for the deepest
+//tree the binned splits produce on real data
+#define BVH_STACK_SIZE 128
+
+enum PrimitiveType {SPHERE_PRIMITIVE,CAPSULE_PRIMITIVE};
+
+//a sphere, or a capsule swept from start to end, index is whatever the
+//caller built it from (an atom, a bond, a molecule)
+struct bvhPrimitive{
+	GLfloat start[3];
+	GLfloat radius;
+	GLfloat end[3];
+	GLint type;
+	GLint index;
+};
+
+typedef struct bvhPrimitive* BVHPrimitive;
+
+//nodes are depth first: the left child follows its parent and first is the
+//right child, leaves have count primitives from first in the sorted array
+struct bvhNode{
+	GLfloat min[3];
+	GLint first;
+	GLfloat max[3];
+	GLint count;
+};
+
+typedef struct bvhNode* BVHNode;
+
+//closest primitive found by a query, distance is along the ray or from the
+//point to the primitive surface
+struct bvhHit{
+	GLint primitive;
+	GLint index;
+	GLint type;
+	GLfloat distance;
+};
+
+typedef struct bvhHit* BVHHit;
+
+//box of a primitive while building, the splits reorder these in place so
+//every pass reads them in memory order
+struct bvhReference{
+	GLfloat min[3];
+	GLint primitive;
+	GLfloat max[3];
+};
+
+//bounding volume hierarchy over spheres and capsules, built with a binned
+//surface area heuristic and refit in place when primitives move
+class BVH{
+private:
+	vector<struct bvhPrimitive> primitives;
+	vector<struct bvhNode> nodes;
+	//only kept while building
+	vector<struct bvhReference> references;
+	float maxRadius;
+	int numThreads;
+	void buildNode(vector<struct bvhNode>& nodes, int first, int count, int threadDepth);
+	int findSplit(int first, int count, const GLfloat* centroidMin, const GLfloat* centroidMax, const struct bvhNode* node);
+	void primitiveBounds(int primitive, GLfloat* min, GLfloat* max);
+	static float intersectPrimitive(const struct bvhPrimitive* primitive, const GLfloat* origin, const GLfloat* direction);
+	static float primitiveDistance(const struct bvhPrimitive* primitive, const GLfloat* point);
+	static bool intersectBox(const struct bvhNode* node, const GLfloat* origin, const GLfloat* invDirection, float maxDistance, float* entry);
+	static float boxDistance(const struct bvhNode* node, const GLfloat* point);
+	static bool compareHits(const struct bvhHit& h1, const struct bvhHit& h2);
+public:
+	BVH();
+	void build(const struct bvhPrimitive* primitives, int numPrimitives);
+	void refit();
+	bool raycast(const GLfloat* origin, const GLfloat* direction, float maxDistance, BVHHit hit);
+	int raycastAll(const GLfloat* origin, const GLfloat* direction, float maxDistance, vector<struct bvhHit>& hits);
+	bool closestPrimitive(const GLfloat* point, float maxDistance, BVHHit hit);
+	BVHPrimitive getPrimitives();
+	int getNumPrimitives();
+	BVHNode getNodes();
+	int getNumNodes();
+	int getNumThreads();
+	void setNumThreads(int numThreads);
+	void getBounds(GLfloat* min, GLfloat* max);
+};
+
+#endif
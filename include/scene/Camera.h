@@ -9,22 +9,30 @@
 
 class Camera : public Object3D{
 private:
-	Mat4 * projectionMatrix;
-	Mat4 * worldMatrix;
-	Vec3* target;
-	GLuint matricesUBO;
+	Mat4 projectionMatrix;
+	Mat4 worldMatrix;
+	Vec3 target;
+	bool hasTarget;
+	//bumped whenever either matrix changes, the matrices are only seen to
+	//change through the setters and updateWorldMatrix
+	unsigned int version;
+	//what the world matrix was last built from
+	unsigned int viewWorldVersion;
+	Vec3 viewTarget;
+	bool viewHasTarget;
+	bool targetChanged();
 public:
 	Mat4* getProjectionMatrix();
-	void setProjectionMatrix(Mat4* mat);
+	void setProjectionMatrix(const Mat4& mat);
 	Mat4* getWorldMatrix();
-	void setWorldMatrix(Mat4* mat);
+	void setWorldMatrix(const Mat4& mat);
 	void updateWorldMatrix();
-	GLuint getMatricesUBO();
-	void setMatricesUBO(GLuint ubo);
-	GLfloat* getMatricesArray();
+	void getMatricesArray(GLfloat* matrices);
 	Vec3* getTarget();
-	void setTarget(Vec3* target);
-	Mat4* lookAt();
+	void setTarget(const Vec3& target);
+	void clearTarget();
+	Mat4 lookAt();
+	unsigned int getVersion();
 	Camera();
 	~Camera();
 };
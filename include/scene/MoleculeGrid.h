@@ -0,0 +1,15 @@
+#ifndef MOLECULEGRID_H
+#define MOLECULEGRID_H
+
+#include "object/Object3D.h"
+
+//the dim^3 grid of molecules the viewer shows, index i*dim*dim + j*dim + k
+//sits in row i, column j, layer k. the benchmarks lay out and move their
+//objects through here so they measure the scene the viewer draws
+class MoleculeGrid{
+public:
+	static void place(Object3D* object, int index, int dim);
+	static void move(Object3D* object, int index, int dim, int time);
+};
+
+#endif
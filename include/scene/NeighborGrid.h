@@ -0,0 +1,30 @@
+#ifndef NEIGHBORGRID_H
+#define NEIGHBORGRID_H
+
+#include <vector>
+using namespace std;
+
+//uniform grid over a point set, cells are hashed so sparse or huge boxes
+//only cost memory proportional to the number of points
+class NeighborGrid{
+private:
+	float cellSize;
+	float invCellSize;
+	float origin[3];
+	unsigned int tableMask;
+	vector<int> cellStart;
+	vector<int> sortedIndices;
+	vector<unsigned long long> sortedKeys;
+	vector<float> sortedPositions;
+	void cellCoords(float x, float y, float z, int* cell);
+	unsigned int hashCell(int* cell);
+	static unsigned long long packCell(int* cell);
+public:
+	NeighborGrid(float cellSize);
+	void build(const float* positions, int numPoints);
+	void query(float x, float y, float z, float radius, vector<int>* result);
+	int getNumPoints();
+	float getCellSize();
+};
+
+#endif
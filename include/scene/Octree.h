@@ -0,0 +1,97 @@
+#ifndef OCTREE_H
+#define OCTREE_H
+
+#include <GL/glew.h>
+#include <list>
+#include <vector>
+#include "object/Object3D.h"
+#include "math/Vec3.h"
+#include "math/Frustum.h"
+using namespace std;
+
+//levels below the root, 8^4 leaves
+#define OCTREE_DEFAULT_DEPTH 4
+//deepest tree that can be built, 299593 nodes
+#define OCTREE_MAX_DEPTH 6
+//nodes hold boxes reaching this many times their half size from the center
+#define OCTREE_LOOSENESS 2.0
+//end of an object list
+#define OCTREE_NONE -1
+
+//children are not stored: nodes are laid out depth first in morton order,
+//so a node's subtree is the range of nodes right after it
+struct octant{
+	GLfloat center[3];
+	GLfloat halfSize;
+	GLint level;
+	GLint parent;
+	GLint firstEntry;
+	GLint numObjects;
+	GLint branchObjects;
+};
+
+typedef struct octant* Octant;
+
+//an object and the world box it was placed with, linked into its node's list
+struct octreeEntry{
+	Object3D* object;
+	GLfloat min[3];
+	GLfloat max[3];
+	GLint node;
+	GLint next;
+	GLint prev;
+	unsigned int version;
+};
+
+typedef struct octreeEntry* OctreeEntry;
+
+//counters of the last update and cull
+struct cullStats{
+	GLint objectsUpdated;
+	GLint objectsMoved;
+	GLint nodesVisited;
+	GLint objectsTested;
+	GLint visibleObjects;
+};
+
+typedef struct cullStats* CullStats;
+
+//loose octree over the world bounding boxes of meshes, an object goes in
+//the node its center falls in at the level its size fits, so it is placed
+//without descending the tree and only changes node once its box leaves the
+//loose bounds, objects outside the root are always tested one by one
+class Octree{
+private:
+	GLfloat center[3];
+	GLfloat size;
+	int depth;
+	vector<struct octant> nodes;
+	vector<int> subtreeSize;
+	vector<struct octreeEntry> entries;
+	GLint overflowHead;
+	int numOverflow;
+	struct cullStats stats;
+	void generateNodes();
+	int findNode(const GLfloat* min, const GLfloat* max);
+	bool entryFits(struct octreeEntry* entry);
+	void readBounds(struct octreeEntry* entry);
+	void link(int index, int node);
+	void unlink(int index);
+	void testObjects(const Frustum& frustum, int first, int mask, vector<Object3D*>& visible);
+	void appendBranch(int node, vector<Object3D*>& visible);
+public:
+	Octree(const Vec3& center, float size, int depth = OCTREE_DEFAULT_DEPTH);
+	void build(list<Object3D*>& objects);
+	int update();
+	int cull(const Frustum& frustum, vector<Object3D*>& visible);
+	int getDepth();
+	void setDepth(int depth);
+	float getSize();
+	int getNumNodes();
+	int getNumObjects();
+	Octant getNode(int index);
+	CullStats getStats();
+	void print();
+};
+
+#endif
@@ -2,13 +2,15 @@
 #define SCENE_H
 #include <cstdlib>
 #include <list>
+#include <vector>
 #include "object/Object3D.h"
 #include "math/Mat4.h"
 #include "scene/Camera.h"
 #include "light/Light.h"
 #include "light/DirectionalLight.h"
 #include "light/PointLight.h"
-#include "scene/OctreeNode.h"
+#include "scene/Octree.h"
+#include "math/Frustum.h"
 
 using namespace std;
 
@@ -21,10 +23,10 @@ private:
 	Light * ambientLight;
 	list<DirectionalLight*> directionalLights;
 	list<PointLight*> pointLights;
-	GLuint pointLightsUBO;
-	GLuint directionalLightsUBO;
-	GLuint ambientLightUBO;
-	OctreeNode* octree;
+	Octree* octree;
+	bool octreeDirty;
+	Frustum frustum;
+	unsigned int matrixFrame;
 public:
 	Scene();
 	list<Object3D*> getObjects();
@@ -36,18 +38,15 @@ public:
 	void setCamera(Camera* camera);
 	Light* getAmbientLight();
 	void setAmbientLight(Light* ambientLight);
-	list<DirectionalLight*> getDirectionalLights();
+	list<DirectionalLight*>& getDirectionalLights();
 	void addDirectionalLight(DirectionalLight* light);
-	list<PointLight*> getPointLights();
+	list<PointLight*>& getPointLights();
 	void addPointLight(PointLight* pointLight);
-	GLuint getPointLightsUBO();
-	void setPointLightsUBO(GLuint pointLightsUBO);
-	GLuint getDirectionalLightsUBO();
-	GLuint getAmbientLightUBO();
-	void setDirectionalLightsUBO(GLuint directionalLightsUBO);
-	void setAmbientLightUBO(GLuint ambientLightUBO);
-	OctreeNode* getOctree();
+	Octree* getOctree();
 	void generateOctree();
+	Frustum* getFrustum();
+	int cullObjects(vector<Object3D*>& visible);
+	void updateMatrices();
 	~Scene();
 };
 #endif
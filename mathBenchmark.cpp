@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <new>
+#include <vector>
+#include "benchmark.h"
+#include "object/Object3D.h"
+#include "scene/Camera.h"
+#include "light/DirectionalLight.h"
+#include "light/PointLight.h"
+using namespace std;
+
+//same layout as the molecule grid in main.cpp
+#define NUM_OBJECTS 64
+//points per batch in the transform kernel benchmark
+#define NUM_POINTS 65536
+
+//every heap allocation in the process goes through here
+static unsigned long allocations = 0;
+
+void* operator new(size_t size){
+	allocations++;
+	void* p = malloc(size ? size : 1);
+	if(p == NULL) throw bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size){
+	allocations++;
+	void* p = malloc(size ? size : 1);
+	if(p == NULL) throw bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) throw(){
+	free(p);
+}
+
+void operator delete[](void* p) throw(){
+	free(p);
+}
+
+void operator delete(void* p, size_t) throw(){
+	free(p);
+}
+
+void operator delete[](void* p, size_t) throw(){
+	free(p);
+}
+
+//previous Mat4: elements behind a pointer and a new array on every multiply
+GLfloat* legacyMatrix(GLfloat diagonal){
+	GLfloat* m = new GLfloat[16];
+	for(int i = 0; i < 16; i++) m[i] = (i % 5 == 0) ? diagonal : 0;
+	return m;
+}
+
+void legacyCrossProduct(GLfloat** a, GLfloat* b){
+	GLfloat* temp = new GLfloat[16];
+	Mat4::multiply(*a,b,temp);
+	delete[] *a;
+	*a = temp;
+}
+
+//previous Object3D::updateModelMatrix: three temporaries plus a new result
+void legacyModelMatrix(Object3D* object, GLfloat** modelMatrix){
+	Vec3* position = object->getPosition();
+	Vec3* scale = object->getScale();
+	GLfloat* translation = legacyMatrix(1);
+	translation[3] = position->getX();
+	translation[7] = position->getY();
+	translation[11] = position->getZ();
+	GLfloat* rot = legacyMatrix(1);
+	memcpy(rot,Mat4::rotationMatrixFromQuaternion(*(object->getQuaternion())).getElements(),sizeof(GLfloat)*16);
+	GLfloat* scaleMatrix = legacyMatrix(1);
+	scaleMatrix[0] = scale->getX();
+	scaleMatrix[5] = scale->getY();
+	scaleMatrix[10] = scale->getZ();
+	delete[] *modelMatrix;
+	*modelMatrix = legacyMatrix(1);
+	legacyCrossProduct(modelMatrix,translation);
+	legacyCrossProduct(modelMatrix,rot);
+	legacyCrossProduct(modelMatrix,scaleMatrix);
+	delete[] scaleMatrix;
+	delete[] rot;
+	delete[] translation;
+}
+
+//one frame of the per object math the renderer does
+float frame(Object3D** objects, GLfloat** legacy, Camera* camera, DirectionalLight* dirLight, PointLight* pointLight){
+	float checksum = 0;
+	GLfloat matrices[32];
+	struct dirLight dirStruct;
+	struct pLight pointStruct;
+	camera->getPosition()->setX(camera->getPosition()->getX() + 0.001);
+	camera->updateWorldMatrix();
+	camera->getMatricesArray(matrices);
+	dirLight->getAsStruct(camera,&dirStruct);
+	pointLight->getAsStruct(camera,&pointStruct);
+	checksum += matrices[3] + dirStruct.vectorToLight[0] + pointStruct.position[0];
+	for(int i = 0; i < NUM_OBJECTS; i++){
+		objects[i]->getQuaternion()->setY(objects[i]->getQuaternion()->getY() + 0.001);
+		if(legacy != NULL){
+			legacyModelMatrix(objects[i],&(legacy[i]));
+			checksum += legacy[i][3];
+			continue;
+		}
+		objects[i]->updateModelMatrix();
+		GLfloat corners[24];
+		for(int corner = 0; corner < 8; corner++){
+			corners[corner*3] = corner & 1 ? 1 : -1;
+			corners[corner*3+1] = corner & 2 ? 1 : -1;
+			corners[corner*3+2] = corner & 4 ? 1 : -1;
+		}
+		Mat4::transformPoints(*(objects[i]->getModelMatrix()),corners,corners,8);
+		checksum += corners[0];
+	}
+	return checksum;
+}
+
+void benchmark(const char* name, Object3D** objects, GLfloat** legacy, Camera* camera, DirectionalLight* dirLight, PointLight* pointLight){
+	int frames = 0;
+	float checksum = 0;
+	unsigned long startAllocations = allocations;
+	clock_t start = clock();
+	double elapsed = 0;
+	while(elapsed < MIN_SECONDS){
+		checksum += frame(objects,legacy,camera,dirLight,pointLight);
+		frames++;
+		elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+	}
+	printf("%-8s %3d objects %8.4f ms/frame %8.1f allocations/frame (checksum %g)\n",
+		name,
+		NUM_OBJECTS,
+		elapsed * 1000.0 / frames,
+		(double)(allocations - startAllocations) / frames,
+		checksum
+	);
+}
+
+//times the multiply and batched transform kernels at every simd level
+//the cpu supports, results are checked against the scalar kernels
+void benchmarkKernels(){
+	const char* levelNames[3] = {"scalar","sse","avx2"};
+	vector<GLfloat> points(NUM_POINTS * 3);
+	vector<GLfloat> result(NUM_POINTS * 3);
+	vector<GLfloat> reference(NUM_POINTS * 3);
+	srand(1);
+	for(int i = 0; i < NUM_POINTS * 3; i++){
+		points[i] = rand() / (float)RAND_MAX * 20.0 - 10.0;
+	}
+	Mat4 matrix = Mat4::perspectiveMatrix(30.0, 1280.0/720.0, 0.1, 100.0) *
+	              Mat4::translationMatrix(1,2,-30) *
+	              Mat4::rotationMatrix(10,20,30);
+	Mat4 rotation = Mat4::rotationMatrix(1,2,3);
+	Mat4 product;
+	int supported = Mat4::getSupportedSimdLevel();
+	for(int level = SIMD_SCALAR; level <= supported; level++){
+		Mat4::setSimdLevel(level);
+
+		product = matrix;
+		int multiplies = 0;
+		clock_t start = clock();
+		double elapsed = 0;
+		while(elapsed < MIN_SECONDS){
+			//an orthonormal factor keeps the chained product bounded
+			for(int i = 0; i < 10000; i++){
+				product *= rotation;
+			}
+			multiplies += 10000;
+			elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+		}
+		double multiplyRate = multiplies / elapsed;
+
+		int batches = 0;
+		start = clock();
+		elapsed = 0;
+		while(elapsed < MIN_SECONDS){
+			Mat4::transformPoints(matrix,&points[0],&result[0],NUM_POINTS,3,1,true);
+			batches++;
+			elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+		}
+		double pointRate = (double)batches * NUM_POINTS / elapsed;
+
+		if(level == SIMD_SCALAR) reference = result;
+		double maxError = 0;
+		for(int i = 0; i < NUM_POINTS * 3; i++){
+			maxError = fmax(maxError,fabs(result[i] - reference[i]));
+		}
+		printf("%-8s %12.0f multiplies/s %14.0f points/s  max error %g checksum %g\n",
+			levelNames[level],
+			multiplyRate,
+			pointRate,
+			maxError,
+			product.getElements()[0]
+		);
+	}
+	Mat4::setSimdLevel(supported);
+}
+
+int main (int argc, char** argv){
+	Object3D* objects[NUM_OBJECTS];
+	GLfloat* legacy[NUM_OBJECTS];
+	for(int i = 0; i < NUM_OBJECTS; i++){
+		objects[i] = new Object3D();
+		objects[i]->setPosition(Vec3(i % 4 * 10, i / 4 % 4 * 12, i / 16 * 8));
+		legacy[i] = NULL;
+	}
+	Camera* camera = new Camera();
+	camera->setProjectionMatrix(Mat4::perspectiveMatrix(30.0, 1280.0/720.0, 0.1, 100.0));
+	camera->getPosition()->setZ(12.0);
+	camera->setTarget(Vec3(0,0,0));
+	DirectionalLight* dirLight = new DirectionalLight();
+	dirLight->setPosition(Vec3(2,4,5));
+	PointLight* pointLight = new PointLight();
+
+	benchmark("legacy",objects,legacy,camera,dirLight,pointLight);
+	benchmark("value",objects,NULL,camera,dirLight,pointLight);
+	benchmarkKernels();
+
+	for(int i = 0; i < NUM_OBJECTS; i++){
+		delete objects[i];
+		delete[] legacy[i];
+	}
+	delete camera;
+	delete dirLight;
+	delete pointLight;
+	return 0;
+}
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <sys/stat.h>
+#include "benchmark.h"
+#include "object/Geometry.h"
+using namespace std;
+
+//segments of the generated cylinder, two vertices each so it needs 32 bit
+//indices
+#define LARGE_SEGMENTS 1000000
+#define LARGE_MESH_FILE "generated-cylinder.meshb"
+
+const char* meshFiles[] = {
+	"icosahedron.mesh",
+	"icosphere.mesh",
+	"highres-icosphere.mesh",
+	"cylinder.mesh",
+	"robot.mesh"
+};
+
+long fileSize(const char* filename){
+	struct stat fileStat;
+	if(stat(filename,&fileStat) != 0) return 0;
+	return fileStat.st_size;
+}
+
+//milliseconds per load, the same geometry is reloaded so only the loading
+//is measured
+double timeLoads(Geometry* geometry, const char* filename, bool binary){
+	int loads = 0;
+	double elapsed = 0;
+	clock_t start = clock();
+	while(elapsed < MIN_SECONDS){
+		bool loaded = binary ? geometry->loadBinaryFile(filename) : geometry->loadTextFile(filename);
+		if(!loaded) return -1;
+		loads++;
+		elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+	}
+	return elapsed * 1000.0 / loads;
+}
+
+//both formats have to give the same arrays and bounds
+bool sameData(Geometry* a, Geometry* b){
+	return a->getNumVertices() == b->getNumVertices() &&
+	       a->getNumElements() == b->getNumElements() &&
+	       a->getElementType() == b->getElementType() &&
+	       !memcmp(a->getVertices(),b->getVertices(),sizeof(GLfloat) * a->getNumVertices() * GEOMETRY_VERTEX_SIZE) &&
+	       !memcmp(a->getElements(),b->getElements(),a->getElementSize() * a->getNumElements()) &&
+	       !memcmp(a->getBoundingBox(),b->getBoundingBox(),sizeof(struct bounds));
+}
+
+//a mesh past what 16 bit indices reach, saved and loaded back from binary
+void largeMesh(){
+	Geometry* generated = Geometry::generateCylinder(LARGE_SEGMENTS);
+	Geometry* binary = new Geometry();
+	if(!generated->saveBinaryFile(LARGE_MESH_FILE)){
+		printf("%-24s could not be saved\n",LARGE_MESH_FILE);
+	}
+	else{
+		double binaryTime = timeLoads(binary,LARGE_MESH_FILE,true);
+		bool mismatch = binaryTime < 0 || !sameData(generated,binary);
+		printf("%-24s %7d vertices %7d triangles %2d bit  binary %8d bytes %9.4f ms%s\n",
+			LARGE_MESH_FILE,
+			generated->getNumVertices(),
+			generated->getNumElements() / 3,
+			generated->getElementSize() * 8,
+			(int)fileSize(LARGE_MESH_FILE),
+			binaryTime,
+			mismatch ? "  MISMATCH" : ""
+		);
+		remove(LARGE_MESH_FILE);
+	}
+	generated->release();
+	binary->release();
+}
+
+//every bundled mesh loaded from its text and from the binary written by
+//the converter, run from the directory with the meshes
+int main(){
+	int numFiles = sizeof(meshFiles) / sizeof(meshFiles[0]);
+	for(int i = 0; i < numFiles; i++){
+		string binaryFile = string(meshFiles[i]) + MESH_BINARY_SUFFIX;
+		Geometry* text = new Geometry();
+		Geometry* binary = new Geometry();
+		if(!text->loadTextFile(meshFiles[i]) || !text->saveBinaryFile(binaryFile.c_str())){
+			printf("%-24s could not be converted\n",meshFiles[i]);
+			continue;
+		}
+		double textTime = timeLoads(text,meshFiles[i],false);
+		double binaryTime = timeLoads(binary,binaryFile.c_str(),true);
+		bool mismatch = binaryTime < 0 || !sameData(text,binary);
+		printf("%-24s %7d vertices %7d triangles %2d bit  text %8d bytes %9.4f ms  binary %8d bytes %9.4f ms  %6.1fx%s\n",
+			meshFiles[i],
+			text->getNumVertices(),
+			text->getNumElements() / 3,
+			text->getElementSize() * 8,
+			(int)fileSize(meshFiles[i]),
+			textTime,
+			(int)fileSize(binaryFile.c_str()),
+			binaryTime,
+			binaryTime > 0 ? textTime / binaryTime : 0,
+			mismatch ? "  MISMATCH" : ""
+		);
+		text->release();
+		binary->release();
+	}
+	largeMesh();
+	return 0;
+}
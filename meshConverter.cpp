@@ -0,0 +1,32 @@
+#include <cstdio>
+#include <string>
+#include "object/Geometry.h"
+using namespace std;
+
+//converts a .mesh text file to the binary format Geometry maps. the output
+//defaults to the input name followed by MESH_BINARY_SUFFIX, which is where
+//Geometry::loadDataFromFile looks for it
+int main(int argc, char** argv){
+	if(argc < 2 || argc > 3){
+		fprintf(stderr,"usage: %s input.mesh [output.meshb]\n",argv[0]);
+		return 1;
+	}
+	string output = argc == 3 ? argv[2] : string(argv[1]) + MESH_BINARY_SUFFIX;
+	Geometry* geometry = new Geometry();
+	if(!geometry->loadTextFile(argv[1])){
+		fprintf(stderr,"could not read %s\n",argv[1]);
+		return 1;
+	}
+	if(!geometry->saveBinaryFile(output.c_str())){
+		fprintf(stderr,"could not write %s\n",output.c_str());
+		return 1;
+	}
+	printf("%s: %d vertices, %d triangles -> %s\n",
+		argv[1],
+		geometry->getNumVertices(),
+		geometry->getNumElements() / 3,
+		output.c_str()
+	);
+	geometry->release();
+	return 0;
+}
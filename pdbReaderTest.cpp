@@ -3,8 +3,17 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "benchmark.h"
+#include "PDBReader.h"
+#include "scene/NeighborGrid.h"
 using namespace std;
 
+//brute force bond perception is skipped above this size
+#define MAX_BRUTE_FORCE_ATOMS 20000
+
 char* substr(const char* source, int i, int n){
 	char* substr = new char[n+1];
 	int len = strlen(source);
@@ -14,35 +23,186 @@ char* substr(const char* source, int i, int n){
 	return substr;
 }
 
-int main (int argv, char** argc){
+//previous reader: getline + one allocation per field
+int readLegacy(const char* filename){
 	ifstream pdbFile;
 	char line [90];
-	pdbFile.open("water.pdb");
+	int numAtoms = 0;
+	float sum = 0;
+	pdbFile.open(filename);
 	if (pdbFile.is_open()){
 	    while (!pdbFile.eof()){
 	      pdbFile.getline(line,81);
 	      int len = strlen(line);
 	      if(len == 80){
 	      	char* recordName = substr(line,0,6);
+	      	if(!strcmp(recordName,"ENDMDL")){
+	      		delete[] recordName;
+	      		break;
+	      	}
 	      	if(!strcmp(recordName,"ATOM  ") || !strcmp(recordName,"HETATM")){
 	      		char* element;
 	      		element = isdigit(line[12])? substr(line,13,1): substr(line,12,2);
-	      		cout << "Symbol: " << element << '\n'; 
 	      		char* x = substr(line,30,8);
-	      		cout << "x: " << atof(x) << '\n';
-	      		delete x;
 	      		char* y = substr(line,38,8);
-	      		cout << "y: " << atof(y) << '\n';
-	      		delete y;
 	      		char* z = substr(line,46,8);
-	      		cout << "z: " << atof(z) << '\n';
-	      		delete z;
+	      		sum += atof(x) + atof(y) + atof(z);
+	      		delete[] x;
+	      		delete[] y;
+	      		delete[] z;
+	      		delete[] element;
+	      		numAtoms++;
 	      	}
-	      	cout << "----------------------------\n";
-	      	delete recordName;
+	      	delete[] recordName;
 	      }
 	    }
 	    pdbFile.close();
   	}
+  	return sum != sum ? 0 : numAtoms;
+}
+
+int readMapped(const char* filename){
+	PDBReader reader;
+	reader.read(filename);
+	return reader.getNumAtoms();
+}
+
+void benchmark(const char* name, const char* filename, int (*readFile)(const char*)){
+	PDBReader reader;
+	if(!reader.read(filename)){
+		printf("%s: unable to open %s\n",name,filename);
+		return;
+	}
+	double megabytes = reader.getFileSize() / (1024.0 * 1024.0);
+	int iterations = 0;
+	int numAtoms = 0;
+	double start = now();
+	double elapsed = 0;
+	while(elapsed < MIN_SECONDS){
+		numAtoms = readFile(filename);
+		iterations++;
+		elapsed = now() - start;
+	}
+	printf("%-8s %-12s %7d atoms %8.3f ms/read %9.2f MB/s %12.0f atoms/s\n",
+		name,
+		filename,
+		numAtoms,
+		elapsed * 1000.0 / iterations,
+		megabytes * iterations / elapsed,
+		(double)numAtoms * iterations / elapsed
+	);
+}
+
+//same distance rule as Molecule::atomsConnected
+bool bonded(float distance, bool hydrogen){
+	return distance >= 0.4 && distance <= (hydrogen ? 1.2 : 1.9);
+}
+
+float distance(const float* positions, int i, int j){
+	float dx = positions[j*3] - positions[i*3];
+	float dy = positions[j*3+1] - positions[i*3+1];
+	float dz = positions[j*3+2] - positions[i*3+2];
+	return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+int bondsBruteForce(const float* positions, const char* hydrogen, int numAtoms){
+	int numBonds = 0;
+	for(int i = 0; i < numAtoms; i++){
+		for(int j = i+1; j < numAtoms; j++){
+			if(bonded(distance(positions,i,j),hydrogen[i] || hydrogen[j])) numBonds++;
+		}
+	}
+	return numBonds;
+}
+
+int bondsGrid(const float* positions, const char* hydrogen, int numAtoms){
+	int numBonds = 0;
+	NeighborGrid grid(1.9);
+	grid.build(positions,numAtoms);
+	vector<int> neighbors;
+	for(int i = 0; i < numAtoms; i++){
+		neighbors.clear();
+		grid.query(positions[i*3],positions[i*3+1],positions[i*3+2],1.9,&neighbors);
+		int numNeighbors = neighbors.size();
+		for(int k = 0; k < numNeighbors; k++){
+			int j = neighbors[k];
+			if(j > i && bonded(distance(positions,i,j),hydrogen[i] || hydrogen[j])) numBonds++;
+		}
+	}
+	return numBonds;
+}
+
+void benchmarkBonds(const char* name, vector<float>& positions, vector<char>& hydrogen){
+	int numAtoms = hydrogen.size();
+	int (*methods[2])(const float*, const char*, int) = {bondsBruteForce,bondsGrid};
+	const char* methodNames[2] = {"n^2","grid"};
+	for(int m = 0; m < 2; m++){
+		if(m == 0 && numAtoms > MAX_BRUTE_FORCE_ATOMS){
+			printf("%-4s %-14s %8d atoms          skipped\n",methodNames[m],name,numAtoms);
+			continue;
+		}
+		int iterations = 0;
+		int numBonds = 0;
+		double start = now();
+		double elapsed = 0;
+		while(elapsed < MIN_SECONDS){
+			numBonds = methods[m](&positions[0],&hydrogen[0],numAtoms);
+			iterations++;
+			elapsed = now() - start;
+		}
+		printf("%-4s %-14s %8d atoms %8d bonds %10.3f ms %12.0f atoms/s\n",
+			methodNames[m],
+			name,
+			numAtoms,
+			numBonds,
+			elapsed * 1000.0 / iterations,
+			(double)numAtoms * iterations / elapsed
+		);
+	}
+}
+
+//jittered lattice with 1.5A spacing so every atom has a few bonded neighbors
+void syntheticBox(int numAtoms, vector<float>& positions, vector<char>& hydrogen){
+	int side = (int)ceil(pow(numAtoms,1.0/3.0));
+	positions.resize(numAtoms * 3);
+	hydrogen.resize(numAtoms);
+	srand(1);
+	for(int i = 0; i < numAtoms; i++){
+		positions[i*3] = (i % side) * 1.5 + (rand() / (float)RAND_MAX - 0.5) * 0.4;
+		positions[i*3+1] = ((i / side) % side) * 1.5 + (rand() / (float)RAND_MAX - 0.5) * 0.4;
+		positions[i*3+2] = (i / (side * side)) * 1.5 + (rand() / (float)RAND_MAX - 0.5) * 0.4;
+		hydrogen[i] = (i % 4) == 0;
+	}
+}
+
+int main (int argc, char** argv){
+	const char* defaultFiles[] = {"1CAG.pdb","2HIU.pdb"};
+	const char** files = argc > 1 ? (const char**)(argv + 1) : defaultFiles;
+	int numFiles = argc > 1 ? argc - 1 : 2;
+	for(int i = 0; i < numFiles; i++){
+		benchmark("legacy",files[i],readLegacy);
+		benchmark("mapped",files[i],readMapped);
+	}
+
+	vector<float> positions;
+	vector<char> hydrogen;
+	PDBReader reader;
+	if(reader.read("caffeine.pdb")){
+		for(int i = 0; i < reader.getNumAtoms(); i++){
+			PDBAtom atom = &(reader.getAtoms()[i]);
+			positions.push_back(atom->x);
+			positions.push_back(atom->y);
+			positions.push_back(atom->z);
+			hydrogen.push_back(!strcmp(atom->element,"H"));
+		}
+		benchmarkBonds("caffeine.pdb",positions,hydrogen);
+	}
+	int sizes[] = {1000,10000,100000,1000000};
+	for(int i = 0; i < 4; i++){
+		char name[32];
+		sprintf(name,"box %d",sizes[i]);
+		syntheticBox(sizes[i],positions,hydrogen);
+		benchmarkBonds(name,positions,hydrogen);
+	}
   	return 0;
-}
\ No newline at end of file
+}
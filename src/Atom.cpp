@@ -1,32 +1,56 @@
 #include "Atom.h"
+#include <cmath>
 
-Atom::Atom(const char* symbol, Mesh * mesh){
-	this->symbol = strdup(symbol);
-	this->mesh = mesh;
+Atom::Atom(AtomTable* table, int index){
+	this->table = table;
+	this->index = index;
 }
 
-Atom::Atom(const Atom& atom){
-	this->symbol = atom.symbol;
-	this->mesh = new Mesh(*(atom.mesh));
+int Atom::getIndex(){
+	return this->index;
 }
 
-Atom::~Atom(){
-	delete this->symbol;
+const char* Atom::getSymbol(){
+	return this->table->getSymbol(this->index);
 }
 
-char* Atom::getSymbol(){
-	return this->symbol;
+float Atom::getX(){
+	return this->table->getPosition(this->index)[0];
 }
 
-void Atom::setSymbol(const char* symbol){
-	delete symbol;
-	this->symbol = strdup(symbol);
+float Atom::getY(){
+	return this->table->getPosition(this->index)[1];
 }
 
-Mesh* Atom::getMesh(){
-	return this->mesh;
+float Atom::getZ(){
+	return this->table->getPosition(this->index)[2];
 }
 
-void Atom::setMesh(Mesh* mesh){
-	this->mesh = mesh;
+float Atom::getRadius(){
+	return this->table->getRadius(this->index);
+}
+
+unsigned int Atom::getColor(){
+	return this->table->getColor(this->index);
+}
+
+int Atom::getResidue(){
+	return this->table->getResidue(this->index);
+}
+
+char Atom::getChain(){
+	return this->table->getChain(this->index);
+}
+
+bool Atom::isHydrogen(){
+	return this->table->isHydrogen(this->index);
+}
+
+float Atom::distance(Atom atom){
+	float* p1 = this->table->getPosition(this->index);
+	float* p2 = atom.table->getPosition(atom.index);
+	float dx = p2[0] - p1[0];
+	float dy = p2[1] - p1[1];
+	float dz = p2[2] - p1[2];
+	return sqrt(dx*dx + dy*dy + dz*dz);
 }
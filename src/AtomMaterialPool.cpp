@@ -1,7 +1,5 @@
 #include "AtomMaterialPool.h"
-#include "material/PhongMaterial.h"
-#include "material/GouraudMaterial.h"
-#include "material/TessMaterial.h"
+#include "material/InstancedMaterial.h"
 #include <fstream>
 #include <cstdio>
 #include <iostream>
@@ -10,24 +8,42 @@ using namespace std;
 AtomMaterialPool* AtomMaterialPool::instance = NULL;
 
 AtomMaterialPool::AtomMaterialPool(){
+	this->instancedMaterials[SPHERE_INSTANCE] = NULL;
+	this->instancedMaterials[CYLINDER_INSTANCE] = NULL;
+	this->impostorMaterials[SPHERE_IMPOSTOR] = NULL;
+	this->impostorMaterials[CYLINDER_IMPOSTOR] = NULL;
+	//elements missing from the file are white
+	this->defaultRow = AtomMaterialPool::addRows(new Material());
 	fstream colorsFile;
 	colorsFile.open("colors.txt");
 	if(colorsFile.is_open()){
 		char element[4];
 		char hexColor[8];
-		while(!colorsFile.eof()){
-			colorsFile >> element >> hexColor;
-			Material* mat= new PhongMaterial();
+		while(colorsFile >> element >> hexColor){
+			Material* mat= new Material();
 			float color[3];
 			AtomMaterialPool::RGBfromHexString(color,hexColor);
 			mat->getDiffuseColor()->setRGB(color[0],color[1],color[2]);
-			mat->setShininess(100);
 			string str(element);
 			this->pool[str] = mat;
+			this->rows[str] = AtomMaterialPool::addRows(mat);
 		}
 	}
 }
 
+//atoms and bonds share the color, bonds keep the tighter highlight of the
+//old bond material
+int AtomMaterialPool::addRows(Material* material){
+	material->setShininess(100);
+	Material* bondMaterial = new Material();
+	bondMaterial->setDiffuseColor(material->getDiffuseColor());
+	bondMaterial->setShininess(1000);
+	MaterialTable* table = MaterialTable::getInstance();
+	int row = table->addMaterial(material);
+	table->addMaterial(bondMaterial);
+	return row;
+}
+
 AtomMaterialPool* AtomMaterialPool::getInstance(){
 	if (AtomMaterialPool::instance == NULL){
 		instance = new AtomMaterialPool();
@@ -47,3 +63,29 @@ Material* AtomMaterialPool::getAtomMaterial(char* element){
 	string str(element);
 	return pool[str];
 }
+
+//material table row atoms of the element point at
+int AtomMaterialPool::getAtomMaterialRow(const char* element){
+	map<string,int>::iterator it = this->rows.find(string(element));
+	return it != this->rows.end() ? it->second : this->defaultRow;
+}
+
+int AtomMaterialPool::getBondMaterialRow(const char* element){
+	return this->getAtomMaterialRow(element) + 1;
+}
+
+//shared by every molecule so all atoms end up in the same instanced batch,
+//each instance points at the row of its element
+Material* AtomMaterialPool::getInstancedMaterial(InstanceType instanceType){
+	if(this->instancedMaterials[instanceType] == NULL){
+		this->instancedMaterials[instanceType] = new InstancedMaterial(instanceType);
+	}
+	return this->instancedMaterials[instanceType];
+}
+
+Material* AtomMaterialPool::getImpostorMaterial(ImpostorShape shape){
+	if(this->impostorMaterials[shape] == NULL){
+		this->impostorMaterials[shape] = new ImpostorMaterial(shape);
+	}
+	return this->impostorMaterials[shape];
+}
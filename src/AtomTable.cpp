@@ -0,0 +1,126 @@
+#include "AtomTable.h"
+#include <cstring>
+
+AtomTable::AtomTable(){
+}
+
+void AtomTable::reserve(int numAtoms){
+	this->positions.reserve(numAtoms * 3);
+	this->elements.reserve(numAtoms);
+	this->radii.reserve(numAtoms);
+	this->colors.reserve(numAtoms);
+	this->residues.reserve(numAtoms);
+	this->chains.reserve(numAtoms);
+	this->flags.reserve(numAtoms);
+}
+
+unsigned char AtomTable::getElementId(const char* symbol){
+	string str(symbol);
+	map<string,unsigned char>::iterator it = this->elementIds.find(str);
+	if(it != this->elementIds.end()) return it->second;
+	unsigned char id = this->elementSymbols.size();
+	this->elementSymbols.push_back(str);
+	this->elementIds[str] = id;
+	return id;
+}
+
+int AtomTable::addAtom(const char* symbol, float x, float y, float z, float radius, unsigned int color, int residue, char chain, unsigned char flags){
+	int index = this->elements.size();
+	this->positions.push_back(x);
+	this->positions.push_back(y);
+	this->positions.push_back(z);
+	this->elements.push_back(this->getElementId(symbol));
+	this->radii.push_back(radius);
+	this->colors.push_back(color);
+	this->residues.push_back(residue);
+	this->chains.push_back(chain);
+	if(!strcmp(symbol,"H")) flags |= ATOM_HYDROGEN;
+	this->flags.push_back(flags);
+	return index;
+}
+
+int AtomTable::getNumAtoms(){
+	return this->elements.size();
+}
+
+float* AtomTable::getPositions(){
+	return this->positions.empty() ? NULL : &(this->positions[0]);
+}
+
+float* AtomTable::getPosition(int index){
+	return &(this->positions[index*3]);
+}
+
+unsigned char AtomTable::getElement(int index){
+	return this->elements[index];
+}
+
+const char* AtomTable::getSymbol(int index){
+	return this->elementSymbols[this->elements[index]].c_str();
+}
+
+const char* AtomTable::getElementSymbol(unsigned char element){
+	return this->elementSymbols[element].c_str();
+}
+
+int AtomTable::getNumElements(){
+	return this->elementSymbols.size();
+}
+
+float* AtomTable::getRadii(){
+	return this->radii.empty() ? NULL : &(this->radii[0]);
+}
+
+float AtomTable::getRadius(int index){
+	return this->radii[index];
+}
+
+unsigned int* AtomTable::getColors(){
+	return this->colors.empty() ? NULL : &(this->colors[0]);
+}
+
+unsigned int AtomTable::getColor(int index){
+	return this->colors[index];
+}
+
+int AtomTable::getResidue(int index){
+	return this->residues[index];
+}
+
+char AtomTable::getChain(int index){
+	return this->chains[index];
+}
+
+unsigned char AtomTable::getFlags(int index){
+	return this->flags[index];
+}
+
+void AtomTable::setFlags(int index, unsigned char flags){
+	this->flags[index] = flags;
+}
+
+bool AtomTable::isHydrogen(int index){
+	return this->flags[index] & ATOM_HYDROGEN;
+}
+
+size_t AtomTable::getMemoryUsage(){
+	return this->positions.capacity() * sizeof(float) +
+	       this->elements.capacity() +
+	       this->radii.capacity() * sizeof(float) +
+	       this->colors.capacity() * sizeof(unsigned int) +
+	       this->residues.capacity() * sizeof(int) +
+	       this->chains.capacity() +
+	       this->flags.capacity();
+}
+
+//RGBA8 in memory order, so it can be fed to GL as normalized unsigned bytes
+unsigned int AtomTable::packColor(float r, float g, float b, float a){
+	unsigned char rgba[4];
+	rgba[0] = (unsigned char)(r * 255.0 + 0.5);
+	rgba[1] = (unsigned char)(g * 255.0 + 0.5);
+	rgba[2] = (unsigned char)(b * 255.0 + 0.5);
+	rgba[3] = (unsigned char)(a * 255.0 + 0.5);
+	unsigned int color;
+	memcpy(&color,rgba,sizeof(color));
+	return color;
+}
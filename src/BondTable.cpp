@@ -0,0 +1,108 @@
+#include "BondTable.h"
+#include <algorithm>
+
+BondTable::BondTable(int numAtoms){
+	this->numAtoms = numAtoms;
+	this->built = false;
+	this->offsets.assign(numAtoms + 1,0);
+}
+
+bool BondTable::compareBonds(const struct bond& b1, const struct bond& b2){
+	if(b1.atom1 != b2.atom1) return b1.atom1 < b2.atom1;
+	return b1.atom2 < b2.atom2;
+}
+
+void BondTable::addBond(int atom1, int atom2, int order){
+	if(atom1 == atom2 || atom1 < 0 || atom2 < 0 ||
+	   atom1 >= this->numAtoms || atom2 >= this->numAtoms) return;
+	struct bond b;
+	b.atom1 = min(atom1,atom2);
+	b.atom2 = max(atom1,atom2);
+	b.order = order;
+	this->bonds.push_back(b);
+	this->built = false;
+}
+
+void BondTable::build(){
+	//sort the edge list and merge repeated pairs adding up their order
+	sort(this->bonds.begin(),this->bonds.end(),BondTable::compareBonds);
+	int numBonds = 0;
+	int size = this->bonds.size();
+	for(int i = 0; i < size; i++){
+		if(numBonds > 0 &&
+		   this->bonds[numBonds-1].atom1 == this->bonds[i].atom1 &&
+		   this->bonds[numBonds-1].atom2 == this->bonds[i].atom2){
+			this->bonds[numBonds-1].order += this->bonds[i].order;
+		}
+		else{
+			this->bonds[numBonds++] = this->bonds[i];
+		}
+	}
+	this->bonds.resize(numBonds);
+
+	//adjacency in both directions, neighbors of an atom are contiguous
+	this->offsets.assign(this->numAtoms + 1,0);
+	for(int i = 0; i < numBonds; i++){
+		this->offsets[this->bonds[i].atom1 + 1]++;
+		this->offsets[this->bonds[i].atom2 + 1]++;
+	}
+	for(int i = 0; i < this->numAtoms; i++){
+		this->offsets[i + 1] += this->offsets[i];
+	}
+	this->neighbors.resize(numBonds * 2);
+	this->neighborBonds.resize(numBonds * 2);
+	vector<int> fill(this->offsets.begin(),this->offsets.end() - 1);
+	for(int i = 0; i < numBonds; i++){
+		int slot = fill[this->bonds[i].atom1]++;
+		this->neighbors[slot] = this->bonds[i].atom2;
+		this->neighborBonds[slot] = i;
+		slot = fill[this->bonds[i].atom2]++;
+		this->neighbors[slot] = this->bonds[i].atom1;
+		this->neighborBonds[slot] = i;
+	}
+	this->built = true;
+}
+
+int BondTable::getNumAtoms(){
+	return this->numAtoms;
+}
+
+int BondTable::getNumBonds(){
+	if(!this->built) this->build();
+	return this->bonds.size();
+}
+
+Bond BondTable::getBond(int index){
+	if(!this->built) this->build();
+	return &(this->bonds[index]);
+}
+
+int BondTable::getNumNeighbors(int atom){
+	if(!this->built) this->build();
+	return this->offsets[atom + 1] - this->offsets[atom];
+}
+
+const int* BondTable::getNeighbors(int atom){
+	if(!this->built) this->build();
+	return this->neighbors.empty() ? NULL : &(this->neighbors[this->offsets[atom]]);
+}
+
+const int* BondTable::getNeighborBonds(int atom){
+	if(!this->built) this->build();
+	return this->neighborBonds.empty() ? NULL : &(this->neighborBonds[this->offsets[atom]]);
+}
+
+int BondTable::getBondOrder(int atom1, int atom2){
+	int numNeighbors = this->getNumNeighbors(atom1);
+	const int* atomNeighbors = this->getNeighbors(atom1);
+	const int* atomBonds = this->getNeighborBonds(atom1);
+	for(int i = 0; i < numNeighbors; i++){
+		if(atomNeighbors[i] == atom2) return this->bonds[atomBonds[i]].order;
+	}
+	return 0;
+}
+
+size_t BondTable::getMemoryUsage(){
+	return this->bonds.capacity() * sizeof(struct bond) +
+	       (this->offsets.capacity() + this->neighbors.capacity() + this->neighborBonds.capacity()) * sizeof(int);
+}
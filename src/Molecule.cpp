@@ -1,33 +1,39 @@
 #include "Molecule.h"
 #include "AtomMaterialPool.h"
 #include "AtomRadiusTable.h"
+#include "PDBReader.h"
+#include "scene/NeighborGrid.h"
 #include "object/Mesh.h"
+#include "object/GeometryRegistry.h"
 #include "material/PhongMaterial.h"
 #include "material/GouraudMaterial.h"
 #include "material/TessMaterial.h"
-#include <fstream>
 #include <iostream>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
-#include <cctype>
 #include <cstdio>
+#include <cmath>
 using namespace std;
 
-char* Molecule::substr(const char* source, int i, int n){
-	char* substr = new char[n+1];
-	int len = strlen(source);
-	if(i > len) i= 0;
-	strncpy(substr,source + i,n);
-	substr[n]='\0';
-	return substr;
-}
-
 Molecule::Molecule(const char* filename):Object3D(){
 	this->numAtoms =0;
 	this->x=0;
 	this->y=0;
 	this->z=0;
-	this->connections = NULL;
+	this->atomTable = NULL;
+	this->bondTable = NULL;
+	this->atoms = NULL;
+	this->spacefill = NULL;
+	this->atomGeometry = NULL;
+	this->bondGeometry = NULL;
+	this->bonds = NULL;
+	this->sphereImpostorGeometry = NULL;
+	this->cylinderImpostorGeometry = NULL;
+	this->impostors = false;
+	this->spacefillMode = false;
+	this->bvh = NULL;
+	this->bvhSpacefill = false;
 	this->readPDB(filename);
 }
 
@@ -36,292 +42,298 @@ Molecule::Molecule(const Molecule& molecule):Object3D(){
 	this->x = molecule.x;
 	this->y = molecule.y;
 	this->z = molecule.z;
-	this->connections = molecule.connections;
-	int atomsSize = molecule.atoms.size();
-	for(int i =0; i < atomsSize; i++){
-		Atom* newAtom = new Atom(*(molecule.atoms[i]));
-		Atom* newSpacefill = new Atom(*(molecule.spacefill[i]));
-		this->atoms.push_back(newAtom);
-		this->spacefill.push_back(newSpacefill);
-	}
-	int bondsSize = molecule.bonds.size();
-	for(int i =0; i < bondsSize; i++){
-		Mesh* newMesh = new Mesh(*(molecule.bonds[i]));
-		this->bonds.push_back(newMesh);
+	this->atomTable = molecule.atomTable != NULL ? new AtomTable(*(molecule.atomTable)) : NULL;
+	this->bondTable = molecule.bondTable != NULL ? new BondTable(*(molecule.bondTable)) : NULL;
+	//geometry and materials are shared between copies
+	this->atomGeometry = molecule.atomGeometry;
+	this->bondGeometry = molecule.bondGeometry;
+	this->sphereImpostorGeometry = molecule.sphereImpostorGeometry;
+	this->cylinderImpostorGeometry = molecule.cylinderImpostorGeometry;
+	Geometry* geometries[4] = {this->atomGeometry,this->bondGeometry,this->sphereImpostorGeometry,this->cylinderImpostorGeometry};
+	for(int i = 0; i < 4; i++){
+		if(geometries[i] != NULL) geometries[i]->retain();
 	}
+	this->impostors = molecule.impostors;
+	this->spacefillMode = molecule.spacefillMode;
+	this->atoms = molecule.atoms != NULL ? new InstancedMesh(*(molecule.atoms)) : NULL;
+	this->spacefill = molecule.spacefill != NULL ? new InstancedMesh(*(molecule.spacefill)) : NULL;
+	this->bonds = molecule.bonds != NULL ? new InstancedMesh(*(molecule.bonds)) : NULL;
+	//each copy builds its own when it is first picked
+	this->bvh = NULL;
+	this->bvhSpacefill = false;
 }
 
 Molecule::~Molecule(){
-	if(this->connections != NULL){
-		for(int i =0; i < this->numAtoms; i++){
-			delete (this->connections[i]);
-		}
-		delete this->connections;
+	if(this->atomTable != NULL){
+		delete this->atomTable;
 	}
-}
-
-void Molecule::initConnectionMatrix(int numAtoms,char value){
-  if (connections != NULL){
-		for(int i=0; i < numAtoms; i++){
-			delete (this->connections[i]);
-		}
+	if(this->bondTable != NULL){
+		delete this->bondTable;
 	}
-	this->connections = new char*[numAtoms];
-	for(int i = 0; i < this->numAtoms;i++){
-		this->connections[i] = new char[this->numAtoms];
+	if(this->bvh != NULL){
+		delete this->bvh;
 	}
-	for(int i=0;i<numAtoms;i++){
-		for(int j=0; j<numAtoms;j++){
-			this->connections[i][j] = value;
-		}
+	Geometry* geometries[4] = {this->atomGeometry,this->bondGeometry,this->sphereImpostorGeometry,this->cylinderImpostorGeometry};
+	for(int i = 0; i < 4; i++){
+		if(geometries[i] != NULL) geometries[i]->release();
 	}
 }
 
+//molecules keep a reference to the geometries they switch their meshes
+//between, so switching never deletes the one left unused
+static void holdGeometry(Geometry** held, Geometry* geometry){
+	geometry->retain();
+	if(*held != NULL) (*held)->release();
+	*held = geometry;
+}
+
 void Molecule::readPDB(const char* filename){
-	ifstream pdbFile;
-	char line [90];
+	PDBReader reader;
 	int num = this->numAtoms;
-	pdbFile.open(filename);
-	if (pdbFile.is_open()){
-		int endAtoms = false;
+	if (reader.read(filename)){
 		this->numAtoms =0;
 		AtomMaterialPool* matPool = AtomMaterialPool::getInstance();
 		AtomRadiusTable* radiusTable = AtomRadiusTable::getInstance();
-		Geometry* atomGeometry = new Geometry();
-	    atomGeometry->loadDataFromFile("highres-icosphere.mesh");
-	    while (!pdbFile.eof()){
-	      pdbFile.getline(line,81);
-	      if(strlen(line) == 80){
-	      	char* recordName = substr(line,0,6);
-	      	if(!strcmp(recordName,"ENDMDL")) break;
-	      	if(!strcmp(recordName,"ATOM  ") || !strcmp(recordName,"HETATM")){
-	      		char* element;
-	      		if (isspace(line[76]) && isspace(line[77])){
-	      			element = isspace(line[12]) || isdigit(line[12])? substr(line,13,1): substr(line,12,2);
-	      		}
-	      		else{
-	      			element = isspace(line[76])? substr(line,77,1) : substr(line,76,2);
-	      		}
-	      		//create material for both representations
-	      		Material* atomMaterial = matPool->getAtomMaterial(element);
-	      		if(!atomMaterial){
-	      			atomMaterial = new PhongMaterial();
-	      		}
-	      		//create mesh for ball & stick
-	      		Mesh* atomMesh = new Mesh(atomGeometry,atomMaterial);
-	      		//create mesh for spacefill
-	      		Mesh* spacefillMesh = new Mesh(atomGeometry,atomMaterial);
-	      		//spacefill is initially invisible
-	      		spacefillMesh->setVisible(false);
-	      		//get 3D position
-	      		char* x = substr(line,30,8);
-	      		char* y = substr(line,38,8);
-	      		char* z = substr(line,46,8);
-	      		//set position for ball & stick
-	      		atomMesh->getPosition()->setX(atof(x));
-	      		atomMesh->getPosition()->setY(atof(y));
-	      		atomMesh->getPosition()->setZ(atof(z));
-	      		//set position for spacefill
-	      		spacefillMesh->getPosition()->setX(atof(x));
-	      		spacefillMesh->getPosition()->setY(atof(y));
-	      		spacefillMesh->getPosition()->setZ(atof(z));
-	      		//retrieve spacefill radius
-	      		float radius = radiusTable->getRadius(element);
-	      		//ball & stick has constant size 0.5A
-	      		atomMesh->getScale()->setX(0.5);
-	      		atomMesh->getScale()->setY(0.5);
-	      		atomMesh->getScale()->setZ(0.5);
-	      		//set spacefill radius
-	      		spacefillMesh->getScale()->setX(radius);
-	      		spacefillMesh->getScale()->setY(radius);
-	      		spacefillMesh->getScale()->setZ(radius);
-	      		
-	      		delete y;
-	      		delete x;
-	      		delete z;
-	      		// create both atom objects
-	      		Atom* atom = new Atom(element,atomMesh);
-	      		Atom* spacefillAtom = new Atom(element,spacefillMesh);
-	      		delete element;
-	      		//push atoms to lists
-	      		this->atoms.push_back(atom);
-	      		this->spacefill.push_back(spacefillAtom);
-	      		//calculate atom center
-	      		this->x += atom->getMesh()->getPosition()->getX();
-	      		this->y += atom->getMesh()->getPosition()->getY();
-	      		this->z += atom->getMesh()->getPosition()->getZ();
-	      		(this->numAtoms)++;
-	      	}
-	      	else{
-	      		if(!strcmp(recordName,"CONECT")){
-	      			if(!endAtoms){
-	      				this->initConnectionMatrix(this->numAtoms,0);
-	      				endAtoms = true;
-	      			}
-	      			char* atomSerialNo = substr(line,6,5);
-	      			int atom = atoi(atomSerialNo);
-	      			//printf("%d",atom );
-	      			delete atomSerialNo;
-	      			for(int i =0; i< 4; i++){
-	      				char* bondedAtom = substr(line,11+(5*i),5);
-	      				int bonded = atoi(bondedAtom);
-	      				//printf("\t%d",bonded );
-	      				if(bonded){
-	      					this->connections[atom][bonded] += 1;
-	      				}
-	      				delete bondedAtom;
-	      			}
-	      			//printf("\n");
-	      		}
-	      	}
-	      	delete recordName;
-	      }
+	    PDBAtom pdbAtoms = reader.getAtoms();
+	    int numPdbAtoms = reader.getNumAtoms();
+	    if(this->atomTable != NULL) delete this->atomTable;
+	    this->atomTable = new AtomTable();
+	    this->atomTable->reserve(numPdbAtoms);
+	    //serial numbers are not contiguous (TER records use one), map them to atom indices
+	    int maxSerial = 0;
+	    for(int i = 0; i < numPdbAtoms; i++){
+	    	maxSerial = max(maxSerial,pdbAtoms[i].serial);
+	    }
+	    vector<int> serialIndex(maxSerial + 1,-1);
+	    for(int i = 0; i < numPdbAtoms; i++){
+	    	PDBAtom pdbAtom = &(pdbAtoms[i]);
+	    	if(pdbAtom->serial >= 0) serialIndex[pdbAtom->serial] = i;
+	    	char* element = pdbAtom->element;
+	    	//the table keeps the element color, the material is looked up again per element
+	    	Material* atomMaterial = matPool->getAtomMaterial(element);
+	    	unsigned int color = AtomTable::packColor(1.0,1.0,1.0);
+	    	if(atomMaterial){
+	    		Color* diffuse = atomMaterial->getDiffuseColor();
+	    		color = AtomTable::packColor(diffuse->getComponent('r'),diffuse->getComponent('g'),diffuse->getComponent('b'));
+	    	}
+	    	this->atomTable->addAtom(element,pdbAtom->x,pdbAtom->y,pdbAtom->z,
+	    	                         radiusTable->getRadius(element),color,
+	    	                         pdbAtom->residue,pdbAtom->chain,
+	    	                         pdbAtom->hetatm ? ATOM_HETATM : 0);
+	    	//calculate atom center
+	    	this->x += pdbAtom->x;
+	    	this->y += pdbAtom->y;
+	    	this->z += pdbAtom->z;
+	    	(this->numAtoms)++;
 	    }
-	    if(!endAtoms){
-	      	this->initConnectionMatrix(this->numAtoms,0);
-	      	endAtoms = true;
+	    if(this->bondTable != NULL) delete this->bondTable;
+	    this->bondTable = new BondTable(this->numAtoms);
+	    //CONECT bonds add to the order of the perceived ones, each pair is
+	    //counted from its lower serial only as records list both directions
+	    PDBConect conects = reader.getConects();
+	    int numConects = reader.getNumConects();
+	    for(int i = 0; i < numConects; i++){
+	    	int serial = conects[i].serial;
+	    	if(serial <= 0 || serial > maxSerial || serialIndex[serial] < 0) continue;
+	    	int atom = serialIndex[serial];
+	    	for(int j = 0; j < 4; j++){
+	    		int bonded = conects[i].bonded[j];
+	    		if(bonded <= 0 || bonded > maxSerial || serialIndex[bonded] < 0) continue;
+	    		if(atom < serialIndex[bonded]) this->bondTable->addBond(atom,serialIndex[bonded]);
+	    	}
 	    }
-	    pdbFile.close();
 	    this->x /= this->numAtoms;
 	    this->y /= this->numAtoms;
 	    this->z /= this->numAtoms;
+	    this->createAtomMeshes();
 	    this->calculateConnections(num);
+	    if(this->bvh != NULL){
+	    	delete this->bvh;
+	    	this->bvh = NULL;
+	    }
   	}
 }
 
-Mesh* Molecule::createBond(Atom* a1, Atom* a2,int numLinks){
-	Mesh* mesh = new Mesh();
-	Vec3* upVec = new Vec3();
-	upVec->setX(0.0);
-	upVec->setZ(1.0);
-	upVec->setY(0.0);
-	Vec3* destVec = new Vec3();
-	destVec->setX(a2->getMesh()->getPosition()->getX()- a1->getMesh()->getPosition()->getX());
-	destVec->setY(a2->getMesh()->getPosition()->getY()- a1->getMesh()->getPosition()->getY());
-	destVec->setZ(a2->getMesh()->getPosition()->getZ()- a1->getMesh()->getPosition()->getZ());
-	float length = destVec->length();
-	destVec->normalize();
-	Quaternion* quat = Quaternion::rotationBetweenVectors(upVec, destVec);
-	delete upVec;
-	delete destVec;
-	Vec3* position = Molecule::getBondPos(a1->getMesh()->getPosition(),a2->getMesh()->getPosition());
-
-	mesh->getScale()->setX(0.6);
-	mesh->getScale()->setY(0.6);
-	mesh->getScale()->setZ(0.2 * length);
-	Vec3* oldPos= mesh->getPosition();
-	mesh->setPosition(position);
-	delete oldPos;
-	Quaternion* oldQuat = mesh->getQuaternion();
-	mesh->setQuaternion(quat);
-	delete oldQuat;
-	return mesh;
-}
-
-Vec3* Molecule::getBondPos(Vec3* atomPos1, Vec3* atomPos2){
-	Vec3* pos = new Vec3();
-	pos->setX((atomPos1->getX()+ atomPos2->getX())/2.0);
-	pos->setY((atomPos1->getY()+ atomPos2->getY())/2.0);
-	pos->setZ((atomPos1->getZ()+ atomPos2->getZ())/2.0);
-	return pos;
+void Molecule::createAtomMeshes(){
+	AtomMaterialPool* matPool = AtomMaterialPool::getInstance();
+	Material* material = matPool->getInstancedMaterial(SPHERE_INSTANCE);
+	GeometryRegistry* registry = GeometryRegistry::getInstance();
+	holdGeometry(&(this->atomGeometry),registry->getGeometry(ATOM_GEOMETRY_FILE));
+	//impostors are bounded by a quad facing the camera, generated geometries
+	//are shared by name like the loaded ones
+	Geometry* sphereImpostorGeometry = registry->findGeometry(SPHERE_IMPOSTOR_GEOMETRY);
+	if(sphereImpostorGeometry == NULL){
+		sphereImpostorGeometry = registry->addGeometry(SPHERE_IMPOSTOR_GEOMETRY,Geometry::generateQuad(2.0));
+	}
+	holdGeometry(&(this->sphereImpostorGeometry),sphereImpostorGeometry);
+	this->atoms = new InstancedMesh(this->atomGeometry,material);
+	this->spacefill = new InstancedMesh(this->atomGeometry,material);
+	//spacefill is initially invisible
+	this->spacefill->setVisible(false);
+	this->atoms->reserve(this->numAtoms);
+	this->spacefill->reserve(this->numAtoms);
+	for(int i = 0; i < this->numAtoms; i++){
+		float* position = this->atomTable->getPosition(i);
+		int row = matPool->getAtomMaterialRow(this->atomTable->getSymbol(i));
+		//ball & stick has constant size 0.5A
+		this->atoms->addSphere(position[0],position[1],position[2],0.5,row);
+		this->spacefill->addSphere(position[0],position[1],position[2],this->atomTable->getRadius(i),row);
+	}
 }
 
 void Molecule::calculateConnections(int num){
-	Geometry* geom = new Geometry();
-	geom->loadDataFromFile("cylinder.mesh");
-	Material* mat = new PhongMaterial();
-	mat->getDiffuseColor()->setRGB(0.5,0.5,0.5);
-	mat->setShininess(1000); 
-
-	for(int i = 0; i < this->numAtoms; i++){
-		for(int j=i+1; j< this->numAtoms;j++){
-			if( Molecule::atomsConnected(this->atoms[i],this->atoms[j]) ){
-				this->connections[i][j] += 1;
+	//bond perception, atoms are only compared against neighbors within the largest cutoff
+	if(this->numAtoms > 0){
+		float* positions = this->atomTable->getPositions();
+		NeighborGrid grid(MAX_BOND_DISTANCE);
+		grid.build(positions,this->numAtoms);
+		vector<int> neighbors;
+		for(int i = 0; i < this->numAtoms; i++){
+			neighbors.clear();
+			grid.query(positions[i*3],positions[i*3+1],positions[i*3+2],MAX_BOND_DISTANCE,&neighbors);
+			bool hydrogen = this->atomTable->isHydrogen(i);
+			int numNeighbors = neighbors.size();
+			for(int k = 0; k < numNeighbors; k++){
+				int j = neighbors[k];
+				if(j <= i) continue;
+				float dx = positions[j*3] - positions[i*3];
+				float dy = positions[j*3+1] - positions[i*3+1];
+				float dz = positions[j*3+2] - positions[i*3+2];
+				float distance = sqrt(dx*dx + dy*dy + dz*dz);
+				if( Molecule::atomsConnected(distance,hydrogen || this->atomTable->isHydrogen(j)) ){
+					this->bondTable->addBond(i,j);
+				}
 			}
 		}
 	}
-	for(int i = 0; i < this->numAtoms; i++){
-		for(int j=i+1; j< this->numAtoms;j++){
-			if( this->connections[i][j] > 0){
-				for(int k=0; k < this->connections[i][j] ; k++){
-					Mesh * bond = createBond(this->atoms[i],this->atoms[j],this->connections[i][j]);
-					bond->getScale()->setX(bond->getScale()->getX()/this->connections[i][j]);
-					bond->getScale()->setY(bond->getScale()->getY()/this->connections[i][j]);
-					bond->setGeometry(geom);
-					bond->setMaterial(mat);
-					this->bonds.push_back(bond);
-					if((this->connections[i][j] > 1) && k==0) bond->getPosition()->setY(bond->getPosition()->getY()+(this->connections[i][j]/15.0));
-					if((this->connections[i][j] > 1) && k==1) bond->getPosition()->setY(bond->getPosition()->getY()-(this->connections[i][j]/15.0));
-				}
-				
-			}
+	this->bondTable->build();
+	this->createBondMeshes();
+}
+
+//unit vector perpendicular to the bond used to lay out multiple bonds,
+//kept in the plane of a neighboring atom so ring bonds stay in the ring
+void Molecule::bondNormal(int atom1, int atom2, float* normal){
+	float* p1 = this->atomTable->getPosition(atom1);
+	float* p2 = this->atomTable->getPosition(atom2);
+	float axis[3] = {p2[0]-p1[0],p2[1]-p1[1],p2[2]-p1[2]};
+	float length = sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+	for(int c = 0; c < 3; c++) axis[c] /= length;
+	float reference[3] = {0.0,0.0,0.0};
+	int ends[2] = {atom1,atom2};
+	for(int e = 0; e < 2 && reference[0] == 0.0 && reference[1] == 0.0 && reference[2] == 0.0; e++){
+		int numNeighbors = this->bondTable->getNumNeighbors(ends[e]);
+		const int* neighbors = this->bondTable->getNeighbors(ends[e]);
+		for(int n = 0; n < numNeighbors; n++){
+			if(neighbors[n] == atom1 || neighbors[n] == atom2) continue;
+			float* p = this->atomTable->getPosition(neighbors[n]);
+			for(int c = 0; c < 3; c++) reference[c] = p[c] - p1[c];
+			break;
 		}
 	}
+	//no neighbor or a collinear one, any perpendicular will do
+	float along = reference[0]*axis[0] + reference[1]*axis[1] + reference[2]*axis[2];
+	for(int c = 0; c < 3; c++) normal[c] = reference[c] - along * axis[c];
+	float normalLength = sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+	if(normalLength < 0.001){
+		float up[3] = {0.0,0.0,0.0};
+		up[fabs(axis[0]) < 0.9 ? 0 : 1] = 1.0;
+		normal[0] = axis[1]*up[2] - axis[2]*up[1];
+		normal[1] = axis[2]*up[0] - axis[0]*up[2];
+		normal[2] = axis[0]*up[1] - axis[1]*up[0];
+		normalLength = sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+	}
+	for(int c = 0; c < 3; c++) normal[c] /= normalLength;
+}
+
+//one cylinder instance per bond and order, both representations draw from it
+void Molecule::createBondMeshes(){
+	AtomMaterialPool* matPool = AtomMaterialPool::getInstance();
+	GeometryRegistry* registry = GeometryRegistry::getInstance();
+	Geometry* bondGeometry = registry->findGeometry(BOND_GEOMETRY);
+	if(bondGeometry == NULL){
+		bondGeometry = registry->addGeometry(BOND_GEOMETRY,Geometry::generateCylinder(BOND_SEGMENTS));
+	}
+	holdGeometry(&(this->bondGeometry),bondGeometry);
+	Geometry* cylinderImpostorGeometry = registry->findGeometry(CYLINDER_IMPOSTOR_GEOMETRY);
+	if(cylinderImpostorGeometry == NULL){
+		cylinderImpostorGeometry = registry->addGeometry(CYLINDER_IMPOSTOR_GEOMETRY,Geometry::generateCubeGeometry(2.0));
+	}
+	holdGeometry(&(this->cylinderImpostorGeometry),cylinderImpostorGeometry);
+	this->bonds = new InstancedMesh(this->bondGeometry,matPool->getInstancedMaterial(CYLINDER_INSTANCE),CYLINDER_INSTANCE);
+	int numBonds = this->bondTable->getNumBonds();
+	this->bonds->reserve(numBonds);
+	for(int b = 0; b < numBonds; b++){
+		Bond bondData = this->bondTable->getBond(b);
+		int i = bondData->atom1;
+		int j = bondData->atom2;
+		int order = bondData->order;
+		float* p1 = this->atomTable->getPosition(i);
+		float* p2 = this->atomTable->getPosition(j);
+		int row1 = matPool->getBondMaterialRow(this->atomTable->getSymbol(i));
+		int row2 = matPool->getBondMaterialRow(this->atomTable->getSymbol(j));
+		float normal[3] = {0.0,0.0,0.0};
+		if(order > 1) this->bondNormal(i,j,normal);
+		for(int k=0; k < order ; k++){
+			//centered around the bond axis, BOND_SPACING apart
+			float shift = (k - (order - 1) / 2.0) * BOND_SPACING;
+			float offset[3] = {normal[0]*shift,normal[1]*shift,normal[2]*shift};
+			this->bonds->addCylinder(p1,p2,offset,BOND_RADIUS/order,row1,row2);
+		}
+	}
+}
+
+AtomTable* Molecule::getAtomTable(){
+	return this->atomTable;
 }
 
-vector<Atom*> Molecule::getAtoms(){
+Atom Molecule::getAtom(int index){
+	return Atom(this->atomTable,index);
+}
+
+InstancedMesh* Molecule::getAtoms(){
 	return this->atoms;
 }
 
-vector<Atom*> Molecule::getSpacefill(){
+InstancedMesh* Molecule::getSpacefill(){
 	return this->spacefill;
 }
 
-vector<Mesh*> Molecule::getBonds(){
+InstancedMesh* Molecule::getBonds(){
 	return this->bonds;
 }
 
-char** Molecule::getConnections(){
-	return this->connections;
+BondTable* Molecule::getConnections(){
+	return this->bondTable;
 }
 
 int Molecule::getNumAtoms(){
 	return this->numAtoms;
 }
 
-bool Molecule::atomsConnected(Atom* a1, Atom* a2){
-	float distance = a1->getMesh()->getPosition()->distance(a2->getMesh()->getPosition());
-	if(strcmp(a1->getSymbol(),"H") && strcmp(a2->getSymbol(),"H")){
-		if(distance >= 0.4 && distance <= 1.9) return true;
+bool Molecule::atomsConnected(Atom a1, Atom a2){
+	return Molecule::atomsConnected(a1.distance(a2),a1.isHydrogen() || a2.isHydrogen());
+}
+
+bool Molecule::atomsConnected(float distance, bool hydrogen){
+	if(!hydrogen){
+		if(distance >= MIN_BOND_DISTANCE && distance <= MAX_BOND_DISTANCE) return true;
 	}
 	else{
-		if(distance >= 0.4 && distance <= 1.2) return true;
+		if(distance >= MIN_BOND_DISTANCE && distance <= MAX_H_BOND_DISTANCE) return true;
 	}
 	return false;
 }
 
 void Molecule::addToScene(Scene* scene){
-	for (int i =0; i < this->numAtoms;i++){
-		scene->addObject((Object3D*)(this->atoms[i]->getMesh()));
-		this->objects.push_back((Object3D*)(this->atoms[i]->getMesh()));
-		this->atoms[i]->getMesh()->setParent(this);
-	}
-	int numBonds = this->bonds.size();
-	for (int i=0; i < numBonds;i++){
-		scene->addObject((Object3D*)(this->bonds[i]));
-		this->bonds[i]->setParent(this);
-		this->objects.push_back((Object3D*)(this->bonds[i]));
-	}
-	for (int i =0; i < this->numAtoms;i++){
-		scene->addObject((Object3D*)(this->spacefill[i]->getMesh()));
-		this->spacefill[i]->getMesh()->setParent(this);
-		this->objects.push_back((Object3D*)(this->spacefill[i]->getMesh()));
-	}
-	/*for (int i =0; i < this->numAtoms;i++){
-		this->objects.push_back((Object3D*)(this->atoms[i]->getMesh()));
-		this->atoms[i]->getMesh()->setParent(this);
-	}
-	int numBonds = this->bonds.size();
-	for (int i=0; i < numBonds;i++){
-		this->bonds[i]->setParent(this);
-		this->objects.push_back((Object3D*)(this->bonds[i]));
-	}
-	for (int i =0; i < this->numAtoms;i++){
-		this->spacefill[i]->getMesh()->setParent(this);
-		this->objects.push_back((Object3D*)(this->spacefill[i]->getMesh()));
-	}
-	scene->addObject((Object3D*)this);
-	*/
+	scene->addObject((Object3D*)(this->atoms));
+	this->objects.push_back((Object3D*)(this->atoms));
+	this->atoms->setParent(this);
+	scene->addObject((Object3D*)(this->bonds));
+	this->bonds->setParent(this);
+	this->objects.push_back((Object3D*)(this->bonds));
+	scene->addObject((Object3D*)(this->spacefill));
+	this->spacefill->setParent(this);
+	this->objects.push_back((Object3D*)(this->spacefill));
 }
 
 float Molecule::getX(){
@@ -336,14 +348,113 @@ float Molecule::getZ(){
 	return this->z;
 }
 
+void Molecule::updateVisibility(){
+	this->spacefill->setVisible(this->spacefillMode);
+	this->atoms->setVisible(!this->spacefillMode);
+	this->bonds->setVisible(!this->spacefillMode);
+}
+
 void Molecule::toggleSpaceFill(){
-	for(int i=0; i< this->numAtoms;i++){
-		this->spacefill[i]->getMesh()->setVisible(!this->spacefill[i]->getMesh()->getVisible());
-		this->atoms[i]->getMesh()->setVisible(!this->atoms[i]->getMesh()->getVisible());
+	this->spacefillMode = !this->spacefillMode;
+	this->updateVisibility();
+}
+
+bool Molecule::getImpostors(){
+	return this->impostors;
+}
+
+//atoms and bonds keep their instances, only the geometry and shading change
+void Molecule::setImpostors(bool impostors){
+	this->impostors = impostors;
+	AtomMaterialPool* matPool = AtomMaterialPool::getInstance();
+	Geometry* geometry = impostors ? this->sphereImpostorGeometry : this->atomGeometry;
+	Material* material = impostors ? matPool->getImpostorMaterial(SPHERE_IMPOSTOR) : matPool->getInstancedMaterial(SPHERE_INSTANCE);
+	this->atoms->setGeometry(geometry);
+	this->atoms->setMaterial(material);
+	this->spacefill->setGeometry(geometry);
+	this->spacefill->setMaterial(material);
+	if(impostors){
+		this->bonds->setGeometry(this->cylinderImpostorGeometry);
+		this->bonds->setMaterial(matPool->getImpostorMaterial(CYLINDER_IMPOSTOR));
 	}
-	int numBonds = this->bonds.size();
-	for(int i=0; i<numBonds; i++){
-		this->bonds[i]->setVisible(!this->bonds[i]->getVisible());
+	else{
+		this->bonds->setGeometry(this->bondGeometry);
+		this->bonds->setMaterial(matPool->getInstancedMaterial(CYLINDER_INSTANCE));
 	}
+	this->updateVisibility();
 }
 
+
+bool Molecule::getSpacefillMode(){
+	return this->spacefillMode;
+}
+
+//spheres for the atoms as they are drawn, in ball & stick a capsule per bond
+//wide enough to hold all of its cylinders, indices are atom and bond indices
+void Molecule::buildBVH(){
+	if(this->bvh == NULL) this->bvh = new BVH();
+	this->bvhSpacefill = this->spacefillMode;
+	int numBonds = this->spacefillMode ? 0 : this->bondTable->getNumBonds();
+	vector<struct bvhPrimitive> primitives(this->numAtoms + numBonds);
+	for(int i = 0; i < this->numAtoms; i++){
+		struct bvhPrimitive* p = &(primitives[i]);
+		float* position = this->atomTable->getPosition(i);
+		for(int axis = 0; axis < 3; axis++){
+			p->start[axis] = position[axis];
+			p->end[axis] = position[axis];
+		}
+		p->radius = this->spacefillMode ? this->atomTable->getRadius(i) : 0.5;
+		p->type = SPHERE_PRIMITIVE;
+		p->index = i;
+	}
+	for(int b = 0; b < numBonds; b++){
+		struct bvhPrimitive* p = &(primitives[this->numAtoms + b]);
+		Bond bondData = this->bondTable->getBond(b);
+		float* p1 = this->atomTable->getPosition(bondData->atom1);
+		float* p2 = this->atomTable->getPosition(bondData->atom2);
+		for(int axis = 0; axis < 3; axis++){
+			p->start[axis] = p1[axis];
+			p->end[axis] = p2[axis];
+		}
+		p->radius = (bondData->order - 1) / 2.0 * BOND_SPACING + BOND_RADIUS / bondData->order;
+		p->type = CAPSULE_PRIMITIVE;
+		p->index = b;
+	}
+	this->bvh->build(primitives.empty() ? NULL : &(primitives[0]),primitives.size());
+}
+
+//rebuilt when the representation changed since the last build
+BVH* Molecule::getBVH(){
+	if(this->bvh == NULL || this->bvhSpacefill != this->spacefillMode){
+		this->buildBVH();
+	}
+	return this->bvh;
+}
+
+//world space ray, the tree is queried in local space and the distance is
+//scaled back by how much the model matrix stretches the direction
+bool Molecule::raycast(const Vec3& origin, const Vec3& direction, float maxDistance, BVHHit hit){
+	Mat4 inverse = this->getModelMatrix()->getInverse();
+	Vec3 localOrigin = origin.applyMatrix(inverse,1);
+	Vec3 localDirection = direction.applyMatrix(inverse,0);
+	float scale = localDirection.length() / direction.length();
+	if(scale == 0) return false;
+	GLfloat o[3] = {localOrigin.getX(),localOrigin.getY(),localOrigin.getZ()};
+	GLfloat d[3] = {localDirection.getX(),localDirection.getY(),localDirection.getZ()};
+	if(!this->getBVH()->raycast(o,d,maxDistance * scale,hit)) return false;
+	hit->distance /= scale;
+	return true;
+}
+
+//distances are only exact for uniformly scaled molecules
+bool Molecule::closestPrimitive(const Vec3& point, float maxDistance, BVHHit hit){
+	Mat4* model = this->getModelMatrix();
+	const GLfloat* m = model->getElements();
+	float scale = sqrt(m[0]*m[0] + m[4]*m[4] + m[8]*m[8]);
+	if(scale == 0) return false;
+	Vec3 localPoint = point.applyMatrix(model->getInverse(),1);
+	GLfloat p[3] = {localPoint.getX(),localPoint.getY(),localPoint.getZ()};
+	if(!this->getBVH()->closestPrimitive(p,maxDistance / scale,hit)) return false;
+	hit->distance *= scale;
+	return true;
+}
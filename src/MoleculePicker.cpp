@@ -0,0 +1,146 @@
+#include "MoleculePicker.h"
+#include <cmath>
+#include <cfloat>
+using namespace std;
+
+MoleculePicker::MoleculePicker(){
+	this->dirty = false;
+}
+
+void MoleculePicker::addMolecule(Molecule* molecule){
+	this->molecules.push_back(molecule);
+	this->dirty = true;
+}
+
+void MoleculePicker::clear(){
+	this->molecules.clear();
+	this->dirty = true;
+}
+
+int MoleculePicker::getNumMolecules(){
+	return this->molecules.size();
+}
+
+Molecule* MoleculePicker::getMolecule(int index){
+	return this->molecules[index];
+}
+
+//world space sphere around the molecule's own tree, the radius grows with the
+//largest scale of the model matrix
+void MoleculePicker::moleculeBounds(int index, BVHPrimitive primitive){
+	Molecule* molecule = this->molecules[index];
+	GLfloat min[3];
+	GLfloat max[3];
+	molecule->getBVH()->getBounds(min,max);
+	Vec3 center((min[0] + max[0]) * 0.5,(min[1] + max[1]) * 0.5,(min[2] + max[2]) * 0.5);
+	Vec3 halfSize((max[0] - min[0]) * 0.5,(max[1] - min[1]) * 0.5,(max[2] - min[2]) * 0.5);
+	Mat4* model = molecule->getModelMatrix();
+	const GLfloat* m = model->getElements();
+	float scale = 0;
+	for(int axis = 0; axis < 3; axis++){
+		scale = fmax(scale,sqrt(m[axis]*m[axis] + m[4 + axis]*m[4 + axis] + m[8 + axis]*m[8 + axis]));
+	}
+	center = center.applyMatrix(*model,1);
+	primitive->start[0] = primitive->end[0] = center.getX();
+	primitive->start[1] = primitive->end[1] = center.getY();
+	primitive->start[2] = primitive->end[2] = center.getZ();
+	primitive->radius = halfSize.length() * scale;
+	primitive->type = SPHERE_PRIMITIVE;
+	primitive->index = index;
+}
+
+//the molecule tree is rebuilt when molecules are added or removed, when they
+//only moved or changed representation their spheres are refit
+void MoleculePicker::update(){
+	int numMolecules = this->molecules.size();
+	if(this->dirty){
+		this->bounds.resize(numMolecules);
+		this->versions.resize(numMolecules);
+		this->spacefillModes.resize(numMolecules);
+		for(int i = 0; i < numMolecules; i++){
+			this->molecules[i]->updateModelMatrix();
+			this->versions[i] = this->molecules[i]->getWorldVersion();
+			this->spacefillModes[i] = this->molecules[i]->getSpacefillMode();
+			this->moleculeBounds(i,&(this->bounds[i]));
+		}
+		this->moleculeTree.build(this->bounds.empty() ? NULL : &(this->bounds[0]),numMolecules);
+		this->dirty = false;
+		return;
+	}
+	BVHPrimitive primitives = this->moleculeTree.getPrimitives();
+	bool moved = false;
+	for(int i = 0; i < numMolecules; i++){
+		BVHPrimitive primitive = &(primitives[i]);
+		Molecule* molecule = this->molecules[primitive->index];
+		molecule->updateModelMatrix();
+		if(molecule->getWorldVersion() == this->versions[primitive->index] &&
+		   molecule->getSpacefillMode() == this->spacefillModes[primitive->index]) continue;
+		this->versions[primitive->index] = molecule->getWorldVersion();
+		this->spacefillModes[primitive->index] = molecule->getSpacefillMode();
+		this->moleculeBounds(primitive->index,primitive);
+		moved = true;
+	}
+	if(moved) this->moleculeTree.refit();
+}
+
+//molecules are visited in the order the ray enters their spheres, once the
+//nearest hit is closer than the next sphere the rest can not beat it
+bool MoleculePicker::raycast(const Vec3& origin, const Vec3& direction, float maxDistance, PickResult result){
+	this->update();
+	GLfloat o[3] = {origin.getX(),origin.getY(),origin.getZ()};
+	GLfloat d[3] = {direction.getX(),direction.getY(),direction.getZ()};
+	int numHits = this->moleculeTree.raycastAll(o,d,maxDistance,this->hits);
+	float best = maxDistance;
+	bool found = false;
+	for(int i = 0; i < numHits && this->hits[i].distance < best; i++){
+		Molecule* molecule = this->molecules[this->hits[i].index];
+		struct bvhHit hit;
+		if(molecule->raycast(origin,direction,best,&hit) && hit.distance < best){
+			best = hit.distance;
+			result->molecule = molecule;
+			result->moleculeIndex = this->hits[i].index;
+			result->type = hit.type;
+			result->index = hit.index;
+			result->distance = hit.distance;
+			found = true;
+		}
+	}
+	return found;
+}
+
+//x and y in normalized device coordinates, the ray goes from the near to the
+//far plane through that pixel
+bool MoleculePicker::pick(Camera* camera, float x, float y, PickResult result){
+	Mat4 inverse = (*(camera->getProjectionMatrix()) * *(camera->getWorldMatrix())).getInverse();
+	Vec3 nearPoint = Vec3(x,y,-1).applyMatrix(inverse,1,true);
+	Vec3 farPoint = Vec3(x,y,1).applyMatrix(inverse,1,true);
+	Vec3 direction = farPoint - nearPoint;
+	return this->raycast(nearPoint,direction,direction.length(),result);
+}
+
+//every molecule whose sphere is nearer than the best surface so far is
+//searched, there are few enough molecules to check their spheres in order
+bool MoleculePicker::closestPrimitive(const Vec3& point, float maxDistance, PickResult result){
+	this->update();
+	BVHPrimitive spheres = this->moleculeTree.getPrimitives();
+	int numMolecules = this->molecules.size();
+	float best = maxDistance;
+	bool found = false;
+	for(int i = 0; i < numMolecules; i++){
+		BVHPrimitive sphere = &(spheres[i]);
+		Vec3 center(sphere->start[0],sphere->start[1],sphere->start[2]);
+		if(point.distance(center) - sphere->radius >= best) continue;
+		Molecule* molecule = this->molecules[sphere->index];
+		struct bvhHit hit;
+		if(molecule->closestPrimitive(point,best,&hit) && hit.distance < best){
+			best = hit.distance;
+			result->molecule = molecule;
+			result->moleculeIndex = sphere->index;
+			result->type = hit.type;
+			result->index = hit.index;
+			result->distance = hit.distance;
+			found = true;
+		}
+	}
+	return found;
+}
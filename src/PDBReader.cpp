@@ -0,0 +1,273 @@
+#include "PDBReader.h"
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+enum RecordType {RECORD_OTHER, RECORD_ATOM, RECORD_CONECT, RECORD_ENDMDL};
+
+static RecordType recordType(const char* line, int length){
+	if(length < 6) return RECORD_OTHER;
+	if(!memcmp(line,"ATOM  ",6) || !memcmp(line,"HETATM",6)) return RECORD_ATOM;
+	if(!memcmp(line,"CONECT",6)) return RECORD_CONECT;
+	if(!memcmp(line,"ENDMDL",6)) return RECORD_ENDMDL;
+	return RECORD_OTHER;
+}
+
+//returns the length of the line starting at line, without the line terminator
+static int lineLength(const char* line, const char* end, const char** next){
+	const char* eol = (const char*)memchr(line,'\n',end - line);
+	if(eol == NULL){
+		eol = end;
+		*next = end;
+	}
+	else{
+		*next = eol + 1;
+	}
+	if(eol > line && eol[-1] == '\r') eol--;
+	return eol - line;
+}
+
+//width of the field starting at column, clipped to the line length
+static int fieldWidth(int length, int column, int width){
+	if(column >= length) return 0;
+	return column + width > length ? length - column : width;
+}
+
+PDBReader::PDBReader(){
+	this->data = NULL;
+	this->size = 0;
+#ifdef _WIN32
+	this->file = INVALID_HANDLE_VALUE;
+	this->mapping = NULL;
+#else
+	this->file = -1;
+#endif
+	this->atoms = NULL;
+	this->numAtoms = 0;
+	this->conects = NULL;
+	this->numConects = 0;
+}
+
+PDBReader::~PDBReader(){
+	this->clear();
+}
+
+void PDBReader::clear(){
+	if(this->atoms != NULL)
+		delete[] this->atoms;
+	if(this->conects != NULL)
+		delete[] this->conects;
+	this->atoms = NULL;
+	this->conects = NULL;
+	this->numAtoms = 0;
+	this->numConects = 0;
+}
+
+bool PDBReader::mapFile(const char* filename){
+#ifdef _WIN32
+	this->file = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+	if(this->file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(this->file,&fileSize) || fileSize.QuadPart == 0){
+		this->unmapFile();
+		return false;
+	}
+	this->size = (size_t)fileSize.QuadPart;
+	this->mapping = CreateFileMappingA(this->file,NULL,PAGE_READONLY,0,0,NULL);
+	if(this->mapping == NULL){
+		this->unmapFile();
+		return false;
+	}
+	this->data = (const char*)MapViewOfFile(this->mapping,FILE_MAP_READ,0,0,0);
+	if(this->data == NULL){
+		this->unmapFile();
+		return false;
+	}
+#else
+	this->file = open(filename,O_RDONLY);
+	if(this->file < 0) return false;
+	struct stat fileStat;
+	if(fstat(this->file,&fileStat) < 0 || fileStat.st_size == 0){
+		this->unmapFile();
+		return false;
+	}
+	this->size = fileStat.st_size;
+	void* mapped = mmap(NULL,this->size,PROT_READ,MAP_PRIVATE,this->file,0);
+	if(mapped == MAP_FAILED){
+		this->unmapFile();
+		return false;
+	}
+	madvise(mapped,this->size,MADV_SEQUENTIAL);
+	this->data = (const char*)mapped;
+#endif
+	return true;
+}
+
+void PDBReader::unmapFile(){
+#ifdef _WIN32
+	if(this->data != NULL) UnmapViewOfFile(this->data);
+	if(this->mapping != NULL) CloseHandle(this->mapping);
+	if(this->file != INVALID_HANDLE_VALUE) CloseHandle(this->file);
+	this->mapping = NULL;
+	this->file = INVALID_HANDLE_VALUE;
+#else
+	if(this->data != NULL) munmap((void*)this->data,this->size);
+	if(this->file >= 0) close(this->file);
+	this->file = -1;
+#endif
+	this->data = NULL;
+}
+
+bool PDBReader::read(const char* filename){
+	this->clear();
+	if(!this->mapFile(filename)) return false;
+	const char* end = this->data + this->size;
+	const char* next;
+
+	//first pass: count records so the arrays are allocated once
+	int atomCount = 0;
+	int conectCount = 0;
+	bool endModel = false;
+	for(const char* line = this->data; line < end; line = next){
+		int length = lineLength(line,end,&next);
+		switch(recordType(line,length)){
+			case RECORD_ATOM:
+				if(!endModel) atomCount++;
+				break;
+			case RECORD_CONECT:
+				conectCount++;
+				break;
+			case RECORD_ENDMDL:
+				endModel = true;
+				break;
+			default:
+				break;
+		}
+	}
+	this->atoms = new struct pdbAtom[atomCount > 0 ? atomCount : 1];
+	this->conects = new struct pdbConect[conectCount > 0 ? conectCount : 1];
+
+	//second pass: parse fields in place
+	endModel = false;
+	for(const char* line = this->data; line < end; line = next){
+		int length = lineLength(line,end,&next);
+		RecordType type = recordType(line,length);
+		if(type == RECORD_ENDMDL){
+			endModel = true;
+		}
+		else if(type == RECORD_ATOM && !endModel){
+			PDBAtom atom = &(this->atoms[this->numAtoms++]);
+			atom->serial = parseFixedInt(line + 6,fieldWidth(length,6,5));
+			atom->residue = parseFixedInt(line + 22,fieldWidth(length,22,4));
+			atom->chain = length > 21 ? line[21] : ' ';
+			atom->hetatm = line[0] == 'H';
+			atom->x = parseFixedFloat(line + 30,fieldWidth(length,30,8));
+			atom->y = parseFixedFloat(line + 38,fieldWidth(length,38,8));
+			atom->z = parseFixedFloat(line + 46,fieldWidth(length,46,8));
+			parseElement(line,length,atom->element);
+		}
+		else if(type == RECORD_CONECT){
+			PDBConect conect = &(this->conects[this->numConects++]);
+			conect->serial = parseFixedInt(line + 6,fieldWidth(length,6,5));
+			for(int i = 0; i < 4; i++){
+				conect->bonded[i] = parseFixedInt(line + 11 + 5*i,fieldWidth(length,11 + 5*i,5));
+			}
+		}
+	}
+	this->unmapFile();
+	return true;
+}
+
+void PDBReader::parseElement(const char* line, int length, char* element){
+	char c76 = length > 76 ? line[76] : ' ';
+	char c77 = length > 77 ? line[77] : ' ';
+	int n = 0;
+	//element columns are empty in old files, use the atom name instead
+	if(isspace(c76) && isspace(c77)){
+		if(length > 12 && (isspace(line[12]) || isdigit(line[12]))){
+			if(length > 13) element[n++] = line[13];
+		}
+		else{
+			if(length > 12) element[n++] = line[12];
+			if(length > 13) element[n++] = line[13];
+		}
+	}
+	else{
+		if(isspace(c76)){
+			element[n++] = c77;
+		}
+		else{
+			element[n++] = c76;
+			element[n++] = c77;
+		}
+	}
+	element[n] = '\0';
+}
+
+float PDBReader::parseFixedFloat(const char* field, int width){
+	const char* c = field;
+	const char* end = field + width;
+	while(c < end && *c == ' ') c++;
+	bool negative = false;
+	if(c < end && (*c == '-' || *c == '+')){
+		negative = *c == '-';
+		c++;
+	}
+	//digits are accumulated as an integer and scaled once at the end
+	long mantissa = 0;
+	int decimals = 0;
+	for(; c < end && isdigit(*c); c++){
+		mantissa = mantissa * 10 + (*c - '0');
+	}
+	if(c < end && *c == '.'){
+		c++;
+		for(; c < end && isdigit(*c) && decimals < 9; c++, decimals++){
+			mantissa = mantissa * 10 + (*c - '0');
+		}
+	}
+	static const double powers[10] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9};
+	float value = (float)(mantissa / powers[decimals]);
+	return negative ? -value : value;
+}
+
+int PDBReader::parseFixedInt(const char* field, int width){
+	const char* c = field;
+	const char* end = field + width;
+	while(c < end && *c == ' ') c++;
+	bool negative = false;
+	if(c < end && (*c == '-' || *c == '+')){
+		negative = *c == '-';
+		c++;
+	}
+	int value = 0;
+	for(; c < end && isdigit(*c); c++){
+		value = value * 10 + (*c - '0');
+	}
+	return negative ? -value : value;
+}
+
+PDBAtom PDBReader::getAtoms(){
+	return this->atoms;
+}
+
+int PDBReader::getNumAtoms(){
+	return this->numAtoms;
+}
+
+PDBConect PDBReader::getConects(){
+	return this->conects;
+}
+
+int PDBReader::getNumConects(){
+	return this->numConects;
+}
+
+size_t PDBReader::getFileSize(){
+	return this->size;
+}
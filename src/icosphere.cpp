@@ -1,6 +1,7 @@
 #include <cstdio>
 #include "object/Mesh.h"
 #include "object/Geometry.h"
+#include "object/GeometryRegistry.h"
 #include "material/PhongMaterial.h"
 #include "material/Material.h"
 #include "scene/Scene.h"
@@ -61,8 +62,7 @@ void initializeContext(int argc, char** argv){
 }
 
 Mesh* createIcosphere(){
-	Geometry* icosphereGeometry= new Geometry();
-	icosphereGeometry->loadDataFromFile("highres-icosphere.mesh");
+	Geometry* icosphereGeometry= GeometryRegistry::getInstance()->getGeometry("highres-icosphere.mesh");
 	Material* icosphereMaterial = (Material *)new PhongMaterial();
 	icosphereMaterial->getDiffuseColor()->setRGB(1.0,0.0,0.0);
 	icosphereMaterial->getSpecularColor()->setRGB(0.8,0.8,0.8);
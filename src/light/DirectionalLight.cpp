@@ -3,11 +3,12 @@
 DirectionalLight::DirectionalLight(){
 	this->target = new Object3D();
 	this->intensity = 1;
+	this->targetVersion = 0;
 }
 
 DirectionalLight::~DirectionalLight(){
 	if(this->target != NULL)
-		delete[] (this->target);
+		delete this->target;
 }
 
 Object3D* DirectionalLight::getTarget(){
@@ -20,30 +21,32 @@ GLfloat DirectionalLight::getIntensity(){
 
 void DirectionalLight::setIntensity(GLfloat intensity){
 	this->intensity = intensity;
+	this->markChanged();
 }
 
-GLfloat* DirectionalLight::getVectorToLightAsArray(Camera* camera){
-	GLfloat* vec = new GLfloat[4];
-	Vec3* worldLightPos = this->getPosition()->applyMatrix(camera->getWorldMatrix(),1);
-	Vec3* worldTargetPos = this->target->getPosition()->applyMatrix(camera->getWorldMatrix(),1);
-
-	vec[0]= worldLightPos->getX() - worldTargetPos->getX();
-	vec[1]= worldLightPos->getY() - worldTargetPos->getY();
-	vec[2]= worldLightPos->getZ() - worldTargetPos->getZ();
+//vec must hold 4 floats
+void DirectionalLight::getVectorToLightAsArray(Camera* camera, GLfloat* vec){
+	Mat4* worldMatrix = camera->getWorldMatrix();
+	Vec3 vectorToLight = this->getPosition()->applyMatrix(*worldMatrix,1) -
+	                     this->target->getPosition()->applyMatrix(*worldMatrix,1);
+	vec[0]= vectorToLight.getX();
+	vec[1]= vectorToLight.getY();
+	vec[2]= vectorToLight.getZ();
 	vec[3]= 0.0;
-	delete worldLightPos;
-	delete worldTargetPos;
-	return vec;
 }
 
-DirLight DirectionalLight::getAsStruct(Camera* camera){
-	DirLight light = new struct dirLight;
+void DirectionalLight::getAsStruct(Camera* camera, DirLight light){
 	light->intensity = this->intensity;
-	GLfloat * color = this->getColor()->getAsArray();
-	memcpy(&(light->color),color,sizeof(GLfloat)*4);
-	delete[] color;
-	GLfloat * vec = this->getVectorToLightAsArray(camera);
-	memcpy(&(light->vectorToLight),vec,sizeof(GLfloat)*4);
-	delete[] vec;
-	return light;
+	this->getColor()->getAsArray(light->color);
+	this->getVectorToLightAsArray(camera,light->vectorToLight);
 }
+
+//moving the target turns the light as well
+unsigned int DirectionalLight::getVersion(){
+	this->target->updateModelMatrix();
+	if(this->target->getWorldVersion() != this->targetVersion){
+		this->targetVersion = this->target->getWorldVersion();
+		this->markChanged();
+	}
+	return Light::getVersion();
+}
\ No newline at end of file
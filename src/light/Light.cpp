@@ -2,6 +2,9 @@
 
 Light::Light(): Object3D(){
 	this->color = new Color();
+	this->version = 0;
+	this->colorVersion = 0;
+	this->positionVersion = 0;
 }
 Light::~Light(){
 	if (this->color != NULL) delete (this->color);
@@ -11,4 +14,20 @@ Color* Light::getColor(){
 }
 void Light::setColor(Color* color){
 	this->color = color;
+	this->colorVersion = color->getVersion();
+	this->version++;
+}
+
+void Light::markChanged(){
+	this->version++;
+}
+
+unsigned int Light::getVersion(){
+	this->updateModelMatrix();
+	if(this->color->getVersion() != this->colorVersion || this->getWorldVersion() != this->positionVersion){
+		this->colorVersion = this->color->getVersion();
+		this->positionVersion = this->getWorldVersion();
+		this->version++;
+	}
+	return this->version;
 }
\ No newline at end of file
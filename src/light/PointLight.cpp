@@ -8,6 +8,7 @@ PointLight::PointLight():Light(){
 
 void PointLight::setIntensity(GLfloat intensity){
 	this->intensity = intensity;
+	this->markChanged();
 }
 
 GLfloat PointLight::getIntensity(){
@@ -20,6 +21,7 @@ PointLight::~PointLight(){
 
 void PointLight::setAttenuation(GLfloat attenuation){
 	this->attenuation = attenuation;
+	this->markChanged();
 }
 
 GLfloat PointLight::getAttenuation(){
@@ -27,20 +29,15 @@ GLfloat PointLight::getAttenuation(){
 }
 
 
-PLight PointLight::getAsStruct(Camera* camera){
-	PLight light = new struct pLight;
+//fills the caller's struct, usually a slot of the lights UBO chunk
+void PointLight::getAsStruct(Camera* camera, PLight light){
 	light->intensity = this->intensity;
 	light->attenuation = this->attenuation;
-	GLfloat * color = this->getColor()->getAsArray();
-	memcpy(&(light->color),color,sizeof(GLfloat)*4);
-	delete[] color;
-
-	Vec3 * worldSpacePosition = this->getPosition()->applyMatrix(camera->getWorldMatrix(),1);
-	light->position[0] = worldSpacePosition->getX();
-	light->position[1] = worldSpacePosition->getY();
-	light->position[2] = worldSpacePosition->getZ();
-	light->position[3] = 1.0;
+	this->getColor()->getAsArray(light->color);
 
-	delete worldSpacePosition;
-	return light;
+	Vec3 worldSpacePosition = this->getPosition()->applyMatrix(*(camera->getWorldMatrix()),1);
+	light->position[0] = worldSpacePosition.getX();
+	light->position[1] = worldSpacePosition.getY();
+	light->position[2] = worldSpacePosition.getZ();
+	light->position[3] = 1.0;
 }
\ No newline at end of file
@@ -11,10 +11,13 @@
 
 //#include "Molecule.h"
 #include "object/Mesh.h"
+#include "object/GeometryRegistry.h"
 #include "scene/Scene.h"
+#include "scene/MoleculeGrid.h"
 #include "render/Renderer.h"
 #include "material/PhongMaterial.h"
 #include "Molecule.h"
+#include "MoleculePicker.h"
 #include "math/SphericalCoord.h"
 
 #define PI 3.1415927
@@ -26,7 +29,10 @@
 Renderer* renderer;
 Scene* scene;
 Molecule* mol;
+Molecule** molecules;
+MoleculePicker* picker;
 DirectionalLight* light1;
+bool animate = false;
 
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
@@ -101,46 +107,62 @@ void initializeContext(){
 }
 
 void updateLightSphericalPosition(float deltaPhi, float deltaTheta){
-	Vec3* molPos = new Vec3(0,0,0);
-	SphericalCoord* sphCoord = new SphericalCoord(light1->getPosition(),molPos);
-	sphCoord->setR(10);
-	float phi = sphCoord->getPhi() + deltaPhi;
-	float theta = sphCoord->getTheta() + deltaTheta;
+	Vec3 molPos(0,0,0);
+	SphericalCoord sphCoord(*(light1->getPosition()),molPos);
+	sphCoord.setR(10);
+	float phi = sphCoord.getPhi() + deltaPhi;
+	float theta = sphCoord.getTheta() + deltaTheta;
 	phi = fmax(MINANG,fmin(MAXANG,phi));
 	phi = fmax( EPS, fmin( PI - EPS, phi ));
-	sphCoord->setPhi(phi);
-	sphCoord->setTheta(theta);
-	Vec3* newPos = sphCoord->getCartesian(molPos);
-	light1->getPosition()->setX(newPos->getX());
-	light1->getPosition()->setY(newPos->getY());
-	light1->getPosition()->setZ(newPos->getZ());
-	delete sphCoord;
-	delete molPos;
-	delete newPos;
+	sphCoord.setPhi(phi);
+	sphCoord.setTheta(theta);
+	light1->setPosition(sphCoord.getCartesian(molPos));
+}
+
+//every molecule bobs around its place in the grid
+void moveMolecules(int time){
+	for(int index = 0; index < DIM*DIM*DIM; index++){
+		MoleculeGrid::move(molecules[index],index,DIM,time);
+	}
 }
 
 //move this function as a method of Object3D
 void updateCamSphericalPosition(float deltaPhi, float deltaTheta, float radiusFactor){
 	Camera* camera = scene->getCamera();
-	Vec3* molPos = new Vec3(0,0,0);
-	SphericalCoord* sphCoord = new SphericalCoord(camera->getPosition(),molPos);
-	float r = sphCoord->getR()*radiusFactor;
+	Vec3 molPos(0,0,0);
+	SphericalCoord sphCoord(*(camera->getPosition()),molPos);
+	float r = sphCoord.getR()*radiusFactor;
 	r = fmax(0.2,fmin(99.0,r));
-	sphCoord->setR(r);
-	float phi = sphCoord->getPhi() + deltaPhi;
-	float theta = sphCoord->getTheta() + deltaTheta;
+	sphCoord.setR(r);
+	float phi = sphCoord.getPhi() + deltaPhi;
+	float theta = sphCoord.getTheta() + deltaTheta;
 	phi = fmax(MINANG,fmin(MAXANG,phi));
 	phi = fmax( EPS, fmin( PI - EPS, phi ));
-	sphCoord->setPhi(phi);
-	sphCoord->setTheta(theta);
-	Vec3* newPos = sphCoord->getCartesian(molPos);
-	camera->getPosition()->setX(newPos->getX());
-	camera->getPosition()->setY(newPos->getY());
-	camera->getPosition()->setZ(newPos->getZ());
-	delete sphCoord;
-	delete molPos;
-	delete newPos;
-	//scene->getOctree()->calculateVisibility(camera);
+	sphCoord.setPhi(phi);
+	sphCoord.setTheta(theta);
+	camera->setPosition(sphCoord.getCartesian(molPos));
+}
+
+//prints the atom or bond under the cursor
+void pickMolecule(int x, int y){
+	struct pickResult result;
+	float ndcX = 2.0 * x / SCREEN_WIDTH - 1.0;
+	float ndcY = 1.0 - 2.0 * y / SCREEN_HEIGHT;
+	if(!picker->pick(scene->getCamera(),ndcX,ndcY,&result)){
+		printf("nothing picked\n");
+		return;
+	}
+	AtomTable* atomTable = result.molecule->getAtomTable();
+	if(result.type == SPHERE_PRIMITIVE){
+		printf("molecule %d atom %d %s residue %d at %.2f\n",result.moleculeIndex,result.index,
+			atomTable->getSymbol(result.index),atomTable->getResidue(result.index),result.distance);
+	}
+	else{
+		Bond bond = result.molecule->getConnections()->getBond(result.index);
+		printf("molecule %d bond %d %s%d-%s%d order %d at %.2f\n",result.moleculeIndex,result.index,
+			atomTable->getSymbol(bond->atom1),bond->atom1,atomTable->getSymbol(bond->atom2),bond->atom2,
+			bond->order,result.distance);
+	}
 }
 
 bool handleEvents(){
@@ -166,37 +188,51 @@ bool handleEvents(){
 						break;
 					case SDLK_l:
 						mol->getPosition()->setX(mol->getPosition()->getX() + 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_j:
 						mol->getPosition()->setX(mol->getPosition()->getX() - 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_i:
 						mol->getPosition()->setY(mol->getPosition()->getY() + 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_k:
 						mol->getPosition()->setY(mol->getPosition()->getY() - 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_u:
 						mol->getPosition()->setZ(mol->getPosition()->getZ() + 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_o:
 						mol->getPosition()->setZ(mol->getPosition()->getZ() - 0.5);
-						//mol->updateOctreeNode();
-						//scene->getOctree()->generateTreeMesh();
 						break;
 					case SDLK_p:
 						printf("printing tree!\n");
-						//scene->getOctree()->print();
+						scene->getOctree()->print();
+						break;
+					case SDLK_b:
+						animate = !animate;
+						printf("moving molecules %s\n",animate ? "on" : "off");
+						break;
+					case SDLK_c:
+						renderer->setCulling(!renderer->getCulling());
+						printf("culling %s\n",renderer->getCulling() ? "on" : "off");
+						break;
+					case SDLK_m:
+						for(int i = 0; i < DIM*DIM*DIM; i++){
+							molecules[i]->setImpostors(!molecules[i]->getImpostors());
+						}
+						printf("impostors %s\n",molecules[0]->getImpostors() ? "on" : "off");
+						break;
+					case SDLK_n:
+						renderer->setInstancing(!renderer->getInstancing());
+						printf("instancing %s\n",renderer->getInstancing() ? "on" : "off");
+						break;
+					case SDLK_v:
+						renderer->setMultiDraw(!renderer->getMultiDraw());
+						printf("multi draw %s\n",renderer->getMultiDraw() ? "on" : "off");
+						break;
+					case SDLK_g:
+						renderer->setGpuCulling(!renderer->getGpuCulling());
+						printf("gpu culling %s\n",renderer->getGpuCulling() ? "on" : "off");
 						break;
 				}
 				break;
@@ -207,6 +243,11 @@ bool handleEvents(){
 					updateCamSphericalPosition(deltaPhi,deltaTheta,1.0);
 				}
 				break;
+			case SDL_MOUSEBUTTONDOWN:
+				if(event.button.button == SDL_BUTTON_RIGHT){
+					pickMolecule(event.button.x,event.button.y);
+				}
+				break;
 			case SDL_MOUSEWHEEL:
 				float factor;
 				factor = event.wheel.y * 0.05;
@@ -222,12 +263,17 @@ bool handleEvents(){
 void render(){
 	newTime = SDL_GetTicks();
 	int diff = newTime - oldTime;
-	sprintf(title,"Molecule: %1.0f FPS %d ms/frame",1.0/diff *1000,diff);
-	printf("%d\n",diff );
+	//stats are from the previous frame, the one diff measured
+	RenderStats stats = renderer->getStats();
+	sprintf(title,"Molecule: %1.0f FPS %d ms/frame %d draw calls",1.0/diff *1000,diff,stats->drawCalls);
+	printf("%d ms %d draw calls %d meshes %d instances %d batches %d/%d local/world matrices %d culled %d moved %d/%d/%d program/buffer/uniform updates %d bytes uploaded\n",diff,stats->drawCalls,stats->meshes,stats->instances,stats->batches,stats->localMatrices,stats->worldMatrices,stats->culledObjects,stats->movedObjects,stats->programBinds,stats->bufferBinds,stats->uniformUploads,stats->uploadedBytes);
 	SDL_SetWindowTitle(window,title);
 	oldTime=newTime;
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if(animate){
+		moveMolecules(newTime);
+	}
 	renderer->render(scene);
     SDL_GL_SwapWindow(window);
 }
@@ -241,6 +287,7 @@ void mainLoop(){
 }
 
 void cleanUp(){
+	delete picker;
 	delete scene;
 	delete renderer;
 	SDL_GL_DeleteContext(context);
@@ -252,18 +299,19 @@ int main(int argc, char** argv){
 	initializeContext();
 	/*int c;
 	scanf("%d",&c);*/
+	int startupStart = SDL_GetTicks();
 	scene = new Scene();
-	mol = new Molecule("caffeine.pdb");
-	Molecule** molecules = new Molecule*[DIM*DIM*DIM];
+	mol = new Molecule(argc > 1 ? argv[1] : "caffeine.pdb");
+	molecules = new Molecule*[DIM*DIM*DIM];
+	picker = new MoleculePicker();
 	for(int i =0 ; i < DIM; i++){
 		for(int j=0; j <DIM;j++){
 			for(int k=0; k < DIM; k++){
 				int index = i*DIM*DIM + j*DIM + k;
 				molecules[index] = new Molecule(*mol);
-				molecules[index]->getPosition()->setX(-DIM*10/2.0 + 10*i);
-				molecules[index]->getPosition()->setY(-DIM*12/2.0 +12*j);
-				molecules[index]->getPosition()->setZ(-DIM*8/2.0 +8*k);
+				MoleculeGrid::place(molecules[index],index,DIM);
 				molecules[index]->addToScene(scene);
+				picker->addMolecule(molecules[index]);
 			}
 		}
 	}
@@ -272,21 +320,22 @@ int main(int argc, char** argv){
 	//mol->addToScene(scene);
 	//newMol->addToScene(scene);
 	Camera* camera = scene->getCamera();
-	camera->setTarget(new Vec3(0,0,0));
+	camera->setTarget(Vec3(0,0,0));
 	light1 = new DirectionalLight();
 	light1->getPosition()->setX(2.0);
 	light1->getPosition()->setY(4.0);
 	light1->getPosition()->setZ(5.0);
 	light1->getColor()->setRGB(1,1,1);
 	scene->addDirectionalLight(light1);
-	//scene->getOctree()->getPosition()->setX(mol->getX());
-	//scene->getOctree()->getPosition()->setY(mol->getY());
-	//scene->getOctree()->getPosition()->setZ(mol->getZ());
 	mol->getPosition()->setX(5);
 	mol->getPosition()->setY(6);
 	mol->getPosition()->setZ(4);
-	//scene->generateOctree();
 	renderer = new Renderer();
+	ProgramCache* programCache = ProgramCache::getInstance();
+	printf("startup %d ms, %d programs compiled, %d loaded from disk, %d reused\n",(int)SDL_GetTicks() - startupStart,
+	       programCache->getCompiles(),programCache->getLoads(),programCache->getHits());
+	GeometryRegistry* geometryRegistry = GeometryRegistry::getInstance();
+	printf("%d mesh files loaded, %d geometries shared\n",geometryRegistry->getLoads(),geometryRegistry->getHits());
 	mainLoop();
 	cleanUp();
     return 0;
@@ -0,0 +1,291 @@
+#include "material/ImpostorMaterial.h"
+#include <string.h>
+#include <string>
+using namespace std;
+
+//declarations and blinn-phong lighting shared by both fragment shaders,
+//same model as PhongMaterial with the material taken from the instance
+static const char* impostorLighting =
+	"#version 410\n\
+	#define MAX_DIR_LIGHTS 10\n\
+	#define MAX_P_LIGHTS 10\n\
+	#define MAX_MATERIALS 256\n\
+	struct DirectionalLight{\n\
+		vec4 color;\n\
+		vec4 vectorToLight;\n\
+		float intensity;\n\
+	};\n\
+	\n\
+	struct PointLight{\n\
+		vec4 color;\n\
+		vec4 position;\n\
+		float intensity;\n\
+		float attenuation;\n\
+	};\n\
+	\n\
+	struct Material{\n\
+		vec4 diffuseColor;\n\
+		vec4 specularColor;\n\
+		float shininess;\n\
+	};\n\
+	\n\
+	layout(std140) uniform globalMatrices{\n\
+		mat4 worldMatrix;\n\
+		mat4 projectionMatrix;\n\
+	};\n\
+	layout(std140) uniform directionalLights{\n\
+		DirectionalLight dirLights[MAX_DIR_LIGHTS];\n\
+		int numDirLights;\n\
+	};\n\
+	layout(std140) uniform pointLights{\n\
+		PointLight pLights[MAX_P_LIGHTS];\n\
+		int numPointLights;\n\
+	};\n\
+	layout(std140) uniform ambLight{\n\
+		vec4 ambientLight;\n\
+	};\n\
+	\n\
+	layout(std140) uniform materialTable{\n\
+		Material materials[MAX_MATERIALS];\n\
+	};\n\
+	out vec4 outputColor;\n\
+	vec4 attenuateLight(in vec4 color, in float attenuation, in vec4 vectorToLight){\n\
+		float distSqr = dot(vectorToLight,vectorToLight);\n\
+		vec4 attenLightIntensity = color * (1/(1.0 + attenuation * sqrt(distSqr)));\n\
+		return attenLightIntensity;\n\
+	}\n\
+	\n\
+	float warp (in float value,in float factor){\n\
+		return (value + factor ) / (1+ clamp(factor,0,1));\n\
+	}\n\
+	float calculateBlinnPhongTerm(in vec4 direction,vec4 normal, in vec4 viewDirection, in float shininess, out float cosAngIncidence){\n\
+		cosAngIncidence = dot( normal , direction);\n\
+		cosAngIncidence = warp(cosAngIncidence,1);\n\
+		cosAngIncidence = clamp(cosAngIncidence, 0, 1);\n\
+		vec4 halfAngle = normalize(direction + viewDirection);\n\
+		float blinnPhongTerm = dot(normal, halfAngle);\n\
+		blinnPhongTerm = clamp(blinnPhongTerm, 0, 1);\n\
+		blinnPhongTerm = cosAngIncidence != 0.0 ? blinnPhongTerm : 0.0;\n\
+		blinnPhongTerm = pow(blinnPhongTerm, shininess);\n\
+		return blinnPhongTerm;\n\
+	}\n\
+	\n\
+	vec4 shade(in vec4 position, in vec4 normal, in Material material){\n\
+		vec4 color = material.diffuseColor;\n\
+		vec4 viewDirection = normalize(-position);\n\
+		vec4 result = vec4(0.0,0.0,0.0,1.0);\n\
+		for(int i=0; i< numDirLights ;i++){\n\
+			vec4 normDirection = normalize(dirLights[i].vectorToLight);\n\
+			float cosAngIncidence;\n\
+			float blinnPhongTerm = calculateBlinnPhongTerm(normDirection,normal,viewDirection,material.shininess,cosAngIncidence);\n\
+			result = result + (dirLights[i].color * color * cosAngIncidence);\n\
+			result = result + (material.specularColor * blinnPhongTerm);\n\
+		}\n\
+		for(int i=0; i< numPointLights ;i++){\n\
+			vec4 difference = pLights[i].position - position;\n\
+			vec4 normDirection = normalize(difference);\n\
+			vec4 attenLightIntensity = attenuateLight(pLights[i].color,pLights[i].attenuation,difference);\n\
+			float cosAngIncidence;\n\
+			float blinnPhongTerm = calculateBlinnPhongTerm(normDirection,normal,viewDirection,material.shininess,cosAngIncidence);\n\
+			result = result + (attenLightIntensity * color * cosAngIncidence);\n\
+			result = result + (material.specularColor * attenLightIntensity * blinnPhongTerm);\n\
+		}\n\
+		return result + (color * ambientLight);\n\
+	}\n\
+	\n\
+	void writeDepth(in vec3 position){\n\
+		vec4 clipSpace = projectionMatrix * vec4(position,1.0);\n\
+		float ndcDepth = clipSpace.z / clipSpace.w;\n\
+		gl_FragDepth = (gl_DepthRange.diff * ndcDepth + gl_DepthRange.near + gl_DepthRange.far) * 0.5;\n\
+	}\n";
+
+//quad perpendicular to the eye ray through the center, sized to the cone
+//tangent to the sphere so its whole silhouette is covered
+static const char* sphereVertexShader =
+	"#version 410\n\
+	in vec3 position;\n\
+	in vec4 instancePosition;\n\
+	in uint instanceMaterial;\n\
+	out vec3 viewPosition;\n\
+	flat out vec3 sphereCenter;\n\
+	flat out float sphereRadius;\n\
+	flat out uint vertexMaterial;\n\
+	layout(std140) uniform globalMatrices{\n\
+		mat4 worldMatrix;\n\
+		mat4 projectionMatrix;\n\
+	};\n\
+	void main(){\n\
+		vec4 instance = instancePosition;\n\
+		#ifdef MULTI_DRAW\n\
+		DrawData draw = draws[firstDraw + gl_DrawIDARB];\n\
+		instance = vec4((draw.modelMatrix * vec4(instance.xyz,1.0)).xyz,instance.w * draw.scale);\n\
+		#endif\n\
+		vec3 center = (worldMatrix * vec4(instance.xyz,1.0)).xyz;\n\
+		float radius = instance.w;\n\
+		vec3 axis = normalize(center);\n\
+		vec3 right = normalize(cross(axis, abs(axis.y) > 0.99 ? vec3(1.0,0.0,0.0) : vec3(0.0,1.0,0.0)));\n\
+		vec3 up = cross(right,axis);\n\
+		float dist = length(center);\n\
+		float size = radius * dist / sqrt(max(dist * dist - radius * radius,0.0001));\n\
+		viewPosition = center + (right * position.x + up * position.y) * size;\n\
+		sphereCenter = center;\n\
+		sphereRadius = radius;\n\
+		vertexMaterial = instanceMaterial;\n\
+		gl_Position = projectionMatrix * vec4(viewPosition,1.0);\n\
+	}";
+
+static const char* sphereFragmentShader =
+	"in vec3 viewPosition;\n\
+	flat in vec3 sphereCenter;\n\
+	flat in float sphereRadius;\n\
+	flat in uint vertexMaterial;\n\
+	void main(){\n\
+		vec3 rayDirection = normalize(viewPosition);\n\
+		float b = dot(rayDirection,sphereCenter);\n\
+		float c = dot(sphereCenter,sphereCenter) - sphereRadius * sphereRadius;\n\
+		float discriminant = b * b - c;\n\
+		if(discriminant < 0.0) discard;\n\
+		vec3 hit = rayDirection * (b - sqrt(discriminant));\n\
+		writeDepth(hit);\n\
+		vec4 normal = vec4((hit - sphereCenter) / sphereRadius,0.0);\n\
+		outputColor = shade(vec4(hit,1.0),normal,materials[vertexMaterial]);\n\
+	}";
+
+//unit cube stretched into the box that encloses the cylinder
+static const char* cylinderVertexShader =
+	"#version 410\n\
+	in vec3 position;\n\
+	in vec4 instancePosition;\n\
+	in vec3 instanceEnd;\n\
+	in vec3 instanceOffset;\n\
+	in uint instanceMaterial;\n\
+	in uint instanceEndMaterial;\n\
+	out vec3 viewPosition;\n\
+	flat out vec3 cylinderStart;\n\
+	flat out vec3 cylinderAxis;\n\
+	flat out float cylinderLength;\n\
+	flat out float cylinderRadius;\n\
+	flat out uint startMaterial;\n\
+	flat out uint endMaterial;\n\
+	layout(std140) uniform globalMatrices{\n\
+		mat4 worldMatrix;\n\
+		mat4 projectionMatrix;\n\
+	};\n\
+	void main(){\n\
+		vec4 startModel = vec4(instancePosition.xyz + instanceOffset,1.0);\n\
+		vec4 endModel = vec4(instanceEnd + instanceOffset,1.0);\n\
+		float radius = instancePosition.w;\n\
+		#ifdef MULTI_DRAW\n\
+		DrawData draw = draws[firstDraw + gl_DrawIDARB];\n\
+		startModel = draw.modelMatrix * startModel;\n\
+		endModel = draw.modelMatrix * endModel;\n\
+		radius *= draw.scale;\n\
+		#endif\n\
+		vec3 start = (worldMatrix * startModel).xyz;\n\
+		vec3 end = (worldMatrix * endModel).xyz;\n\
+		float len = max(length(end - start),0.0001);\n\
+		vec3 axis = (end - start) / len;\n\
+		vec3 u = normalize(cross(axis, abs(axis.x) > 0.9 ? vec3(0.0,1.0,0.0) : vec3(1.0,0.0,0.0)));\n\
+		vec3 v = cross(axis,u);\n\
+		vec3 center = (start + end) * 0.5;\n\
+		viewPosition = center + axis * (position.z * len * 0.5) + (u * position.x + v * position.y) * radius;\n\
+		cylinderStart = start;\n\
+		cylinderAxis = axis;\n\
+		cylinderLength = len;\n\
+		cylinderRadius = radius;\n\
+		startMaterial = instanceMaterial;\n\
+		endMaterial = instanceEndMaterial;\n\
+		gl_Position = projectionMatrix * vec4(viewPosition,1.0);\n\
+	}";
+
+//closest hit between the side and the two flat caps, each half of the
+//cylinder takes the material of the atom at its end
+static const char* cylinderFragmentShader =
+	"in vec3 viewPosition;\n\
+	flat in vec3 cylinderStart;\n\
+	flat in vec3 cylinderAxis;\n\
+	flat in float cylinderLength;\n\
+	flat in float cylinderRadius;\n\
+	flat in uint startMaterial;\n\
+	flat in uint endMaterial;\n\
+	void main(){\n\
+		vec3 rayDirection = normalize(viewPosition);\n\
+		vec3 origin = -cylinderStart;\n\
+		float dirAxis = dot(rayDirection,cylinderAxis);\n\
+		float originAxis = dot(origin,cylinderAxis);\n\
+		vec3 dirRadial = rayDirection - dirAxis * cylinderAxis;\n\
+		vec3 originRadial = origin - originAxis * cylinderAxis;\n\
+		float radius2 = cylinderRadius * cylinderRadius;\n\
+		float tHit = 1e20;\n\
+		vec3 normal = vec3(0.0);\n\
+		float a = dot(dirRadial,dirRadial);\n\
+		if(a > 1e-8){\n\
+			float b = dot(dirRadial,originRadial);\n\
+			float c = dot(originRadial,originRadial) - radius2;\n\
+			float discriminant = b * b - a * c;\n\
+			if(discriminant >= 0.0){\n\
+				float t = (-b - sqrt(discriminant)) / a;\n\
+				float h = originAxis + t * dirAxis;\n\
+				if(t > 0.0 && h >= 0.0 && h <= cylinderLength){\n\
+					tHit = t;\n\
+					normal = (originRadial + t * dirRadial) / cylinderRadius;\n\
+				}\n\
+			}\n\
+		}\n\
+		if(abs(dirAxis) > 1e-6){\n\
+			for(int i = 0; i < 2; i++){\n\
+				float cap = i == 0 ? 0.0 : cylinderLength;\n\
+				float t = (cap - originAxis) / dirAxis;\n\
+				vec3 radial = originRadial + t * dirRadial;\n\
+				if(t > 0.0 && t < tHit && dot(radial,radial) <= radius2){\n\
+					tHit = t;\n\
+					normal = i == 0 ? -cylinderAxis : cylinderAxis;\n\
+				}\n\
+			}\n\
+		}\n\
+		if(tHit == 1e20) discard;\n\
+		vec3 hit = rayDirection * tHit;\n\
+		writeDepth(hit);\n\
+		float h = originAxis + tHit * dirAxis;\n\
+		uint material = h < cylinderLength * 0.5 ? startMaterial : endMaterial;\n\
+		outputColor = shade(vec4(hit,1.0),vec4(normal,0.0),materials[material]);\n\
+	}";
+
+ImpostorMaterial::ImpostorMaterial(ImpostorShape shape, bool multiDraw):Material(){
+	this->type = IMPOSTOR_MATERIAL;
+	this->shape = shape;
+	this->multiDraw = multiDraw;
+	this->multiDrawMaterial = NULL;
+	string fragmentSource(impostorLighting);
+	if(shape == SPHERE_IMPOSTOR){
+		this->vertexShaderSource = strdup(sphereVertexShader);
+		fragmentSource += sphereFragmentShader;
+	}
+	else{
+		this->vertexShaderSource = strdup(cylinderVertexShader);
+		fragmentSource += cylinderFragmentShader;
+	}
+	this->fragmentShaderSource = strdup(fragmentSource.c_str());
+	if(multiDraw){
+		Material::makeMultiDrawSources(&(this->vertexShaderSource),&(this->fragmentShaderSource));
+	}
+	this->program = ProgramCache::getInstance()->getProgram(this->vertexShaderSource,this->fragmentShaderSource);
+}
+
+ImpostorMaterial::~ImpostorMaterial(){
+	if(this->multiDrawMaterial != NULL){
+		delete this->multiDrawMaterial;
+	}
+}
+
+ImpostorShape ImpostorMaterial::getShape(){
+	return this->shape;
+}
+
+Material* ImpostorMaterial::getMultiDrawMaterial(){
+	if(this->multiDraw) return this;
+	if(this->multiDrawMaterial == NULL){
+		this->multiDrawMaterial = new ImpostorMaterial(this->shape,true);
+	}
+	return this->multiDrawMaterial;
+}
@@ -0,0 +1,209 @@
+#include "material/InstancedMaterial.h"
+#include <string.h>
+#include <cassert>
+#include <stdio.h>
+
+//spheres are the geometry scaled by the radius around the instance center
+static const char* sphereVertexShader =
+	"#version 410\n\
+	in vec3 normal;\n\
+	in vec3 position;\n\
+	in vec4 instancePosition;\n\
+	in uint instanceMaterial;\n\
+	out vec4 vertexNormal;\n\
+	out vec4 worldSpacePosition;\n\
+	flat out uint startMaterial;\n\
+	flat out uint endMaterial;\n\
+	out float axialPosition;\n\
+	layout(std140) uniform globalMatrices{\n\
+		mat4 worldMatrix;\n\
+		mat4 projectionMatrix;\n\
+	};\n\
+	void main(){\n\
+		vec4 instance = instancePosition;\n\
+		#ifdef MULTI_DRAW\n\
+		DrawData draw = draws[firstDraw + gl_DrawIDARB];\n\
+		instance = vec4((draw.modelMatrix * vec4(instance.xyz,1.0)).xyz,instance.w * draw.scale);\n\
+		#endif\n\
+		vec4 modelSpace = vec4(instance.xyz + position * instance.w,1.0);\n\
+		vec4 worldSpace = worldMatrix * modelSpace;\n\
+		gl_Position = projectionMatrix * worldSpace;\n\
+		worldSpacePosition = worldSpace;\n\
+		vertexNormal = normalize(worldMatrix * vec4(normal,0.0));\n\
+		startMaterial = instanceMaterial;\n\
+		endMaterial = instanceMaterial;\n\
+		axialPosition = 0.0;\n\
+	}";
+
+//a unit cylinder along z (radius 1, z in [-1,1]) is stretched between the
+//shifted endpoints, each half takes the material of the atom at its end
+static const char* cylinderVertexShader =
+	"#version 410\n\
+	in vec3 normal;\n\
+	in vec3 position;\n\
+	in vec4 instancePosition;\n\
+	in vec3 instanceEnd;\n\
+	in vec3 instanceOffset;\n\
+	in uint instanceMaterial;\n\
+	in uint instanceEndMaterial;\n\
+	out vec4 vertexNormal;\n\
+	out vec4 worldSpacePosition;\n\
+	flat out uint startMaterial;\n\
+	flat out uint endMaterial;\n\
+	out float axialPosition;\n\
+	layout(std140) uniform globalMatrices{\n\
+		mat4 worldMatrix;\n\
+		mat4 projectionMatrix;\n\
+	};\n\
+	void main(){\n\
+		vec3 start = instancePosition.xyz + instanceOffset;\n\
+		vec3 end = instanceEnd + instanceOffset;\n\
+		float radius = instancePosition.w;\n\
+		#ifdef MULTI_DRAW\n\
+		DrawData draw = draws[firstDraw + gl_DrawIDARB];\n\
+		start = (draw.modelMatrix * vec4(start,1.0)).xyz;\n\
+		end = (draw.modelMatrix * vec4(end,1.0)).xyz;\n\
+		radius *= draw.scale;\n\
+		#endif\n\
+		float len = max(length(end - start),0.0001);\n\
+		vec3 axis = (end - start) / len;\n\
+		vec3 u = normalize(cross(axis, abs(axis.x) > 0.9 ? vec3(0.0,1.0,0.0) : vec3(1.0,0.0,0.0)));\n\
+		vec3 v = cross(axis,u);\n\
+		vec3 center = (start + end) * 0.5;\n\
+		vec4 modelSpace = vec4(center + axis * (position.z * len * 0.5) + (u * position.x + v * position.y) * radius,1.0);\n\
+		vec4 worldSpace = worldMatrix * modelSpace;\n\
+		gl_Position = projectionMatrix * worldSpace;\n\
+		worldSpacePosition = worldSpace;\n\
+		vertexNormal = normalize(worldMatrix * vec4(u * normal.x + v * normal.y + axis * normal.z,0.0));\n\
+		startMaterial = instanceMaterial;\n\
+		endMaterial = instanceEndMaterial;\n\
+		axialPosition = position.z;\n\
+	}";
+
+//phong shading for geometry drawn with glDrawElementsInstanced, every instance
+//carries its world placement so no model matrix is needed, and the rows of
+//its materials in the material table so any mix of elements is one draw
+//the multi draw variant reads instances in local space and moves them by the
+//model matrix of each indirect draw
+InstancedMaterial::InstancedMaterial(InstanceType instanceType, bool multiDraw):Material(){
+	this->type = INSTANCED_MATERIAL;
+	this->instanceType = instanceType;
+	this->multiDraw = multiDraw;
+	this->multiDrawMaterial = NULL;
+	this->vertexShaderSource = strdup(instanceType == SPHERE_INSTANCE ? sphereVertexShader : cylinderVertexShader);
+    this->fragmentShaderSource=strdup(
+    	"#version 410\n\
+    	#define MAX_DIR_LIGHTS 10\n\
+		#define MAX_P_LIGHTS 10\n\
+		#define MAX_MATERIALS 256\n\
+		struct DirectionalLight{\n\
+			vec4 color;\n\
+			vec4 vectorToLight;\n\
+			float intensity;\n\
+		};\n\
+		\n\
+		struct PointLight{\n\
+			vec4 color;\n\
+			vec4 position;\n\
+			float intensity;\n\
+			float attenuation;\n\
+		};\n\
+		\n\
+		struct Material{\n\
+			vec4 diffuseColor;\n\
+			vec4 specularColor;\n\
+			float shininess;\n\
+		};\n\
+		\n\
+		layout(std140) uniform directionalLights{\n\
+			DirectionalLight dirLights[MAX_DIR_LIGHTS];\n\
+			int numDirLights;\n\
+		};\n\
+		layout(std140) uniform pointLights{\n\
+			PointLight pLights[MAX_P_LIGHTS];\n\
+			int numPointLights;\n\
+		};\n\
+		layout(std140) uniform ambLight{\n\
+			vec4 ambientLight;\n\
+		};\n\
+		\n\
+		layout(std140) uniform materialTable{\n\
+			Material materials[MAX_MATERIALS];\n\
+		};\n\
+    	in vec4 vertexNormal;\n\
+		in vec4 worldSpacePosition;\n\
+		flat in uint startMaterial;\n\
+		flat in uint endMaterial;\n\
+		in float axialPosition;\n\
+    	out vec4 outputColor;\n\
+    	vec4 attenuateLight(in vec4 color, in float attenuation, in vec4 vectorToLight){\n\
+			float distSqr = dot(vectorToLight,vectorToLight);\n\
+			vec4 attenLightIntensity = color * (1/(1.0 + attenuation * sqrt(distSqr)));\n\
+			return attenLightIntensity;\n\
+    	}\n\
+    	\n\
+    	float warp (in float value,in float factor){\n\
+    		return (value + factor ) / (1+ clamp(factor,0,1));\n\
+    	}\n\
+    	float calculateBlinnPhongTerm(in vec4 direction,vec4 normal, in vec4 viewDirection, in float shininess, out float cosAngIncidence){\n\
+    		cosAngIncidence = dot( normal , direction);\n\
+    		cosAngIncidence = warp(cosAngIncidence,1);\n\
+            cosAngIncidence = clamp(cosAngIncidence, 0, 1);\n\
+            vec4 halfAngle = normalize(direction + viewDirection);\n\
+			float blinnPhongTerm = dot(normal, halfAngle);\n\
+			blinnPhongTerm = clamp(blinnPhongTerm, 0, 1);\n\
+			blinnPhongTerm = cosAngIncidence != 0.0 ? blinnPhongTerm : 0.0;\n\
+			blinnPhongTerm = pow(blinnPhongTerm, shininess);\n\
+			return blinnPhongTerm;\n\
+    	}\n\
+    	\n\
+    	void main(){\n\
+    		Material material = materials[axialPosition < 0.0 ? startMaterial : endMaterial];\n\
+    		vec4 vertexColor = material.diffuseColor;\n\
+    		vec4 viewDirection = normalize(-worldSpacePosition);\n\
+			outputColor = vec4(0.0,0.0,0.0,1.0);\n\
+			for(int i=0; i< numDirLights ;i++){\n\
+				vec4 normDirection = normalize(dirLights[i].vectorToLight);\n\
+				vec4 normal = normalize(vertexNormal);\n\
+				float cosAngIncidence;\n\
+				float blinnPhongTerm = calculateBlinnPhongTerm(normDirection,normal,viewDirection,material.shininess,cosAngIncidence);\n\
+				\n\
+            	outputColor = outputColor + (dirLights[i].color * vertexColor * cosAngIncidence);\n\
+            	outputColor = outputColor + (material.specularColor * blinnPhongTerm);\n\
+			}\n\
+			for(int i=0; i< numPointLights ;i++){\n\
+				vec4 difference = pLights[i].position - worldSpacePosition;\n\
+				vec4 normDirection = normalize(difference);\n\
+				vec4 attenLightIntensity = attenuateLight(pLights[i].color,pLights[i].attenuation,difference);\n\
+				vec4 normal = normalize(vertexNormal);\n\
+				float cosAngIncidence;\n\
+				float blinnPhongTerm = calculateBlinnPhongTerm(normDirection,normal,viewDirection,material.shininess,cosAngIncidence);\n\
+				\n\
+            	outputColor = outputColor + (attenLightIntensity * vertexColor * cosAngIncidence);\n\
+            	outputColor = outputColor + (material.specularColor * attenLightIntensity * blinnPhongTerm);\n\
+			}\n\
+            outputColor = outputColor + (vertexColor * ambientLight);\n\
+    	}");
+	if(multiDraw){
+		Material::makeMultiDrawSources(&(this->vertexShaderSource),&(this->fragmentShaderSource));
+	}
+	this->program = ProgramCache::getInstance()->getProgram(this->vertexShaderSource,this->fragmentShaderSource);
+}
+
+InstancedMaterial::~InstancedMaterial(){
+	if(this->multiDrawMaterial != NULL){
+		delete this->multiDrawMaterial;
+	}
+}
+
+InstanceType InstancedMaterial::getInstanceType(){
+	return this->instanceType;
+}
+
+Material* InstancedMaterial::getMultiDrawMaterial(){
+	if(this->multiDraw) return this;
+	if(this->multiDrawMaterial == NULL){
+		this->multiDrawMaterial = new InstancedMaterial(this->instanceType,true);
+	}
+	return this->multiDrawMaterial;
+}
\ No newline at end of file
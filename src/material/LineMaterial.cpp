@@ -36,19 +36,5 @@ LineMaterial::LineMaterial():Material(){
         void main(){\n\
             outputColor = color;\n\
         }");
-	this->program = new GLProgram();
-	GLuint vertexShader = this->program->compileShader(GL_VERTEX_SHADER,this->vertexShaderSource);
-	GLuint fragmentShader = this->program->compileShader(GL_FRAGMENT_SHADER,this->fragmentShaderSource);
-	this->program->setVertexShader(vertexShader);
-	this->program->setFragmentShader(fragmentShader);
-	GLuint prog = this->program->linkProgram(vertexShader,fragmentShader);
-	this->program->setProgram(prog);
-	this->program->setAttrPosition(glGetAttribLocation(prog, "position"));
-	this->program->setAttrNormal(glGetAttribLocation(prog, "normal"));
-	this->program->getUniforms()->unifModelMatrix = glGetUniformLocation(prog,"modelMatrix");
-	this->program->getUniforms()->unifDiffuseColor = glGetUniformLocation(prog,"material.diffuseColor");
-	this->program->getUniforms()->unifSpecularColor = glGetUniformLocation(prog,"material.specularColor");
-	this->program->getUniforms()->unifShininess = glGetUniformLocation(prog,"material.shininess");
-	this->program->getUniforms()->unifBlockMatrices = glGetUniformBlockIndex(prog,"globalMatrices");
-	glUniformBlockBinding(prog, this->program->getUniforms()->unifBlockMatrices,0);
+	this->program = ProgramCache::getInstance()->getProgram(this->vertexShaderSource,this->fragmentShaderSource);
 }
\ No newline at end of file
@@ -1,11 +1,44 @@
 #include "material/Material.h"
 #include <cstdlib>
 #include <string.h>
+#include <string>
+using namespace std;
+
+//replaces the version line of multi draw variants, the draw id of the
+//indirect command finds the model matrix of every draw
+static const char* multiDrawVertexHeader =
+	"#version 430\n\
+	#extension GL_ARB_shader_draw_parameters : require\n\
+	#define MULTI_DRAW\n\
+	struct DrawData{\n\
+		mat4 modelMatrix;\n\
+		float scale;\n\
+	};\n\
+	layout(std430, binding = 0) readonly buffer drawBlock{\n\
+		DrawData draws[];\n\
+	};\n\
+	uniform int firstDraw;\n";
+
+//materials come from the material table like in the single draw variant
+static const char* multiDrawFragmentHeader =
+	"#version 430\n\
+	#define MULTI_DRAW\n";
+
+static GLchar* replaceVersion(GLchar* source, const char* header){
+	string result(header);
+	const char* body = strchr(source,'\n');
+	result += body != NULL ? body + 1 : source;
+	free(source);
+	return strdup(result.c_str());
+}
 
 Material::Material(){
 	this->diffuseColor = new Color();
 	this->specularColor = new Color();
 	this->shininess = 1;
+	this->version = 0;
+	this->diffuseVersion = 0;
+	this->specularVersion = 0;
 	this->vertexShaderSource = NULL;
 	this->fragmentShaderSource = NULL;
 	this->program = NULL;
@@ -22,6 +55,8 @@ void Material::setProgram(GLProgram* program){
 
 void Material::setDiffuseColor(Color* color){
 	this->diffuseColor = color;
+	this->diffuseVersion = color->getVersion();
+	this->version++;
 }
 
 Color* Material::getDiffuseColor(){
@@ -46,6 +81,8 @@ void Material::setFragmentShaderSource(char * fragmentShaderSource){
 
 void Material::setSpecularColor(Color* color){
 	this->specularColor = color;
+	this->specularVersion = color->getVersion();
+	this->version++;
 }
 
 Color* Material::getSpecularColor(){
@@ -54,22 +91,28 @@ Color* Material::getSpecularColor(){
 
 void Material::setShininess(GLfloat shininess){
 	this->shininess = shininess;
+	this->version++;
 }
 
 GLfloat Material::getShininess(){
 	return this->shininess;
 }
 
-MaterialStruct Material::getAsStruct(){
-	MaterialStruct material = new struct materialStruct;
-	GLfloat * diffuseColor = this->getDiffuseColor()->getAsArray();
-	memcpy(&(material->diffuseColor),diffuseColor,sizeof(GLfloat)*4);
-	delete diffuseColor;
-	GLfloat * specularColor = this->getSpecularColor()->getAsArray();
-	memcpy(&(material->specularColor),specularColor,sizeof(GLfloat)*4);
-	delete specularColor;
+void Material::getAsStruct(MaterialStruct material){
+	memset(material,0,sizeof(struct materialStruct));
+	this->getDiffuseColor()->getAsArray(material->diffuseColor);
+	this->getSpecularColor()->getAsArray(material->specularColor);
 	material->shininess = this->shininess;
-	return material;
+}
+
+//changes with the shininess, a new color or an edit of either color
+unsigned int Material::getVersion(){
+	if(this->diffuseColor->getVersion() != this->diffuseVersion || this->specularColor->getVersion() != this->specularVersion){
+		this->diffuseVersion = this->diffuseColor->getVersion();
+		this->specularVersion = this->specularColor->getVersion();
+		this->version++;
+	}
+	return this->version;
 }
 
 
@@ -86,11 +129,21 @@ Material::~Material(){
 	if(this->fragmentShaderSource != NULL){
 		delete this->fragmentShaderSource;
 	}
-	if(this->program != NULL){
-		delete this->program;
-	}	
+	ProgramCache::getInstance()->releaseProgram(this->program);
 }
 
 MaterialType Material::getType(){
 	return this->type;
 }
+
+//sources must start with their version line
+void Material::makeMultiDrawSources(GLchar** vertexSource, GLchar** fragmentSource){
+	*vertexSource = replaceVersion(*vertexSource,multiDrawVertexHeader);
+	*fragmentSource = replaceVersion(*fragmentSource,multiDrawFragmentHeader);
+}
+
+//materials that can be drawn through glMultiDrawElementsIndirect return the
+//variant that reads its per draw state from buffers
+Material* Material::getMultiDrawMaterial(){
+	return NULL;
+}
@@ -0,0 +1,54 @@
+#include "material/MaterialTable.h"
+#include <cstdio>
+
+MaterialTable* MaterialTable::instance = NULL;
+
+MaterialTable::MaterialTable(){
+	this->version = 0;
+}
+
+MaterialTable* MaterialTable::getInstance(){
+	if(MaterialTable::instance == NULL){
+		MaterialTable::instance = new MaterialTable();
+	}
+	return MaterialTable::instance;
+}
+
+//the row of the material, added at the end the first time. a full table
+//gives row 0 so instances still draw, with the wrong colors
+int MaterialTable::addMaterial(Material* material){
+	for(unsigned int i = 0; i < this->materials.size(); i++){
+		if(this->materials[i] == material) return i;
+	}
+	if(this->materials.size() >= MATERIAL_TABLE_SIZE){
+		fprintf(stderr,"material table full, %d rows\n",MATERIAL_TABLE_SIZE);
+		return 0;
+	}
+	this->materials.push_back(material);
+	this->version++;
+	return this->materials.size() - 1;
+}
+
+Material* MaterialTable::getMaterial(int index){
+	return this->materials[index];
+}
+
+int MaterialTable::getNumMaterials(){
+	return this->materials.size();
+}
+
+//versions only grow, so the sum changes whenever a row is added or edited
+unsigned int MaterialTable::getVersion(){
+	unsigned int version = this->version;
+	for(unsigned int i = 0; i < this->materials.size(); i++){
+		version += this->materials[i]->getVersion();
+	}
+	return version;
+}
+
+//rows must have room for every material in the table
+void MaterialTable::write(MaterialStruct rows){
+	for(unsigned int i = 0; i < this->materials.size(); i++){
+		this->materials[i]->getAsStruct(&(rows[i]));
+	}
+}
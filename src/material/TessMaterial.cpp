@@ -166,30 +166,6 @@ TessMaterial::TessMaterial():Material(){
 			}\n\
             outputColor = outputColor + (material.diffuseColor * ambientLight);\n\
     	}");
-	this->program = new GLProgram();
-	GLuint vertexShader = this->program->compileShader(GL_VERTEX_SHADER,this->vertexShaderSource);
-	GLuint fragmentShader = this->program->compileShader(GL_FRAGMENT_SHADER,this->fragmentShaderSource);
-	GLuint tessControlShader = this->program->compileShader(GL_TESS_CONTROL_SHADER,this->tessControlShaderSource);
-	GLuint tessEvaluationShader = this->program->compileShader(GL_TESS_EVALUATION_SHADER,this->tessEvaluationShaderSource);
-	this->program->setVertexShader(vertexShader);
-	this->program->setFragmentShader(fragmentShader);
-	this->program->setTessControlShader(tessControlShader);
-	this->program->setTessEvaluationShader(tessEvaluationShader);
-	GLuint prog = this->program->linkProgramTessellation(vertexShader,fragmentShader,tessControlShader,tessEvaluationShader);
-	this->program->setProgram(prog);
-	this->program->setAttrPosition(glGetAttribLocation(prog, "position"));
-	this->program->setAttrNormal(glGetAttribLocation(prog, "normal"));
-	this->program->getUniforms()->unifModelMatrix = glGetUniformLocation(prog,"modelMatrix");
-	this->program->getUniforms()->unifDiffuseColor = glGetUniformLocation(prog,"material.diffuseColor");
-	this->program->getUniforms()->unifSpecularColor = glGetUniformLocation(prog,"material.specularColor");
-	this->program->getUniforms()->unifShininess = glGetUniformLocation(prog,"material.shininess");
-	this->program->getUniforms()->unifDistanceToCamera = glGetUniformLocation(prog,"distanceToCamera");
-	this->program->getUniforms()->unifBlockMatrices = glGetUniformBlockIndex(prog,"globalMatrices");
-	glUniformBlockBinding(prog, this->program->getUniforms()->unifBlockMatrices,0);
-	this->program->getUniforms()->unifBlockDirectionalLights = glGetUniformBlockIndex(prog,"directionalLights");
-	glUniformBlockBinding(prog, this->program->getUniforms()->unifBlockDirectionalLights,1);
-	this->program->getUniforms()->unifBlockAmbientLight = glGetUniformBlockIndex(prog,"ambLight");
-	glUniformBlockBinding(prog, this->program->getUniforms()->unifBlockAmbientLight,2);
-	this->program->getUniforms()->unifBlockPointLights = glGetUniformBlockIndex(prog,"pointLights");
-	glUniformBlockBinding(prog, this->program->getUniforms()->unifBlockPointLights,3);
+	this->program = ProgramCache::getInstance()->getTessellationProgram(this->vertexShaderSource,this->fragmentShaderSource,
+	                                                                        this->tessControlShaderSource,this->tessEvaluationShaderSource);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@ Color::Color(){
 	this->g = 1.0;
 	this->b = 1.0;
 	this->a = 1.0;
+	this->version = 0;
 }
 
 Color::Color(GLfloat r, GLfloat g, GLfloat b){
@@ -12,6 +13,7 @@ Color::Color(GLfloat r, GLfloat g, GLfloat b){
 	this->g = g;
 	this->b = b;
 	this->a = 1.0;
+	this->version = 0;
 }
 
 
@@ -19,12 +21,14 @@ void Color::setRGB255(GLint r, GLint g, GLint b){
 	this->r = r/255.0;
 	this->g = g/255.0;
 	this->b = b/255.0;
+	this->version++;
 }
 
 void Color::setRGB(GLfloat r, GLfloat g, GLfloat b){
 	this->r = r;
 	this->g = g;
 	this->b = b;
+	this->version++;
 }
 
 void Color::setComponent(char component, GLfloat value){
@@ -39,23 +43,22 @@ void Color::setComponent(char component, GLfloat value){
 			this->b = value;
 			break; 
 	}
-
+	this->version++;
 }
 
 void Color::addColor(Color * color){
 	this->r += color->r;
 	this->g += color->g;
 	this->b += color->b;
+	this->version++;
 }
 
-GLfloat* Color::getAsArray(){
-	GLfloat * col = new GLfloat[4];
-	col[0] = this->r;
-	col[1] = this->g;
-	col[2] = this->b;
-	col[3] = this->a;
-
-	return col;
+//array must hold 4 floats
+void Color::getAsArray(GLfloat* array){
+	array[0] = this->r;
+	array[1] = this->g;
+	array[2] = this->b;
+	array[3] = this->a;
 }
 
 GLfloat Color::getComponent(char component){
@@ -69,3 +72,7 @@ GLfloat Color::getComponent(char component){
 	}
 	return (GLfloat)NULL;
 }
+
+unsigned int Color::getVersion(){
+	return this->version;
+}
@@ -8,11 +8,19 @@ GLfloat clamp(GLfloat num){
 	return fmin(fmax(num,-1.0),1.0);
 }
 
+//rotation orders are always three axis letters, kept inline so setting
+//them from the quaternion on every update does not allocate
+static void copyOrder(char* dest, const char* order){
+	if(dest == order) return;
+	strncpy(dest,order,3);
+	dest[3] = '\0';
+}
+
 Euler::Euler(GLfloat x, GLfloat y, GLfloat z,const char * order){
 	this->x = x;
 	this->y = y;
 	this->z = z;
-	this->order = strdup(order);
+	copyOrder(this->order,order);
 	this->quaternion = NULL;
 }
 
@@ -20,7 +28,7 @@ Euler::Euler(GLfloat x, GLfloat y, GLfloat z){
 	this->x = x;
 	this->y = y;
 	this->z = z;
-	this->order = strdup("XYZ");
+	copyOrder(this->order,"XYZ");
 	this->quaternion = NULL;
 }
 
@@ -28,19 +36,15 @@ Euler::Euler(const Euler& euler){
 	this->x =  euler.x;
 	this->y = euler.y;
 	this->z = euler.z;
-	this->order = strdup(euler.order);
+	copyOrder(this->order,euler.order);
 	this->quaternion = euler.quaternion;
 }
 
-Euler::~Euler(){
-	delete[] this->order;
-}
-
-char* Euler::getOrder(){
+const char* Euler::getOrder() const{
 	return this->order;
 }
 
-GLfloat Euler::getX(){
+GLfloat Euler::getX() const{
 	return this->x;
 }
 void Euler::setX(GLfloat x){
@@ -48,7 +52,7 @@ void Euler::setX(GLfloat x){
 	if(this->quaternion!=NULL)
 		this->quaternion->setFromEuler(this,false);
 }
-GLfloat Euler::getY(){
+GLfloat Euler::getY() const{
 	return this->y;
 }
 void Euler::setY(GLfloat y){
@@ -56,7 +60,7 @@ void Euler::setY(GLfloat y){
 	if(this->quaternion!=NULL)
 		this->quaternion->setFromEuler(this,false);
 }
-GLfloat Euler::getZ(){
+GLfloat Euler::getZ() const{
 	return this->z;
 }
 void Euler::setZ(GLfloat z){
@@ -106,8 +110,7 @@ void Euler::setFromQuaternion(Quaternion* q, const char* order, bool update){
 		//incorrect order
 		return;
 	}
-	delete this->order;
-	this->order = strdup(order);
+	copyOrder(this->order,order);
 
 	update ? this->quaternion->setFromEuler(this,false) : (void)NULL;
 }
\ No newline at end of file
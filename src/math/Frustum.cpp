@@ -0,0 +1,72 @@
+#include "math/Frustum.h"
+#include <cmath>
+
+Frustum::Frustum(){
+	for(int i = 0; i < 6; i++){
+		for(int j = 0; j < 4; j++){
+			this->planes[i][j] = 0;
+		}
+		for(int j = 0; j < 3; j++){
+			this->absNormals[i][j] = 0;
+		}
+	}
+}
+
+//clip space x,y,z within [-w,w]: each plane is the last row plus or minus
+//one of the others (left, right, bottom, top, near, far)
+void Frustum::setFromMatrix(const Mat4& viewProjection){
+	const GLfloat* m = viewProjection.getElements();
+	for(int i = 0; i < 6; i++){
+		int row = i / 2;
+		GLfloat sign = (i & 1) ? -1 : 1;
+		GLfloat length = 0;
+		for(int j = 0; j < 4; j++){
+			this->planes[i][j] = m[12 + j] + sign * m[row*4 + j];
+		}
+		length = sqrt(this->planes[i][0] * this->planes[i][0] +
+		              this->planes[i][1] * this->planes[i][1] +
+		              this->planes[i][2] * this->planes[i][2]);
+		if(length > 0){
+			for(int j = 0; j < 4; j++){
+				this->planes[i][j] /= length;
+			}
+		}
+		for(int j = 0; j < 3; j++){
+			this->absNormals[i][j] = fabs(this->planes[i][j]);
+		}
+	}
+}
+
+const GLfloat* Frustum::getPlane(int index) const{
+	return this->planes[index];
+}
+
+//returns FRUSTUM_OUTSIDE or the planes of mask the box still crosses,
+//0 means the box is completely inside and its contents need no more tests
+int Frustum::classifyBox(const GLfloat* center, const GLfloat* halfSize, int mask) const{
+	int result = mask;
+	for(int i = 0; i < 6; i++){
+		if(!(mask & (1 << i))) continue;
+		const GLfloat* plane = this->planes[i];
+		const GLfloat* absNormal = this->absNormals[i];
+		GLfloat distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+		GLfloat radius = absNormal[0] * halfSize[0] + absNormal[1] * halfSize[1] + absNormal[2] * halfSize[2];
+		if(distance + radius < 0) return FRUSTUM_OUTSIDE;
+		if(distance - radius >= 0) result &= ~(1 << i);
+	}
+	return result;
+}
+
+int Frustum::classifyBounds(const GLfloat* min, const GLfloat* max, int mask) const{
+	GLfloat center[3];
+	GLfloat halfSize[3];
+	for(int i = 0; i < 3; i++){
+		center[i] = (min[i] + max[i]) * 0.5;
+		halfSize[i] = (max[i] - min[i]) * 0.5;
+	}
+	return this->classifyBox(center,halfSize,mask);
+}
+
+bool Frustum::intersectsBounds(const GLfloat* min, const GLfloat* max) const{
+	return this->classifyBounds(min,max) != FRUSTUM_OUTSIDE;
+}
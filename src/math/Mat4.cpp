@@ -1,14 +1,17 @@
 #include <math.h>
+#include <string.h>
 #include "math/Quaternion.h"
 #include "math/Vec3.h"
 #include "math/Mat4.h"
 
 
-void Mat4::setElements(GLfloat* elements){
-	this->elements = elements;
+Mat4::Mat4(){
+	for(int i=0; i <16;i++){
+		this->elements[i] = (i % 5 == 0) ? 1 : 0;
+	}
 }
+
 Mat4::Mat4(GLfloat value){
-	this->elements = new GLfloat[16];
 	for(int i=0; i <16;i++){
 		this->elements[i] = value;
 	}
@@ -18,48 +21,43 @@ GLfloat * Mat4::getElements(){
 	return this->elements;
 }
 
-Mat4::~Mat4(){
-	if(this->getElements() != NULL)
-		delete[] (this->getElements());
+const GLfloat * Mat4::getElements() const{
+	return this->elements;
 }
 
-Mat4 * Mat4::identityMatrix(){
-	Mat4 * mat = new Mat4(0);
-	mat->getElements()[0] =1;
-	mat->getElements()[5] =1;
-	mat->getElements()[10] =1;
-	mat->getElements()[15] =1;
-	return mat;
+Mat4 Mat4::identityMatrix(){
+	return Mat4();
 }
 
-Mat4 * Mat4::translationMatrix(GLfloat x, GLfloat y , GLfloat z){
-	Mat4 * mat = Mat4::identityMatrix();
-	mat->getElements()[3] =x;
-	mat->getElements()[7] =y;
-	mat->getElements()[11]=z;
+Mat4 Mat4::translationMatrix(GLfloat x, GLfloat y , GLfloat z){
+	Mat4 mat;
+	mat.elements[3] =x;
+	mat.elements[7] =y;
+	mat.elements[11]=z;
 	return mat;
 }
 
-Mat4 * Mat4::rotationMatrixFromQuaternion(Quaternion* q){
-	Mat4 * mat = Mat4::identityMatrix();
-	q->normalize();
-	mat->getElements()[0] = 1-(2*q->getY()*q->getY())-(2*q->getZ()*q->getZ());
-	mat->getElements()[1] = (2*q->getX()*q->getY())-(2*q->getW()*q->getZ());
-	mat->getElements()[2] = (2*q->getX()*q->getZ())+(2*q->getW()*q->getY());
-	mat->getElements()[4] = (2*q->getX()*q->getY())+(2*q->getW()*q->getZ());
-	mat->getElements()[5] = 1-(2*q->getX()*q->getX())-(2*q->getZ()*q->getZ());
-	mat->getElements()[6] = (2*q->getY()*q->getZ())-(2*q->getW()*q->getX());
-	mat->getElements()[8] = (2*q->getX()*q->getZ())-(2*q->getW()*q->getY());
-	mat->getElements()[9] = (2*q->getY()*q->getZ())+(2*q->getW()*q->getX());
-	mat->getElements()[10] = 1-(2*q->getX()*q->getX())-(2*q->getY()*q->getY());
+//takes the quaternion by value so normalizing it does not touch the caller's
+Mat4 Mat4::rotationMatrixFromQuaternion(Quaternion q){
+	Mat4 mat;
+	q.normalize();
+	mat.elements[0] = 1-(2*q.getY()*q.getY())-(2*q.getZ()*q.getZ());
+	mat.elements[1] = (2*q.getX()*q.getY())-(2*q.getW()*q.getZ());
+	mat.elements[2] = (2*q.getX()*q.getZ())+(2*q.getW()*q.getY());
+	mat.elements[4] = (2*q.getX()*q.getY())+(2*q.getW()*q.getZ());
+	mat.elements[5] = 1-(2*q.getX()*q.getX())-(2*q.getZ()*q.getZ());
+	mat.elements[6] = (2*q.getY()*q.getZ())-(2*q.getW()*q.getX());
+	mat.elements[8] = (2*q.getX()*q.getZ())-(2*q.getW()*q.getY());
+	mat.elements[9] = (2*q.getY()*q.getZ())+(2*q.getW()*q.getX());
+	mat.elements[10] = 1-(2*q.getX()*q.getX())-(2*q.getY()*q.getY());
 	return mat;
 }
 
-Mat4 * Mat4::scaleMatrix(GLfloat x, GLfloat y , GLfloat z){
-	Mat4 * mat = Mat4::identityMatrix();
-	mat->getElements()[0] =x;
-	mat->getElements()[5] =y;
-	mat->getElements()[10]=z;
+Mat4 Mat4::scaleMatrix(GLfloat x, GLfloat y , GLfloat z){
+	Mat4 mat;
+	mat.elements[0] =x;
+	mat.elements[5] =y;
+	mat.elements[10]=z;
 	return mat;
 }
 
@@ -69,124 +67,275 @@ void Mat4::scalarProduct(GLfloat scalar){
 	}
 }
 
-Mat4 * Mat4::copy(){
-	Mat4 * mat = new Mat4(0);
-	for(int i =0; i < 16; i++){
-		mat->getElements()[i] = this->getElements()[i];
-	}
-	return mat;
-}
-
-Mat4 * Mat4::rotationMatrix(GLfloat x , GLfloat y, GLfloat z){
+Mat4 Mat4::rotationMatrix(GLfloat x , GLfloat y, GLfloat z){
 	GLfloat radX = 3.14159 * x /180.0;
 	GLfloat radY = 3.14159 * y /180.0;
 	GLfloat radZ = 3.14159 * z /180.0;
 
-	Mat4 * rotX = Mat4::identityMatrix();
-	rotX->getElements()[5] = cos(radX);
-	rotX->getElements()[6] = -sin(radX);
-	rotX->getElements()[9] = sin(radX);
-	rotX->getElements()[10] = cos(radX);
+	Mat4 rotX;
+	rotX.elements[5] = cos(radX);
+	rotX.elements[6] = -sin(radX);
+	rotX.elements[9] = sin(radX);
+	rotX.elements[10] = cos(radX);
+
+	Mat4 rotY;
+	rotY.elements[0] = cos(radY);
+	rotY.elements[2] = sin(radY);
+	rotY.elements[8] = -sin(radY);
+	rotY.elements[10] = cos(radY);
+
+	Mat4 rotZ;
+	rotZ.elements[0] = cos(radZ);
+	rotZ.elements[1] = -sin(radZ);
+	rotZ.elements[4] = sin(radZ);
+	rotZ.elements[5] = cos(radZ);
+
+	return rotX * rotY * rotZ;
+}
 
-	Mat4 * rotY = Mat4::identityMatrix();
-	rotY->getElements()[0] = cos(radY);
-	rotY->getElements()[2] = sin(radY);
-	rotY->getElements()[8] = -sin(radY);
-	rotY->getElements()[10] = cos(radY);
+Mat4 Mat4::perspectiveMatrix(GLfloat fov, GLfloat aspectRatio, GLfloat zNear, GLfloat zFar){
+	Mat4 mat(0);
+	float radians = (float)fov * (3.14159 / 180.0);
+	mat.elements[0] = (1 / tan(radians));
+	mat.elements[5] = aspectRatio * mat.elements[0];
+	mat.elements[10] = ((zFar +zNear)/(zNear -zFar));
+	mat.elements[11] = ((2.0 * zNear * zFar)/(zNear -zFar));
+	mat.elements[14] = -1.0;
+	return mat;
+}
 
-	Mat4 * rotZ = Mat4::identityMatrix();
-	rotZ->getElements()[0] = cos(radZ);
-	rotZ->getElements()[1] = -sin(radZ);
-	rotZ->getElements()[4] = sin(radZ);
-	rotZ->getElements()[5] = cos(radZ);
+//x86 kernels are compiled with per function target attributes, so the
+//rest of the build does not need -mavx2 and old cpus keep working
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MAT4_X86_SIMD
+#include <immintrin.h>
+#endif
+
+typedef void (*MultiplyKernel)(const GLfloat* a, const GLfloat* b, GLfloat* result);
+typedef void (*TransformKernel)(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide);
+
+//result may alias a or b, the product is built on the stack first
+static void multiplyScalar(const GLfloat* a, const GLfloat* b, GLfloat* result){
+	GLfloat temp[16];
+	for(int i = 0; i < 4; i++){
+		const GLfloat* row = a + i*4;
+		for(int j = 0; j < 4; j++){
+			temp[i*4+j] = row[0] * b[j] + row[1] * b[4+j] + row[2] * b[8+j] + row[3] * b[12+j];
+		}
+	}
+	memcpy(result,temp,sizeof(temp));
+}
 
-	Mat4 * res = Mat4::identityMatrix();
-	res->crossProduct(rotX);
-	res->crossProduct(rotY);
-	res->crossProduct(rotZ);
+static void transformScalar(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide){
+	for(int i = 0; i < count; i++){
+		const GLfloat* p = points + i*stride;
+		GLfloat x = m[0]*p[0] + m[1]*p[1] + m[2]*p[2] + m[3]*w;
+		GLfloat y = m[4]*p[0] + m[5]*p[1] + m[6]*p[2] + m[7]*w;
+		GLfloat z = m[8]*p[0] + m[9]*p[1] + m[10]*p[2] + m[11]*w;
+		if(divide){
+			GLfloat invW = 1 / (m[12]*p[0] + m[13]*p[1] + m[14]*p[2] + m[15]*w);
+			x *= invW;
+			y *= invW;
+			z *= invW;
+		}
+		GLfloat* r = result + i*stride;
+		r[0] = x;
+		r[1] = y;
+		r[2] = z;
+	}
+}
 
-	delete rotX;
-	delete rotY;
-	delete rotZ;
+#ifdef MAT4_X86_SIMD
+//each row of the result is a combination of the rows of b
+__attribute__((target("sse")))
+static void multiplySSE(const GLfloat* a, const GLfloat* b, GLfloat* result){
+	__m128 b0 = _mm_loadu_ps(b);
+	__m128 b1 = _mm_loadu_ps(b + 4);
+	__m128 b2 = _mm_loadu_ps(b + 8);
+	__m128 b3 = _mm_loadu_ps(b + 12);
+	__m128 rows[4];
+	for(int i = 0; i < 4; i++){
+		const GLfloat* row = a + i*4;
+		__m128 r = _mm_mul_ps(_mm_set1_ps(row[0]),b0);
+		r = _mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(row[1]),b1));
+		r = _mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(row[2]),b2));
+		r = _mm_add_ps(r,_mm_mul_ps(_mm_set1_ps(row[3]),b3));
+		rows[i] = r;
+	}
+	for(int i = 0; i < 4; i++){
+		_mm_storeu_ps(result + i*4,rows[i]);
+	}
+}
 
-	return res;
+//two rows per register, the rows of b are repeated in both halves
+__attribute__((target("avx2,fma")))
+static void multiplyAVX2(const GLfloat* a, const GLfloat* b, GLfloat* result){
+	__m256 b0 = _mm256_broadcast_ps((const __m128*)b);
+	__m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+	__m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+	__m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+	__m256 rows[2];
+	for(int i = 0; i < 2; i++){
+		const GLfloat* lo = a + i*8;
+		const GLfloat* hi = lo + 4;
+		__m256 r = _mm256_mul_ps(_mm256_setr_ps(lo[0],lo[0],lo[0],lo[0],hi[0],hi[0],hi[0],hi[0]),b0);
+		r = _mm256_fmadd_ps(_mm256_setr_ps(lo[1],lo[1],lo[1],lo[1],hi[1],hi[1],hi[1],hi[1]),b1,r);
+		r = _mm256_fmadd_ps(_mm256_setr_ps(lo[2],lo[2],lo[2],lo[2],hi[2],hi[2],hi[2],hi[2]),b2,r);
+		r = _mm256_fmadd_ps(_mm256_setr_ps(lo[3],lo[3],lo[3],lo[3],hi[3],hi[3],hi[3],hi[3]),b3,r);
+		rows[i] = r;
+	}
+	_mm256_storeu_ps(result,rows[0]);
+	_mm256_storeu_ps(result + 8,rows[1]);
 }
 
-Mat4 * Mat4::perspectiveMatrix(GLfloat fov, GLfloat aspectRatio, GLfloat zNear, GLfloat zFar){
-	Mat4 * mat = new Mat4(0);
-	float radians = (float)fov * (3.14159 / 180.0);
-	mat->getElements()[0] = (1 / tan(radians));
-	mat->getElements()[5] = aspectRatio * mat->getElements()[0];
-	mat->getElements()[10] = ((zFar +zNear)/(zNear -zFar));
-	mat->getElements()[11] = ((2.0 * zNear * zFar)/(zNear -zFar));
-	mat->getElements()[14] = -1.0;
-	return mat;
+//the matrix is row major, its columns are gathered once and every point
+//becomes three broadcasts and three multiply-adds
+__attribute__((target("sse")))
+static void transformSSE(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide){
+	__m128 c0 = _mm_setr_ps(m[0],m[4],m[8],m[12]);
+	__m128 c1 = _mm_setr_ps(m[1],m[5],m[9],m[13]);
+	__m128 c2 = _mm_setr_ps(m[2],m[6],m[10],m[14]);
+	__m128 c3 = _mm_mul_ps(_mm_setr_ps(m[3],m[7],m[11],m[15]),_mm_set1_ps(w));
+	GLfloat out[4];
+	for(int i = 0; i < count; i++){
+		const GLfloat* p = points + i*stride;
+		__m128 r = _mm_add_ps(c3,_mm_mul_ps(c0,_mm_set1_ps(p[0])));
+		r = _mm_add_ps(r,_mm_mul_ps(c1,_mm_set1_ps(p[1])));
+		r = _mm_add_ps(r,_mm_mul_ps(c2,_mm_set1_ps(p[2])));
+		if(divide){
+			r = _mm_div_ps(r,_mm_shuffle_ps(r,r,_MM_SHUFFLE(3,3,3,3)));
+		}
+		_mm_storeu_ps(out,r);
+		GLfloat* dest = result + i*stride;
+		dest[0] = out[0];
+		dest[1] = out[1];
+		dest[2] = out[2];
+	}
 }
 
-Mat4 * Mat4::crossProductMatrices(Mat4 * m1, Mat4 * m2){
-	Mat4 * mat = new Mat4(0);
-	GLfloat * temp = mat->getElements();
-	GLfloat * a = m1->getElements();
-	GLfloat * b = m2->getElements();
-	
-	temp[0] = a[0] * b[0] + a[1] * b[4] + a[2] * b[8] + a[3] * b[12];
-    temp[1] = a[0] * b[1] + a[1] * b[5] + a[2] * b[9] + a[3] * b[13];
-    temp[2] = a[0] * b[2] + a[1] * b[6] + a[2] * b[10] + a[3] * b[14];
-    temp[3] = a[0] * b[3] + a[1] * b[7] + a[2] * b[11] + a[3] * b[15];
-
-    temp[4] = a[4] * b[0] + a[5] * b[4] + a[6] * b[8] + a[7] * b[12];
-    temp[5] = a[4] * b[1] + a[5] * b[5] + a[6] * b[9] + a[7] * b[13];
-    temp[6] = a[4] * b[2] + a[5] * b[6] + a[6] * b[10] + a[7] * b[14];
-    temp[7] = a[4] * b[3] + a[5] * b[7] + a[6] * b[11] + a[7] * b[15];
-
-    temp[8] = a[8] * b[0] + a[9] * b[4] + a[10] * b[8] + a[11] * b[12];
-    temp[9] = a[8] * b[1] + a[9] * b[5] + a[10] * b[9] + a[11] * b[13];
-    temp[10] = a[8] * b[2] + a[9] * b[6] + a[10] * b[10] + a[11] * b[14];
-    temp[11] = a[8] * b[3] + a[9] * b[7] + a[10] * b[11] + a[11] * b[15];
-
-    temp[12] = a[12] * b[0] + a[13] * b[4] + a[14] * b[8] + a[15] * b[12];
-    temp[13] = a[12] * b[1] + a[13] * b[5] + a[14] * b[9] + a[15] * b[13];
-    temp[14] = a[12] * b[2] + a[13] * b[6] + a[14] * b[10] + a[15] * b[14];
-    temp[15] = a[12] * b[3] + a[13] * b[7] + a[14] * b[11] + a[15] * b[15];
-	
-	return mat;
+//two points per iteration, one in each half of the register
+__attribute__((target("avx2,fma")))
+static void transformAVX2(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide){
+	__m256 c0 = _mm256_setr_ps(m[0],m[4],m[8],m[12],m[0],m[4],m[8],m[12]);
+	__m256 c1 = _mm256_setr_ps(m[1],m[5],m[9],m[13],m[1],m[5],m[9],m[13]);
+	__m256 c2 = _mm256_setr_ps(m[2],m[6],m[10],m[14],m[2],m[6],m[10],m[14]);
+	__m256 c3 = _mm256_mul_ps(_mm256_setr_ps(m[3],m[7],m[11],m[15],m[3],m[7],m[11],m[15]),_mm256_set1_ps(w));
+	GLfloat out[8];
+	int i = 0;
+	for(; i + 1 < count; i += 2){
+		const GLfloat* p = points + i*stride;
+		const GLfloat* q = p + stride;
+		__m256 r = _mm256_fmadd_ps(c0,_mm256_setr_ps(p[0],p[0],p[0],p[0],q[0],q[0],q[0],q[0]),c3);
+		r = _mm256_fmadd_ps(c1,_mm256_setr_ps(p[1],p[1],p[1],p[1],q[1],q[1],q[1],q[1]),r);
+		r = _mm256_fmadd_ps(c2,_mm256_setr_ps(p[2],p[2],p[2],p[2],q[2],q[2],q[2],q[2]),r);
+		if(divide){
+			r = _mm256_div_ps(r,_mm256_permute_ps(r,_MM_SHUFFLE(3,3,3,3)));
+		}
+		_mm256_storeu_ps(out,r);
+		GLfloat* dest = result + i*stride;
+		dest[0] = out[0];
+		dest[1] = out[1];
+		dest[2] = out[2];
+		dest += stride;
+		dest[0] = out[4];
+		dest[1] = out[5];
+		dest[2] = out[6];
+	}
+	if(i < count){
+		transformSSE(m,points + i*stride,result + i*stride,1,stride,w,divide);
+	}
+}
+#endif
+
+static void multiplyFirstCall(const GLfloat* a, const GLfloat* b, GLfloat* result);
+static void transformFirstCall(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide);
+
+//kernels start pointing at a stub that picks the best level on first use
+static MultiplyKernel multiplyKernel = multiplyFirstCall;
+static TransformKernel transformKernel = transformFirstCall;
+static int simdLevel = -1;
+
+static void multiplyFirstCall(const GLfloat* a, const GLfloat* b, GLfloat* result){
+	Mat4::setSimdLevel(Mat4::getSupportedSimdLevel());
+	multiplyKernel(a,b,result);
+}
+
+static void transformFirstCall(const GLfloat* m, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide){
+	Mat4::setSimdLevel(Mat4::getSupportedSimdLevel());
+	transformKernel(m,points,result,count,stride,w,divide);
+}
+
+int Mat4::getSupportedSimdLevel(){
+#ifdef MAT4_X86_SIMD
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SIMD_AVX2;
+	if(__builtin_cpu_supports("sse")) return SIMD_SSE;
+#endif
+	return SIMD_SCALAR;
 }
 
-void Mat4::crossProduct(Mat4 * mat){
-	//do this code more legible
-	GLfloat * temp = new GLfloat[16];
-	GLfloat * a = this->elements;
-	GLfloat * b = mat->elements;
+int Mat4::getSimdLevel(){
+	if(simdLevel < 0) Mat4::setSimdLevel(Mat4::getSupportedSimdLevel());
+	return simdLevel;
+}
 
-	temp[0] = a[0] * b[0] + a[1] * b[4] + a[2] * b[8] + a[3] * b[12];
-    temp[1] = a[0] * b[1] + a[1] * b[5] + a[2] * b[9] + a[3] * b[13];
-    temp[2] = a[0] * b[2] + a[1] * b[6] + a[2] * b[10] + a[3] * b[14];
-    temp[3] = a[0] * b[3] + a[1] * b[7] + a[2] * b[11] + a[3] * b[15];
+//levels above what the cpu supports are clamped down
+void Mat4::setSimdLevel(int level){
+	int supported = Mat4::getSupportedSimdLevel();
+	simdLevel = level < supported ? level : supported;
+	switch(simdLevel){
+#ifdef MAT4_X86_SIMD
+		case SIMD_AVX2:
+			multiplyKernel = multiplyAVX2;
+			transformKernel = transformAVX2;
+			break;
+		case SIMD_SSE:
+			multiplyKernel = multiplySSE;
+			transformKernel = transformSSE;
+			break;
+#endif
+		default:
+			simdLevel = SIMD_SCALAR;
+			multiplyKernel = multiplyScalar;
+			transformKernel = transformScalar;
+			break;
+	}
+}
 
-    temp[4] = a[4] * b[0] + a[5] * b[4] + a[6] * b[8] + a[7] * b[12];
-    temp[5] = a[4] * b[1] + a[5] * b[5] + a[6] * b[9] + a[7] * b[13];
-    temp[6] = a[4] * b[2] + a[5] * b[6] + a[6] * b[10] + a[7] * b[14];
-    temp[7] = a[4] * b[3] + a[5] * b[7] + a[6] * b[11] + a[7] * b[15];
+//result may alias a or b
+void Mat4::multiply(const GLfloat* a, const GLfloat* b, GLfloat* result){
+	multiplyKernel(a,b,result);
+}
 
-    temp[8] = a[8] * b[0] + a[9] * b[4] + a[10] * b[8] + a[11] * b[12];
-    temp[9] = a[8] * b[1] + a[9] * b[5] + a[10] * b[9] + a[11] * b[13];
-    temp[10] = a[8] * b[2] + a[9] * b[6] + a[10] * b[10] + a[11] * b[14];
-    temp[11] = a[8] * b[3] + a[9] * b[7] + a[10] * b[11] + a[11] * b[15];
+//points are xyz triplets stride floats apart, result uses the same stride
+//and may alias points. w = 0 transforms directions, divide projects by w
+void Mat4::transformPoints(const Mat4& matrix, const GLfloat* points, GLfloat* result, int count, int stride, GLfloat w, bool divide){
+	transformKernel(matrix.elements,points,result,count,stride,w,divide);
+}
 
-    temp[12] = a[12] * b[0] + a[13] * b[4] + a[14] * b[8] + a[15] * b[12];
-    temp[13] = a[12] * b[1] + a[13] * b[5] + a[14] * b[9] + a[15] * b[13];
-    temp[14] = a[12] * b[2] + a[13] * b[6] + a[14] * b[10] + a[15] * b[14];
-    temp[15] = a[12] * b[3] + a[13] * b[7] + a[14] * b[11] + a[15] * b[15];
+Mat4 Mat4::crossProductMatrices(const Mat4& m1, const Mat4& m2){
+	Mat4 mat(0);
+	Mat4::multiply(m1.elements,m2.elements,mat.elements);
+	return mat;
+}
 
+void Mat4::crossProduct(const Mat4& mat){
+	Mat4::multiply(this->elements,mat.elements,this->elements);
+}
+
+Mat4 Mat4::operator*(const Mat4& mat) const{
+	return Mat4::crossProductMatrices(*this,mat);
+}
 
-	delete[] (this->getElements());
-	this->setElements(temp);
+Mat4& Mat4::operator*=(const Mat4& mat){
+	this->crossProduct(mat);
+	return *this;
 }
 
-Mat4 * Mat4::getTraspose(){
-	Mat4 * result = new Mat4(0);
-	GLfloat* temp = result->elements;
-	GLfloat* a = this->elements;
+Mat4 Mat4::getTraspose() const{
+	Mat4 result(0);
+	GLfloat* temp = result.elements;
+	const GLfloat* a = this->elements;
 	for(int i=0; i < 4; i++){
 		for(int j=0; j < 4 ; j++){
 			temp[i*4+j] = a[j*4+i];
@@ -195,45 +344,78 @@ Mat4 * Mat4::getTraspose(){
 	return result;
 }
 
-Mat4* Mat4::lookAt(Vec3* eye, Vec3* target, Vec3* up){
-	Mat4 * lookAt = Mat4::identityMatrix();
+//cofactor expansion through the 2x2 minors of the top and bottom rows,
+//a singular matrix gives the zero matrix
+Mat4 Mat4::getInverse() const{
+	const GLfloat* m = this->elements;
+	GLfloat s0 = m[0]*m[5] - m[4]*m[1];
+	GLfloat s1 = m[0]*m[6] - m[4]*m[2];
+	GLfloat s2 = m[0]*m[7] - m[4]*m[3];
+	GLfloat s3 = m[1]*m[6] - m[5]*m[2];
+	GLfloat s4 = m[1]*m[7] - m[5]*m[3];
+	GLfloat s5 = m[2]*m[7] - m[6]*m[3];
+	GLfloat c5 = m[10]*m[15] - m[14]*m[11];
+	GLfloat c4 = m[9]*m[15] - m[13]*m[11];
+	GLfloat c3 = m[9]*m[14] - m[13]*m[10];
+	GLfloat c2 = m[8]*m[15] - m[12]*m[11];
+	GLfloat c1 = m[8]*m[14] - m[12]*m[10];
+	GLfloat c0 = m[8]*m[13] - m[12]*m[9];
+	GLfloat det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+	Mat4 result(0);
+	if(det == 0) return result;
+	GLfloat invDet = 1.0 / det;
+	GLfloat* r = result.elements;
+	r[0] = ( m[5]*c5 - m[6]*c4 + m[7]*c3) * invDet;
+	r[1] = (-m[1]*c5 + m[2]*c4 - m[3]*c3) * invDet;
+	r[2] = ( m[13]*s5 - m[14]*s4 + m[15]*s3) * invDet;
+	r[3] = (-m[9]*s5 + m[10]*s4 - m[11]*s3) * invDet;
+	r[4] = (-m[4]*c5 + m[6]*c2 - m[7]*c1) * invDet;
+	r[5] = ( m[0]*c5 - m[2]*c2 + m[3]*c1) * invDet;
+	r[6] = (-m[12]*s5 + m[14]*s2 - m[15]*s1) * invDet;
+	r[7] = ( m[8]*s5 - m[10]*s2 + m[11]*s1) * invDet;
+	r[8] = ( m[4]*c4 - m[5]*c2 + m[7]*c0) * invDet;
+	r[9] = (-m[0]*c4 + m[1]*c2 - m[3]*c0) * invDet;
+	r[10] = ( m[12]*s4 - m[13]*s2 + m[15]*s0) * invDet;
+	r[11] = (-m[8]*s4 + m[9]*s2 - m[11]*s0) * invDet;
+	r[12] = (-m[4]*c3 + m[5]*c1 - m[6]*c0) * invDet;
+	r[13] = ( m[0]*c3 - m[1]*c1 + m[2]*c0) * invDet;
+	r[14] = (-m[12]*s3 + m[13]*s1 - m[14]*s0) * invDet;
+	r[15] = ( m[8]*s3 - m[9]*s1 + m[10]*s0) * invDet;
+	return result;
+}
+
+Mat4 Mat4::lookAt(const Vec3& eye, const Vec3& target, const Vec3& up){
+	Mat4 lookAt;
 
-	Vec3* zAxis = new Vec3();
-	zAxis->setX(eye->getX()-target->getX());
-	zAxis->setY(eye->getY()-target->getY());
-	zAxis->setZ(eye->getZ()-target->getZ());
-	zAxis->normalize();
-	if(zAxis->length()==0){
-		zAxis->setZ(1);
+	Vec3 zAxis = eye - target;
+	zAxis.normalize();
+	if(zAxis.length()==0){
+		zAxis.setZ(1);
 	}
 
-	Vec3* xAxis = Vec3::crossProductVectors(up,zAxis);
-	xAxis->normalize();
-	if(xAxis->length() == 0){
-		zAxis->setX(zAxis->getX()-0.0001);
-		delete xAxis;
+	Vec3 xAxis = Vec3::crossProductVectors(up,zAxis);
+	xAxis.normalize();
+	if(xAxis.length() == 0){
+		zAxis.setX(zAxis.getX()-0.0001);
 		xAxis = Vec3::crossProductVectors(up,zAxis);
-		xAxis->normalize();
+		xAxis.normalize();
 	}
 
-	Vec3* yAxis = Vec3::crossProductVectors(zAxis,xAxis);
+	Vec3 yAxis = Vec3::crossProductVectors(zAxis,xAxis);
 
 
-	GLfloat* mat = lookAt->elements;
-	mat[0] = xAxis->getX();
-	mat[4] = yAxis->getX();
-	mat[8] = zAxis->getX();
+	GLfloat* mat = lookAt.elements;
+	mat[0] = xAxis.getX();
+	mat[4] = yAxis.getX();
+	mat[8] = zAxis.getX();
 
-	mat[1] = xAxis->getY();
-	mat[5] = yAxis->getY();
-	mat[9] = zAxis->getY();
+	mat[1] = xAxis.getY();
+	mat[5] = yAxis.getY();
+	mat[9] = zAxis.getY();
 
-	mat[2] = xAxis->getZ();
-	mat[6] = yAxis->getZ();
-	mat[10] = zAxis->getZ();
+	mat[2] = xAxis.getZ();
+	mat[6] = yAxis.getZ();
+	mat[10] = zAxis.getZ();
 
-	delete yAxis;
-	delete xAxis;
-	delete zAxis;
 	return lookAt;
 }
@@ -6,22 +6,6 @@
 #include "math/Vec3.h"
 #include <cstdio>
 
-Quaternion::Quaternion(){
-	this->x = 0;
-	this->y = 0;
-	this->z = 0;
-	this->w = 1;
-	this->euler = NULL;
-}
-
-Quaternion::Quaternion(GLfloat x, GLfloat y, GLfloat z,GLfloat w){
-	this->x = x;
-	this->y = y;
-	this->z = z;
-	this->w = w;
-	this->euler = NULL;
-}
-
 void Quaternion::setX(GLfloat x){
 	this->x = x;
 	if (this->euler != NULL)
@@ -46,22 +30,6 @@ void Quaternion::setW(GLfloat w){
 		this->euler->setFromQuaternion(this,this->euler->order,false);
 }
 
-GLfloat Quaternion::getX(){
-	return this->x;
-}
-
-GLfloat Quaternion::getY(){
-	return this->y;
-}
-
-GLfloat Quaternion::getZ(){
-	return this->z;
-}
-
-GLfloat Quaternion::getW(){
-	return this->w;
-}
-
 void Quaternion::setComponent(int index, GLfloat value){
 	switch(index){
 		case 0:
@@ -81,7 +49,7 @@ void Quaternion::setComponent(int index, GLfloat value){
 		this->euler->setFromQuaternion(this,this->euler->order,false);
 }
 
-GLfloat Quaternion::getComponent(int index){
+GLfloat Quaternion::getComponent(int index) const{
 	switch(index){
 		case 0:
 			return this->x;
@@ -92,7 +60,7 @@ GLfloat Quaternion::getComponent(int index){
 		case 3:
 		    return this->w;
 	}
-	return (GLfloat)NULL;
+	return 0;
 }
 
 void Quaternion::setFromEuler(Euler* euler , bool update){
@@ -143,7 +111,7 @@ void Quaternion::setFromEuler(Euler* euler , bool update){
     update ? this->euler->setFromQuaternion(this,euler->order,false) : (void)NULL;
 }
 
-GLfloat Quaternion::length(){
+GLfloat Quaternion::length() const{
 	return sqrt((this->x * this->x)+(this->y * this->y)+(this->z * this->z)+(this->w * this->w));
 }
 
@@ -164,69 +132,55 @@ void Quaternion::normalize(){
 	}
 }
 
-Quaternion * Quaternion::conjugate(){
-	Quaternion* q = new Quaternion();
-	q->euler = this->euler;
-	q->x = this->x * -1;
-	q->y = this->y * -1;
-	q->z = this->z * -1;
-	q->w = this->w;
-	//q->euler->setFromQuaternion(q,euler->order,false);
+Quaternion Quaternion::conjugate() const{
+	Quaternion q(this->x * -1, this->y * -1, this->z * -1, this->w);
+	q.euler = this->euler;
 	return q;
 }
 
-Quaternion * Quaternion::inverse(){
-	Quaternion* q = this->conjugate();
-	q->normalize();
+Quaternion Quaternion::inverse() const{
+	Quaternion q = this->conjugate();
+	q.normalize();
 	return q;
 }
 
-Quaternion* Quaternion::multiplyQuaternions(Quaternion* q1, Quaternion* q2){
-	Quaternion* quat = new Quaternion();
-	quat->x = q1->x * q2->w + q1->w * q2->x + q1->y * q2->z - q1->z * q2->y;
-	quat->y = q1->y * q2->w + q1->w * q2->y + q1->z * q2->x - q1->x * q2->z;
-	quat->z = q1->z * q2->w + q1->w * q2->z + q1->x * q2->y - q1->y * q2->x;
-	quat->w = q1->w * q2->w - q1->x * q2->x - q1->y * q2->y - q1->z * q2->z;
-	if (quat->euler != NULL)
-		quat->euler->setFromQuaternion(quat,quat->euler->order,false);
-	return quat;
+Quaternion Quaternion::multiplyQuaternions(const Quaternion& q1, const Quaternion& q2){
+	return Quaternion(
+		q1.x * q2.w + q1.w * q2.x + q1.y * q2.z - q1.z * q2.y,
+		q1.y * q2.w + q1.w * q2.y + q1.z * q2.x - q1.x * q2.z,
+		q1.z * q2.w + q1.w * q2.z + q1.x * q2.y - q1.y * q2.x,
+		q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z);
 }
 
-void  Quaternion::multiply(Quaternion* q){
-	this->x = this->x * q->w + this->w * q->x + this->y * q->z - this->z * q->y;
-	this->y = this->y * q->w + this->w * q->y + this->z * q->x - this->x * q->z;
-	this->z = this->z * q->w + this->w * q->z + this->x * q->y - this->y * q->x;
-	this->w = this->w * q->w - this->x * q->x - this->y * q->y - this->z * q->z;
+void  Quaternion::multiply(const Quaternion& q){
+	Quaternion product = Quaternion::multiplyQuaternions(*this,q);
+	this->x = product.x;
+	this->y = product.y;
+	this->z = product.z;
+	this->w = product.w;
 	if (this->euler != NULL)
 		this->euler->setFromQuaternion(this,euler->order,false);
 }
 
-GLfloat Quaternion::dotProduct(Quaternion* q){
-	return this->x * q->x + this->y * q->y + this->z * q->z + this->w * q->w;
+GLfloat Quaternion::dotProduct(const Quaternion& q) const{
+	return this->x * q.x + this->y * q.y + this->z * q.z + this->w * q.w;
 }
 
-GLfloat Quaternion::dotProductQuaternion(Quaternion* q1, Quaternion* q2){
-	return q1->x * q2->x + q1->y * q2->y + q1->z * q2->z + q1->w * q2->w;
+GLfloat Quaternion::dotProductQuaternion(const Quaternion& q1, const Quaternion& q2){
+	return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
 }
 
-Quaternion* Quaternion::rotationBetweenVectors(Vec3* vec1, Vec3* vec2){
-	GLfloat e = vec1->dotProduct(vec2);
-	Vec3* vec = Vec3::crossProductVectors(vec1,vec2);
-	if(vec == NULL) printf("Hola\n");
+Quaternion Quaternion::rotationBetweenVectors(const Vec3& vec1, const Vec3& vec2){
+	GLfloat e = vec1.dotProduct(vec2);
+	Vec3 vec = Vec3::crossProductVectors(vec1,vec2);
 	GLfloat term = sqrt(2*(1+e));
-	Quaternion* q = new Quaternion();
-	q->setX(vec->getX() * 1.0/term);
-	q->setY(vec->getY() * 1.0/term);
-	q->setZ(vec->getZ() * 1.0/term);
-	q->setW(term / 2.0);
-	delete vec;
-	return q;
+	return Quaternion(vec.getX() * 1.0/term, vec.getY() * 1.0/term, vec.getZ() * 1.0/term, term / 2.0);
 }
 
 void Quaternion::setEuler(Euler* euler){
 	this->euler = euler;
 }
 
-void Quaternion::setFromMat4(Mat4* mat4){
+void Quaternion::setFromMat4(const Mat4& mat4){
 
 }
@@ -6,7 +6,7 @@ SphericalCoord::SphericalCoord(){
 	this->r=0;
 }
 
-SphericalCoord::SphericalCoord(Vec3* cartesian, Vec3* relOrigin){
+SphericalCoord::SphericalCoord(const Vec3& cartesian, const Vec3& relOrigin){
 	this->phi=0;
 	this->theta=0;
 	this->r=0;
@@ -37,21 +37,18 @@ void SphericalCoord::setR(float r){
 	this->r = r;
 }
 
-void SphericalCoord::setFromCartesian(Vec3 * position, Vec3* relOrigin){
+void SphericalCoord::setFromCartesian(const Vec3& position, const Vec3& relOrigin){
 
-	Vec3* sub = (relOrigin == NULL) ? position : Vec3::subVectors(position,relOrigin);
-	float x2z2 = sqrt((sub->getX()*sub->getX())+(sub->getZ()*sub->getZ()));
-	this->theta = atan2(sub->getX(),sub->getZ());
-	this->phi = atan2(x2z2,sub->getY());
-	this->r = sub->length();
-	if(relOrigin != NULL) delete sub;
+	Vec3 sub = position - relOrigin;
+	float x2z2 = sqrt((sub.getX()*sub.getX())+(sub.getZ()*sub.getZ()));
+	this->theta = atan2(sub.getX(),sub.getZ());
+	this->phi = atan2(x2z2,sub.getY());
+	this->r = sub.length();
 
 }
 
-Vec3* SphericalCoord::getCartesian(Vec3* relOrigin){
-	Vec3* position = new Vec3();
-	position->setX(r * sin(this->phi) * sin(this->theta) + relOrigin->getX());
-	position->setY(r * cos(this->phi) + relOrigin->getY());
-	position->setZ(r * sin(this->phi) * cos(this->theta) + relOrigin->getZ());
-	return position;
-}
+Vec3 SphericalCoord::getCartesian(const Vec3& relOrigin){
+	return Vec3(r * sin(this->phi) * sin(this->theta) + relOrigin.getX(),
+	            r * cos(this->phi) + relOrigin.getY(),
+	            r * sin(this->phi) * cos(this->theta) + relOrigin.getZ());
+}
\ No newline at end of file
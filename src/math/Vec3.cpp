@@ -3,11 +3,7 @@
 #include <cmath>
 #include <math/Mat4.h>
 
-Vec3::Vec3(){
-
-}
-
-Vec3::Vec3(GLfloat x,GLfloat y,GLfloat z){
+void Vec3::set(GLfloat x, GLfloat y, GLfloat z){
 	this->x = x;
 	this->y = y;
 	this->z = z;
@@ -22,15 +18,6 @@ void Vec3::setY(GLfloat y){
 void Vec3::setZ(GLfloat z){
 	this->z = z;
 }
-GLfloat Vec3::getX(){
-	return this->x;
-}
-GLfloat Vec3::getY(){
-	return this->y;
-}
-GLfloat Vec3::getZ(){
-	return this->z;
-}
 void Vec3::setComponent(int index, GLfloat value){
 	switch(index){
 		case 0:
@@ -44,7 +31,7 @@ void Vec3::setComponent(int index, GLfloat value){
 			break;
 	}
 }
-GLfloat Vec3::getComponent(int index){
+GLfloat Vec3::getComponent(int index) const{
 	switch(index){
 		case 0:
 			return this->x;
@@ -53,46 +40,42 @@ GLfloat Vec3::getComponent(int index){
 		case 2:
 			return this->z;
 	}
-	return (GLfloat)NULL;
+	return 0;
 }
 
-Vec3* Vec3::applyMatrix(Mat4* matrix, GLfloat w, bool normalize){
-	Vec3* vector = new Vec3();
-	GLfloat* mat = matrix->getElements();
-	vector->x = mat[0]*this->x + mat[1]*this->y + mat[2] *this->z + mat[3]*w;
-	vector->y = mat[4]*this->x + mat[5]*this->y + mat[6] *this->z + mat[7]*w;
-	vector->z = mat[8]*this->x + mat[9]*this->y + mat[10] *this->z + mat[11]*w;
+Vec3 Vec3::applyMatrix(const Mat4& matrix, GLfloat w, bool normalize) const{
+	Vec3 vector;
+	const GLfloat* mat = matrix.getElements();
+	vector.x = mat[0]*this->x + mat[1]*this->y + mat[2] *this->z + mat[3]*w;
+	vector.y = mat[4]*this->x + mat[5]*this->y + mat[6] *this->z + mat[7]*w;
+	vector.z = mat[8]*this->x + mat[9]*this->y + mat[10] *this->z + mat[11]*w;
 	if (normalize){
 		GLfloat newW  = mat[12]*this->x + mat[13]*this->y + mat[14] *this->z + mat[15]*w;
-		vector->x /= newW;
-		vector->y /= newW;
-		vector->z /= newW;
+		vector.x /= newW;
+		vector.y /= newW;
+		vector.z /= newW;
 	}
 	return vector;
 }
 
-void Vec3::crossProduct(Vec3* vec){
-	this->x = this->y * vec->z - this->z * vec->y;
-	this->y = this->z * vec->x - this->x * vec->z;
-	this->z = this->x * vec->y - this->y * vec->x;
+void Vec3::crossProduct(const Vec3& vec){
+	*this = Vec3::crossProductVectors(*this,vec);
 }
 
-Vec3* Vec3::crossProductVectors(Vec3* v1, Vec3* v2){
-	Vec3* vec = new Vec3();
-	vec->x = v1->y * v2->z - v1->z * v2->y;
-	vec->y = v1->z * v2->x - v1->x * v2->z;
-	vec->z = v1->x * v2->y - v1->y * v2->x;
-	return vec;
+Vec3 Vec3::crossProductVectors(const Vec3& v1, const Vec3& v2){
+	return Vec3(v1.y * v2.z - v1.z * v2.y,
+	            v1.z * v2.x - v1.x * v2.z,
+	            v1.x * v2.y - v1.y * v2.x);
 }
 
-GLfloat Vec3::dotProduct(Vec3* vec){
-	return this->x * vec->x + this->y * vec->y + this->z * vec->z;
+GLfloat Vec3::dotProduct(const Vec3& vec) const{
+	return this->x * vec.x + this->y * vec.y + this->z * vec.z;
 }
 
-GLfloat Vec3::distance(Vec3* vec){
-	GLfloat x2 = (vec->x - this->x)*(vec->x - this->x);
-	GLfloat y2 = (vec->y - this->y)*(vec->y - this->y);
-	GLfloat z2 = (vec->z - this->z)*(vec->z - this->z);
+GLfloat Vec3::distance(const Vec3& vec) const{
+	GLfloat x2 = (vec.x - this->x)*(vec.x - this->x);
+	GLfloat y2 = (vec.y - this->y)*(vec.y - this->y);
+	GLfloat z2 = (vec.z - this->z)*(vec.z - this->z);
 	return sqrt(x2 + y2 + z2);
 }
 
@@ -111,27 +94,40 @@ void Vec3::normalize(){
 	}
 }
 
-GLfloat Vec3::length(){
+GLfloat Vec3::length() const{
 	return sqrt((this->x * this->x)+(this->y * this->y)+(this->z * this->z));
 }
 
-Vec3* Vec3::addVectors(Vec3* v1, Vec3* v2){
-	Vec3* res = new Vec3();
-	res->x = v1->x + v2->x;
-	res->y = v1->y + v2->y;
-	res->z = v1->z + v2->z;
-	return res;	
+Vec3 Vec3::addVectors(const Vec3& v1, const Vec3& v2){
+	return v1 + v2;
+}
+
+Vec3 Vec3::subVectors(const Vec3& v1, const Vec3& v2){
+	return v1 - v2;
+}
+
+Vec3& Vec3::operator+=(const Vec3& v){
+	this->x += v.x;
+	this->y += v.y;
+	this->z += v.z;
+	return *this;
+}
+
+Vec3& Vec3::operator-=(const Vec3& v){
+	this->x -= v.x;
+	this->y -= v.y;
+	this->z -= v.z;
+	return *this;
 }
 
-Vec3* Vec3::subVectors(Vec3* v1, Vec3* v2){
-	Vec3* res = new Vec3();
-	res->x = v1->x - v2->x;
-	res->y = v1->y - v2->y;
-	res->z = v1->z - v2->z;
-	return res;
+Vec3& Vec3::operator*=(GLfloat s){
+	this->x *= s;
+	this->y *= s;
+	this->z *= s;
+	return *this;
 }
 
-bool Vec3::insideUnitCube(){
+bool Vec3::insideUnitCube() const{
 	if( this->x <= 1 && this->x >= -1 &&
 		this->y <= 1 && this->y >= -1 &&
 		this->z <= 1 && this->z >= -1){
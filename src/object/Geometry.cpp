@@ -1,20 +1,34 @@
 #include "object/Geometry.h"
+#include "object/GeometryRegistry.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <ctype.h>
+#include <string>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+unsigned int Geometry::lastId = 0;
 
 Geometry::Geometry(){
-	this->numMeshes =0;
+	this->references = 0;
+	this->id = ++Geometry::lastId;
 	this->numVertices = 0;
 	this->numElements = 0;
-	this->numNormals = 0;
 	this->vertices = NULL;
 	this->elements = NULL;
-	this->normals=NULL;
+	this->elementType = GL_UNSIGNED_SHORT;
 	this->vertexBuffer = 0;
 	this->elementBuffer =0;
-	this->normalBuffer =0;
+	this->vertexArray = 0;
 	this->boundingBox =NULL;
 }
 GLfloat* Geometry::getVertices(){
@@ -33,41 +47,113 @@ int Geometry::getNumElements(){
 	return this->numElements;
 }
 
-GLushort* Geometry::getElements(){
+GLvoid* Geometry::getElements(){
 	return this->elements;
 }
 
+//GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the type draws read the indices as
+GLenum Geometry::getElementType(){
+	return this->elementType;
+}
+
+int Geometry::getElementSize(){
+	return this->elementType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+}
+
 void Geometry::setElements(GLushort* elements, int numElements){
 	this->elements = elements;
+	this->elementType = GL_UNSIGNED_SHORT;
 	this->numElements = numElements;
 }
 
+//largest of numElements indices of indexSize bytes, 0 when there are none
+static GLuint findMaxIndex(const void* elements, int numElements, int indexSize){
+	GLuint maxIndex = 0;
+	if(indexSize == sizeof(GLuint)){
+		const GLuint* indices = (const GLuint*)elements;
+		for(int i = 0; i < numElements; i++){
+			if(indices[i] > maxIndex) maxIndex = indices[i];
+		}
+	}
+	else{
+		const GLushort* indices = (const GLushort*)elements;
+		for(int i = 0; i < numElements; i++){
+			if(indices[i] > maxIndex) maxIndex = indices[i];
+		}
+	}
+	return maxIndex;
+}
+
+//indices that all fit in 16 bits are narrowed and the given array is
+//deleted, only meshes that need them keep 32 bit indices
+void Geometry::setElements(GLuint* elements, int numElements){
+	GLuint maxIndex = findMaxIndex(elements,numElements,sizeof(GLuint));
+	this->numElements = numElements;
+	if(maxIndex >= GEOMETRY_SHORT_INDEX_VERTICES){
+		this->elements = elements;
+		this->elementType = GL_UNSIGNED_INT;
+		return;
+	}
+	GLushort* shortElements = new GLushort[numElements > 0 ? numElements : 1];
+	for(int i = 0; i < numElements; i++){
+		shortElements[i] = elements[i];
+	}
+	delete[] elements;
+	this->elements = shortElements;
+	this->elementType = GL_UNSIGNED_SHORT;
+}
+
 Geometry::~Geometry(){
+	this->clearData();
+	//geometries that were never uploaded can be freed without a context
+	if(this->elementBuffer != 0)
+		glDeleteBuffers(1,&(this->elementBuffer));
+	if(this->vertexBuffer != 0)
+		glDeleteBuffers(1,&(this->vertexBuffer));
+	if(this->vertexArray != 0)
+		glDeleteVertexArrays(1,&(this->vertexArray));
+}
+
+//the arrays, a loaded file replaces them. buffers stay, they are uploaded
+//by the renderer
+void Geometry::clearData(){
 	if(this->vertices != NULL)
 		delete [] this->vertices;
-	if(this->elements != NULL)
-		delete [] this->elements;
-	if(this->normals != NULL)
-		delete [] this->normals;
-	if(this->boundingBox != NULL){
+	if(this->elements != NULL && this->elementType == GL_UNSIGNED_INT)
+		delete [] (GLuint*)this->elements;
+	else if(this->elements != NULL)
+		delete [] (GLushort*)this->elements;
+	if(this->boundingBox != NULL)
 		delete this->boundingBox;
-	}
-	glDeleteBuffers(1,&(this->elementBuffer));
-	glDeleteBuffers(1,&(this->vertexBuffer));
-	glDeleteBuffers(1,&(this->normalBuffer));
+	this->vertices = NULL;
+	this->elements = NULL;
+	this->elementType = GL_UNSIGNED_SHORT;
+	this->boundingBox = NULL;
+	this->numVertices = 0;
+	this->numElements = 0;
+}
+
+//meshes and whoever keeps a geometry around hold a reference to it
+void Geometry::retain(){
+	this->references++;
 }
 
-void Geometry::setNumMeshes(int numMeshes){
-	this->numMeshes = numMeshes;
+//the last release deletes the geometry and its buffers, releasing one
+//nobody retained deletes it right away
+void Geometry::release(){
+	this->references--;
+	if(this->references <= 0){
+		GeometryRegistry::getInstance()->removeGeometry(this);
+		delete this;
+	}
 }
 
-int Geometry::getNumMeshes(){
-	return this->numMeshes;
+int Geometry::getReferences(){
+	return this->references;
 }
 
-void Geometry::requestDelete(){
-	if(this->numMeshes == 0)
-		this->~Geometry();
+unsigned int Geometry::getId(){
+	return this->id;
 }
 
 GLuint Geometry::getVertexBuffer(){
@@ -86,73 +172,283 @@ void Geometry::setElementBuffer(GLuint elementBuffer){
 	this->elementBuffer = elementBuffer;
 }
 
-void exchangeNormalPosition(GLfloat* dest,GLfloat* src,GLuint destIndex,GLuint srcIndex){
-	memcpy(&dest[3*destIndex],&src[3*srcIndex],sizeof(GLfloat)*3);
+//whole file in memory and NULL terminated, so strtol and strtof stop at
+//the end of it
+static char* readTextFile(const char* filename){
+	FILE* file = fopen(filename,"rb");
+	if(file == NULL) return NULL;
+	char* text = NULL;
+	fseek(file,0,SEEK_END);
+	long size = ftell(file);
+	fseek(file,0,SEEK_SET);
+	if(size > 0){
+		text = new char[size + 1];
+		if(fread(text,1,size,file) == (size_t)size){
+			text[size] = '\0';
+		}
+		else{
+			delete[] text;
+			text = NULL;
+		}
+	}
+	fclose(file);
+	return text;
+}
+
+static int countTokens(const char* text){
+	int count = 0;
+	bool inToken = false;
+	for(;*text != '\0';text++){
+		bool space = isspace((unsigned char)*text);
+		if(!space && !inToken) count++;
+		inToken = !space;
+	}
+	return count;
 }
 
-void Geometry::loadDataFromFile(const char* filename){//change to read without fopen & read .dae(collada files)
-	FILE * data = fopen(filename,"r");
-	if(data == NULL) return;
-	//creating bounding box
-	this->boundingBox = new struct bounds;
-	this->boundingBox->x[0]=9999;
-	this->boundingBox->x[1]=-9999;
-	this->boundingBox->y[0]=9999;
-	this->boundingBox->y[1]=-9999;
-	this->boundingBox->z[0]=9999;
-	this->boundingBox->z[1]=-9999;
+//a file mapped read only, the same way PDBReader maps pdb files
+struct mappedFile{
+	const char* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int file;
+#endif
+};
 
-	fscanf(data, "%d", &(this->numVertices));
-	this->vertices = new GLfloat[this->numVertices];
-	for(int i=0; i < this->numVertices;i+=3){
-		float x,y,z;
-		fscanf(data,"%f%f%f",&x,&y,&z);
-		this->vertices[i] = x;
-		this->vertices[i+1] = y;
-		this->vertices[i+2] = z;
-		this->boundingBox->x[0]=fmin(this->boundingBox->x[0],x);
-		this->boundingBox->x[1]=fmax(this->boundingBox->x[1],x);
-		this->boundingBox->y[0]=fmin(this->boundingBox->y[0],y);
-		this->boundingBox->y[1]=fmax(this->boundingBox->y[1],y);
-		this->boundingBox->z[0]=fmin(this->boundingBox->z[0],z);
-		this->boundingBox->z[1]=fmax(this->boundingBox->z[1],z);
+static void unmapFile(struct mappedFile* mapped){
+#ifdef _WIN32
+	if(mapped->data != NULL) UnmapViewOfFile(mapped->data);
+	if(mapped->mapping != NULL) CloseHandle(mapped->mapping);
+	if(mapped->file != INVALID_HANDLE_VALUE) CloseHandle(mapped->file);
+#else
+	if(mapped->data != NULL) munmap((void*)mapped->data,mapped->size);
+	if(mapped->file >= 0) close(mapped->file);
+#endif
+}
+
+static bool mapFile(const char* filename, struct mappedFile* mapped){
+	mapped->data = NULL;
+	mapped->size = 0;
+#ifdef _WIN32
+	mapped->mapping = NULL;
+	mapped->file = CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+	if(mapped->file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if(GetFileSizeEx(mapped->file,&fileSize) && fileSize.QuadPart > 0){
+		mapped->size = (size_t)fileSize.QuadPart;
+		mapped->mapping = CreateFileMappingA(mapped->file,NULL,PAGE_READONLY,0,0,NULL);
+		if(mapped->mapping != NULL){
+			mapped->data = (const char*)MapViewOfFile(mapped->mapping,FILE_MAP_READ,0,0,0);
+		}
+	}
+#else
+	mapped->file = open(filename,O_RDONLY);
+	if(mapped->file < 0) return false;
+	struct stat fileStat;
+	if(fstat(mapped->file,&fileStat) == 0 && fileStat.st_size > 0){
+		mapped->size = fileStat.st_size;
+		void* data = mmap(NULL,mapped->size,PROT_READ,MAP_PRIVATE,mapped->file,0);
+		if(data != MAP_FAILED){
+			madvise(data,mapped->size,MADV_SEQUENTIAL);
+			mapped->data = (const char*)data;
+		}
+	}
+#endif
+	if(mapped->data == NULL){
+		unmapFile(mapped);
+		return false;
 	}
+	return true;
+}
 
-	fscanf(data, "%d", &(this->numNormals));
-	this->normals = new GLfloat[this->numNormals];
-	for(int i=0; i < this->numNormals;i++){
-		fscanf(data,"%f",&(this->normals[i]));
+//binary files are loaded as they are. text files load from their binary
+//cache when it is not older than them, otherwise they are parsed and the
+//cache is written for the next run
+void Geometry::loadDataFromFile(const char* filename){
+	string name = filename;
+	string binarySuffix = string(".mesh") + MESH_BINARY_SUFFIX;
+	bool loaded = false;
+	if(name.size() > binarySuffix.size() &&
+	   name.compare(name.size() - binarySuffix.size(),binarySuffix.size(),binarySuffix) == 0){
+		loaded = this->loadBinaryFile(filename);
+	}
+	else{
+		string cache = name + MESH_BINARY_SUFFIX;
+		struct stat textStat;
+		struct stat cacheStat;
+		bool textFound = stat(filename,&textStat) == 0;
+		if(stat(cache.c_str(),&cacheStat) == 0 && (!textFound || cacheStat.st_mtime >= textStat.st_mtime)){
+			loaded = this->loadBinaryFile(cache.c_str());
+		}
+		if(!loaded && textFound && this->loadTextFile(filename)){
+			loaded = true;
+			this->saveBinaryFile(cache.c_str());
+		}
 	}
-	GLfloat orderedNormals[this->numNormals];
-	fscanf(data, "%d", &(this->numElements));
-    this->numElements *=3;
-	this->elements = new GLushort[this->numElements];
-	unsigned short int normalIndex;
-	for(int i=0; i< this->numElements ;i++){
-		fscanf(data,"%hu%hu",&(this->elements[i]),&normalIndex);
-		exchangeNormalPosition(orderedNormals,this->normals,this->elements[i],normalIndex);
+	if(!loaded){
+		fprintf(stderr,"could not load mesh %s\n",filename);
 	}
-	memcpy(this->normals,orderedNormals,sizeof(GLfloat)*this->numNormals);
-	fclose(data);
 }
 
-GLfloat* Geometry::getNormals(){
-	return this->normals;
+//.mesh text: the vertex float count and the floats, the normal float count
+//and the floats, the face count and for every corner a vertex index, a
+//normal index and in some files one more index that is skipped. normals
+//are moved to the index of their vertex, vertices without one get a zero
+//normal
+bool Geometry::loadTextFile(const char* filename){
+	char* text = readTextFile(filename);
+	if(text == NULL) return false;
+	char* cursor = text;
+	int numVertices = strtol(cursor,&cursor,10) / 3;
+	if(numVertices <= 0){
+		delete[] text;
+		return false;
+	}
+	GLfloat* vertices = new GLfloat[numVertices * GEOMETRY_VERTEX_SIZE];
+	memset(vertices,0,sizeof(GLfloat) * numVertices * GEOMETRY_VERTEX_SIZE);
+	BoundingBox boundingBox = new struct bounds;
+	boundingBox->x[0]=9999;
+	boundingBox->x[1]=-9999;
+	boundingBox->y[0]=9999;
+	boundingBox->y[1]=-9999;
+	boundingBox->z[0]=9999;
+	boundingBox->z[1]=-9999;
+	for(int i=0; i < numVertices;i++){
+		GLfloat* vertex = &vertices[i * GEOMETRY_VERTEX_SIZE];
+		vertex[0] = strtof(cursor,&cursor);
+		vertex[1] = strtof(cursor,&cursor);
+		vertex[2] = strtof(cursor,&cursor);
+		boundingBox->x[0]=fmin(boundingBox->x[0],vertex[0]);
+		boundingBox->x[1]=fmax(boundingBox->x[1],vertex[0]);
+		boundingBox->y[0]=fmin(boundingBox->y[0],vertex[1]);
+		boundingBox->y[1]=fmax(boundingBox->y[1],vertex[1]);
+		boundingBox->z[0]=fmin(boundingBox->z[0],vertex[2]);
+		boundingBox->z[1]=fmax(boundingBox->z[1],vertex[2]);
+	}
+
+	int numNormals = strtol(cursor,&cursor,10);
+	if(numNormals < 0) numNormals = 0;
+	GLfloat* normals = new GLfloat[numNormals + 1];
+	for(int i=0; i < numNormals;i++){
+		normals[i] = strtof(cursor,&cursor);
+	}
+
+	int numElements = strtol(cursor,&cursor,10) * 3;
+	int indicesPerCorner = numElements > 0 ? countTokens(cursor) / numElements : 0;
+	GLuint* elements = new GLuint[numElements > 0 ? numElements : 1];
+	bool valid = indicesPerCorner >= 2;
+	for(int i=0; valid && i < numElements;i++){
+		long vertexIndex = strtol(cursor,&cursor,10);
+		long normalIndex = strtol(cursor,&cursor,10);
+		for(int extra = 2; extra < indicesPerCorner; extra++){
+			strtol(cursor,&cursor,10);
+		}
+		valid = vertexIndex >= 0 && vertexIndex < numVertices;
+		if(!valid) break;
+		elements[i] = vertexIndex;
+		if(normalIndex >= 0 && normalIndex < numNormals / 3){
+			memcpy(&vertices[vertexIndex * GEOMETRY_VERTEX_SIZE + GEOMETRY_NORMAL_OFFSET],&normals[3*normalIndex],sizeof(GLfloat)*3);
+		}
+	}
+	delete[] normals;
+	delete[] text;
+	if(!valid){
+		delete[] vertices;
+		delete[] elements;
+		delete boundingBox;
+		return false;
+	}
+	this->clearData();
+	this->vertices = vertices;
+	this->numVertices = numVertices;
+	this->setElements(elements,numElements);
+	this->boundingBox = boundingBox;
+	return true;
 }
-void Geometry::setNormals(GLfloat* normals, int numNormals){
-	this->normals = normals;
-	this->numNormals = numNormals;
+
+//the vertices and indices are copied out in one piece each, files that
+//are too short for their header, have indices of another size or indices
+//past the last vertex are not loaded, a stale cache then falls back to the
+//text. 16 bit indices can only reach the first 65536 vertices
+bool Geometry::loadBinaryFile(const char* filename){
+	struct mappedFile mapped;
+	if(!mapFile(filename,&mapped)) return false;
+	const struct meshBinaryHeader* header = (const struct meshBinaryHeader*)mapped.data;
+	bool valid = mapped.size >= sizeof(struct meshBinaryHeader) &&
+	             header->magic == MESH_BINARY_MAGIC &&
+	             header->version == MESH_BINARY_VERSION &&
+	             (header->indexSize == sizeof(GLuint) ||
+	              (header->indexSize == sizeof(GLushort) && header->numVertices <= GEOMETRY_SHORT_INDEX_VERTICES)) &&
+	             header->numVertices > 0 &&
+	             mapped.size == sizeof(struct meshBinaryHeader) +
+	                            (size_t)header->numVertices * GEOMETRY_VERTEX_SIZE * sizeof(GLfloat) +
+	                            (size_t)header->numElements * header->indexSize;
+	const char* vertexData = mapped.data + sizeof(struct meshBinaryHeader);
+	size_t vertexSize = valid ? (size_t)header->numVertices * GEOMETRY_VERTEX_SIZE * sizeof(GLfloat) : 0;
+	valid = valid && (header->numElements == 0 ||
+	                  findMaxIndex(vertexData + vertexSize,header->numElements,header->indexSize) < header->numVertices);
+	if(valid){
+		this->clearData();
+		this->numVertices = header->numVertices;
+		this->numElements = header->numElements;
+		this->vertices = new GLfloat[this->numVertices * GEOMETRY_VERTEX_SIZE];
+		memcpy(this->vertices,vertexData,vertexSize);
+		if(header->indexSize == sizeof(GLuint)){
+			GLuint* elements = new GLuint[this->numElements > 0 ? this->numElements : 1];
+			memcpy(elements,vertexData + vertexSize,sizeof(GLuint) * this->numElements);
+			this->setElements(elements,this->numElements);
+		}
+		else{
+			GLushort* elements = new GLushort[this->numElements > 0 ? this->numElements : 1];
+			memcpy(elements,vertexData + vertexSize,sizeof(GLushort) * this->numElements);
+			this->setElements(elements,this->numElements);
+		}
+		this->boundingBox = new struct bounds;
+		*(this->boundingBox) = header->bounds;
+	}
+	unmapFile(&mapped);
+	return valid;
 }
-int Geometry::getNumNormals(){
-	return this->numNormals;
+
+//written to a temporary file first so a load never maps half a file
+bool Geometry::saveBinaryFile(const char* filename){
+	if(this->vertices == NULL || this->elements == NULL) return false;
+	struct meshBinaryHeader header;
+	memset(&header,0,sizeof(header));
+	header.magic = MESH_BINARY_MAGIC;
+	header.version = MESH_BINARY_VERSION;
+	header.numVertices = this->numVertices;
+	header.numElements = this->numElements;
+	header.indexSize = this->getElementSize();
+	if(this->boundingBox != NULL){
+		header.bounds = *(this->boundingBox);
+	}
+	string temporary = string(filename) + ".tmp";
+	FILE* file = fopen(temporary.c_str(),"wb");
+	bool written = false;
+	if(file != NULL){
+		written = fwrite(&header,sizeof(header),1,file) == 1 &&
+		          fwrite(this->vertices,sizeof(GLfloat) * GEOMETRY_VERTEX_SIZE,this->numVertices,file) == (size_t)this->numVertices &&
+		          fwrite(this->elements,this->getElementSize(),this->numElements,file) == (size_t)this->numElements;
+		written = fclose(file) == 0 && written;
+#ifdef _WIN32
+		if(written) remove(filename);
+#endif
+		written = written && rename(temporary.c_str(),filename) == 0;
+		if(!written) remove(temporary.c_str());
+	}
+	return written;
 }
 
-GLuint Geometry::getNormalBuffer(){
-	return this->normalBuffer;
+GLuint Geometry::getVertexArray(){
+	return this->vertexArray;
 }
 
-void Geometry::setNormalBuffer(GLuint normalBuffer){
-	this->normalBuffer = normalBuffer;
+void Geometry::setVertexArray(GLuint vertexArray){
+	this->vertexArray = vertexArray;
 }
 
 BoundingBox Geometry::getBoundingBox(){
@@ -161,27 +457,27 @@ BoundingBox Geometry::getBoundingBox(){
 
 Geometry* Geometry::generateCubeGeometry(float size){
 	float dist = size/2;
-	int numVertices = 24;
+	int numVertices = 8;
 	int numElements = 36;
-	GLfloat* vertices = new GLfloat[numVertices];
-	GLfloat* normals = new GLfloat[numVertices];
+	GLfloat* vertices = new GLfloat[numVertices * GEOMETRY_VERTEX_SIZE];
 	GLushort* elements = new GLushort[numElements];
-	for(int i=0; i < 8; i++){
-		vertices[i*3] = dist * pow(-1,(i & 1 ? 1 :2));
-		vertices[(i*3)+1] = dist * pow(-1,(i & 2 ? 1 :2));
-		vertices[(i*3)+2] = dist * pow(-1,(i & 4 ? 1 :2));
-		normals[i*3] = vertices[i*3] * 0.5773502;
-		normals[(i*3)+1] = vertices[(i*3)+1] * 0.5773502;
-		normals[(i*3)+2] = vertices[(i*3)+2] * 0.5773502;
+	for(int i=0; i < numVertices; i++){
+		GLfloat* vertex = &vertices[i * GEOMETRY_VERTEX_SIZE];
+		vertex[0] = dist * pow(-1,(i & 1 ? 1 :2));
+		vertex[1] = dist * pow(-1,(i & 2 ? 1 :2));
+		vertex[2] = dist * pow(-1,(i & 4 ? 1 :2));
+		vertex[3] = vertex[0] * 0.5773502;
+		vertex[4] = vertex[1] * 0.5773502;
+		vertex[5] = vertex[2] * 0.5773502;
 	}
 
 	BoundingBox boundingBox = new struct bounds;
-	boundingBox->x[0]=vertices[21];
-	boundingBox->x[1]=vertices[0];
-	boundingBox->y[0]=vertices[22];
-	boundingBox->y[1]=vertices[1];
-	boundingBox->z[0]=vertices[23];
-	boundingBox->z[1]=vertices[2];
+	boundingBox->x[0]=-dist;
+	boundingBox->x[1]=dist;
+	boundingBox->y[0]=-dist;
+	boundingBox->y[1]=dist;
+	boundingBox->z[0]=-dist;
+	boundingBox->z[1]=dist;
 
 	GLushort elementArray[36] = {0,1,4,1,5,4,7,5,4,7,4,6,4,0,6,0,2,6,1,5,7,1,3,7,1,7,0,1,0,2,7,3,6,6,3,2};
 	memcpy(elements,elementArray, sizeof(GLushort)*36);
@@ -189,33 +485,32 @@ Geometry* Geometry::generateCubeGeometry(float size){
 	boxGeom->boundingBox = boundingBox;
 	boxGeom->setVertices(vertices,numVertices);
 	boxGeom->setElements(elements,numElements);
-	boxGeom->setNormals(normals,numVertices);
 	return boxGeom;
 }
 
 Geometry* Geometry::generateCubeWireframe(float size){
 	float dist = size/2;
-	int numVertices = 24;
+	int numVertices = 8;
 	int numElements = 24;
-	GLfloat* vertices = new GLfloat[numVertices];
-	GLfloat* normals = new GLfloat[numVertices];
+	GLfloat* vertices = new GLfloat[numVertices * GEOMETRY_VERTEX_SIZE];
 	GLushort* elements = new GLushort[numElements];
-	for(int i=0; i < 8; i++){
-		vertices[i*3] = dist * pow(-1,(i & 1 ? 1 :2));
-		vertices[(i*3)+1] = dist * pow(-1,(i & 2 ? 1 :2));
-		vertices[(i*3)+2] = dist * pow(-1,(i & 4 ? 1 :2));
-		normals[i*3] = vertices[i*3] * 0.5773502;
-		normals[(i*3)+1] = vertices[(i*3)+1] * 0.5773502;
-		normals[(i*3)+2] = vertices[(i*3)+2] * 0.5773502;
+	for(int i=0; i < numVertices; i++){
+		GLfloat* vertex = &vertices[i * GEOMETRY_VERTEX_SIZE];
+		vertex[0] = dist * pow(-1,(i & 1 ? 1 :2));
+		vertex[1] = dist * pow(-1,(i & 2 ? 1 :2));
+		vertex[2] = dist * pow(-1,(i & 4 ? 1 :2));
+		vertex[3] = vertex[0] * 0.5773502;
+		vertex[4] = vertex[1] * 0.5773502;
+		vertex[5] = vertex[2] * 0.5773502;
 	}
 
 	BoundingBox boundingBox = new struct bounds;
-	boundingBox->x[0]=vertices[21];
-	boundingBox->x[1]=vertices[0];
-	boundingBox->y[0]=vertices[22];
-	boundingBox->y[1]=vertices[1];
-	boundingBox->z[0]=vertices[23];
-	boundingBox->z[1]=vertices[2];
+	boundingBox->x[0]=-dist;
+	boundingBox->x[1]=dist;
+	boundingBox->y[0]=-dist;
+	boundingBox->y[1]=dist;
+	boundingBox->z[0]=-dist;
+	boundingBox->z[1]=dist;
 
 	//GLushort elementArray[24] = {0,1,4,1,5,4,7,5,4,7,4,6,4,0,6,0,2,6,1,5,7,1,3,7,1,7,0,1,0,2,7,3,6,6,3,2};
 	GLushort elementArray[24] = {0,1,0,2,0,4,1,3,1,5,2,3,2,6,3,7,4,5,4,6,5,7,6,7};
@@ -224,6 +519,81 @@ Geometry* Geometry::generateCubeWireframe(float size){
 	boxGeom->boundingBox = boundingBox;
 	boxGeom->setVertices(vertices,numVertices);
 	boxGeom->setElements(elements,numElements);
-	boxGeom->setNormals(normals,numVertices);
 	return boxGeom;
+}
+
+Geometry* Geometry::generateQuad(float size){
+	float dist = size/2;
+	int numVertices = 4;
+	int numElements = 6;
+	GLfloat* vertices = new GLfloat[numVertices * GEOMETRY_VERTEX_SIZE];
+	GLushort* elements = new GLushort[numElements];
+	for(int i=0; i < numVertices; i++){
+		GLfloat* vertex = &vertices[i * GEOMETRY_VERTEX_SIZE];
+		vertex[0] = dist * pow(-1,(i & 1 ? 1 :2));
+		vertex[1] = dist * pow(-1,(i & 2 ? 1 :2));
+		vertex[2] = 0;
+		vertex[3] = 0;
+		vertex[4] = 0;
+		vertex[5] = 1;
+	}
+
+	BoundingBox boundingBox = new struct bounds;
+	boundingBox->x[0]=-dist;
+	boundingBox->x[1]=dist;
+	boundingBox->y[0]=-dist;
+	boundingBox->y[1]=dist;
+	boundingBox->z[0]=0;
+	boundingBox->z[1]=0;
+
+	GLushort elementArray[6] = {0,1,2,1,3,2};
+	memcpy(elements,elementArray, sizeof(GLushort)*6);
+	Geometry * quadGeom = new Geometry();
+	quadGeom->boundingBox = boundingBox;
+	quadGeom->setVertices(vertices,numVertices);
+	quadGeom->setElements(elements,numElements);
+	return quadGeom;
+}
+
+//open cylinder of radius 1 along z from -1 to 1, the ends are left out as
+//bonds always finish inside an atom. past 32768 segments the indices are
+//32 bit
+Geometry* Geometry::generateCylinder(int segments){
+	int numVertices = segments * 2;
+	int numElements = segments * 6;
+	GLfloat* vertices = new GLfloat[numVertices * GEOMETRY_VERTEX_SIZE];
+	GLuint* elements = new GLuint[numElements];
+	for(int i=0; i < segments; i++){
+		float angle = 2 * M_PI * i / segments;
+		for(int j=0; j < 2; j++){
+			GLfloat* vertex = &vertices[(i*2 + j) * GEOMETRY_VERTEX_SIZE];
+			vertex[0] = cos(angle);
+			vertex[1] = sin(angle);
+			vertex[2] = j == 0 ? -1 : 1;
+			vertex[3] = cos(angle);
+			vertex[4] = sin(angle);
+			vertex[5] = 0;
+		}
+		int next = (i+1) % segments;
+		elements[i*6] = i*2;
+		elements[i*6+1] = next*2;
+		elements[i*6+2] = i*2+1;
+		elements[i*6+3] = i*2+1;
+		elements[i*6+4] = next*2;
+		elements[i*6+5] = next*2+1;
+	}
+
+	BoundingBox boundingBox = new struct bounds;
+	boundingBox->x[0]=-1;
+	boundingBox->x[1]=1;
+	boundingBox->y[0]=-1;
+	boundingBox->y[1]=1;
+	boundingBox->z[0]=-1;
+	boundingBox->z[1]=1;
+
+	Geometry * cylinderGeom = new Geometry();
+	cylinderGeom->boundingBox = boundingBox;
+	cylinderGeom->setVertices(vertices,numVertices);
+	cylinderGeom->setElements(elements,numElements);
+	return cylinderGeom;
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "object/GeometryRegistry.h"
+
+GeometryRegistry* GeometryRegistry::instance = NULL;
+
+GeometryRegistry::GeometryRegistry(){
+	this->loads = 0;
+	this->hits = 0;
+}
+
+GeometryRegistry* GeometryRegistry::getInstance(){
+	if(GeometryRegistry::instance == NULL){
+		GeometryRegistry::instance = new GeometryRegistry();
+	}
+	return GeometryRegistry::instance;
+}
+
+//the geometry of a mesh file, loaded the first time its path is asked for.
+//a file that can not be loaded gives an empty geometry like before
+Geometry* GeometryRegistry::getGeometry(const char* filename){
+	Geometry* geometry = this->findGeometry(filename);
+	if(geometry != NULL) return geometry;
+	geometry = new Geometry();
+	geometry->loadDataFromFile(filename);
+	this->loads++;
+	return this->addGeometry(filename,geometry);
+}
+
+//NULL when nothing was added under the name
+Geometry* GeometryRegistry::findGeometry(const char* name){
+	map<string,Geometry*>::iterator it = this->geometries.find(name);
+	if(it == this->geometries.end()) return NULL;
+	this->hits++;
+	return it->second;
+}
+
+//a name already taken keeps its geometry, the given one is returned as it
+//is and not shared
+Geometry* GeometryRegistry::addGeometry(const char* name, Geometry* geometry){
+	if(this->geometries.find(name) == this->geometries.end()){
+		this->geometries[name] = geometry;
+	}
+	return geometry;
+}
+
+//called by Geometry::release before the geometry is deleted
+void GeometryRegistry::removeGeometry(Geometry* geometry){
+	map<string,Geometry*>::iterator it = this->geometries.begin();
+	for(;it != this->geometries.end();it++){
+		if(it->second == geometry){
+			this->geometries.erase(it);
+			return;
+		}
+	}
+}
+
+int GeometryRegistry::getNumGeometries(){
+	return this->geometries.size();
+}
+
+//files read so far
+int GeometryRegistry::getLoads(){
+	return this->loads;
+}
+
+//geometries handed out without loading or generating them again
+int GeometryRegistry::getHits(){
+	return this->hits;
+}
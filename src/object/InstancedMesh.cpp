@@ -0,0 +1,135 @@
+#include "object/InstancedMesh.h"
+#include <cstdlib>
+#include <cmath>
+
+unsigned int InstancedMesh::lastInstanceVersion = 0;
+
+InstancedMesh::InstancedMesh(Geometry* geometry, Material* material, InstanceType instanceType):Mesh(geometry,material){
+	this->instanceType = instanceType;
+	this->instancesChanged();
+}
+
+InstancedMesh::InstancedMesh(const InstancedMesh& mesh):Mesh(mesh){
+	this->instanceType = mesh.instanceType;
+	this->spheres = mesh.spheres;
+	this->cylinders = mesh.cylinders;
+	this->instancesChanged();
+}
+
+//versions come from one counter shared by every mesh, a mesh created where
+//a deleted one lived never repeats its version
+void InstancedMesh::instancesChanged(){
+	this->boundsDirty = true;
+	this->instanceVersion = ++InstancedMesh::lastInstanceVersion;
+}
+
+unsigned int InstancedMesh::getInstanceVersion(){
+	return this->instanceVersion;
+}
+
+InstanceType InstancedMesh::getInstanceType(){
+	return this->instanceType;
+}
+
+void InstancedMesh::reserve(int numInstances){
+	if(this->instanceType == SPHERE_INSTANCE)
+		this->spheres.reserve(numInstances);
+	else
+		this->cylinders.reserve(numInstances);
+}
+
+int InstancedMesh::addSphere(GLfloat x, GLfloat y, GLfloat z, GLfloat radius, GLuint material){
+	struct sphereInstance instance;
+	instance.position[0] = x;
+	instance.position[1] = y;
+	instance.position[2] = z;
+	instance.radius = radius;
+	instance.material = material;
+	this->spheres.push_back(instance);
+	this->instancesChanged();
+	return this->spheres.size() - 1;
+}
+
+int InstancedMesh::addCylinder(GLfloat* start, GLfloat* end, GLfloat* offset, GLfloat radius, GLuint material, GLuint endMaterial){
+	struct cylinderInstance instance;
+	for(int i = 0; i < 3; i++){
+		instance.start[i] = start[i];
+		instance.end[i] = end[i];
+		instance.offset[i] = offset[i];
+	}
+	instance.radius = radius;
+	instance.material = material;
+	instance.endMaterial = endMaterial;
+	this->cylinders.push_back(instance);
+	this->instancesChanged();
+	return this->cylinders.size() - 1;
+}
+
+void InstancedMesh::setSpherePosition(int index, GLfloat x, GLfloat y, GLfloat z){
+	this->spheres[index].position[0] = x;
+	this->spheres[index].position[1] = y;
+	this->spheres[index].position[2] = z;
+	this->instancesChanged();
+}
+
+void InstancedMesh::setSphereRadius(int index, GLfloat radius){
+	this->spheres[index].radius = radius;
+	this->instancesChanged();
+}
+
+int InstancedMesh::getNumInstances(){
+	if(this->instanceType == SPHERE_INSTANCE)
+		return this->spheres.size();
+	return this->cylinders.size();
+}
+
+SphereInstance InstancedMesh::getSpheres(){
+	return this->spheres.empty() ? NULL : &(this->spheres[0]);
+}
+
+CylinderInstance InstancedMesh::getCylinders(){
+	return this->cylinders.empty() ? NULL : &(this->cylinders[0]);
+}
+
+void InstancedMesh::clearInstances(){
+	this->spheres.clear();
+	this->cylinders.clear();
+	this->instancesChanged();
+}
+
+//box around every instance, the geometry is a unit shape scaled by the
+//radius so the radius is enough margin around centers and endpoints
+void InstancedMesh::getLocalBounds(BoundingBox bounds){
+	if(this->boundsDirty){
+		GLfloat* min[3] = {&(this->instanceBounds.x[0]),&(this->instanceBounds.y[0]),&(this->instanceBounds.z[0])};
+		GLfloat* max[3] = {&(this->instanceBounds.x[1]),&(this->instanceBounds.y[1]),&(this->instanceBounds.z[1])};
+		for(int axis = 0; axis < 3; axis++){
+			*(min[axis]) = 9999;
+			*(max[axis]) = -9999;
+		}
+		int numSpheres = this->spheres.size();
+		for(int i = 0; i < numSpheres; i++){
+			struct sphereInstance* sphere = &(this->spheres[i]);
+			for(int axis = 0; axis < 3; axis++){
+				*(min[axis]) = fmin(*(min[axis]),sphere->position[axis] - sphere->radius);
+				*(max[axis]) = fmax(*(max[axis]),sphere->position[axis] + sphere->radius);
+			}
+		}
+		int numCylinders = this->cylinders.size();
+		for(int i = 0; i < numCylinders; i++){
+			struct cylinderInstance* cylinder = &(this->cylinders[i]);
+			for(int axis = 0; axis < 3; axis++){
+				GLfloat start = cylinder->start[axis] + cylinder->offset[axis];
+				GLfloat end = cylinder->end[axis] + cylinder->offset[axis];
+				*(min[axis]) = fmin(*(min[axis]),fmin(start,end) - cylinder->radius);
+				*(max[axis]) = fmax(*(max[axis]),fmax(start,end) + cylinder->radius);
+			}
+		}
+		this->boundsDirty = false;
+	}
+	if(this->getNumInstances() == 0){
+		Mesh::getLocalBounds(bounds);
+		return;
+	}
+	*bounds = this->instanceBounds;
+}
@@ -1,5 +1,6 @@
 #include "object/Mesh.h"
 #include <cstdlib>
+#include <cmath>
 
 Mesh::Mesh():Object3D(){
 	this->geometry = NULL;
@@ -8,18 +9,22 @@ Mesh::Mesh():Object3D(){
 }
 
 Mesh::Mesh(const Mesh& mesh):Object3D((Object3D)mesh){
-	this->geometry = mesh.geometry;
+	this->geometry = NULL;
+	this->setGeometry(mesh.geometry);
 	this->material = mesh.material;
 	this->boundingBox = NULL;
 }
 
 Mesh::Mesh(Geometry* geometry):Object3D(){
-	this->geometry = geometry;
+	this->geometry = NULL;
+	this->setGeometry(geometry);
+	this->material = NULL;
 	this->boundingBox = NULL;
 }
 
 Mesh::Mesh(Geometry* geometry, Material* material):Object3D(){
-	this->geometry = geometry;
+	this->geometry = NULL;
+	this->setGeometry(geometry);
 	this->material = material;
 	this->boundingBox = NULL;
 }
@@ -37,16 +42,16 @@ Geometry * Mesh::getGeometry(){
 	return this->geometry;
 }
 
+//the new geometry is retained first, setting the same one again must not
+//delete it
 void Mesh::setGeometry(Geometry* geometry){
-	if (this->geometry != NULL) this->geometry->setNumMeshes(this->geometry->getNumMeshes()-1);//remove from prev geom
+	if (geometry != NULL) geometry->retain();
+	if (this->geometry != NULL) this->geometry->release();
 	this->geometry = geometry;
-	if (this->geometry != NULL) this->geometry->setNumMeshes(this->geometry->getNumMeshes()+1);// add to new geom
 }
 
 Mesh::~Mesh(){
-	Geometry * geom = this->geometry;
 	this->setGeometry(NULL);
-	geom->requestDelete();
 	if (this->boundingBox != NULL)
 		delete this->boundingBox;
 	//material manager?
@@ -58,34 +63,38 @@ BoundingBox Mesh::getBoundingBox(){
 	return this->boundingBox;
 }
 
+//the model matrix is affine, so the world box is the transformed center
+//plus the local half size through the absolute value of the rotation and
+//scale part, the same box as transforming all 8 corners
 void Mesh::updateBoundingBox(){
 	if(this->boundingBox == NULL){
 		this->boundingBox = new struct bounds;
 	}
-	this->boundingBox->x[0]=9999;
-	this->boundingBox->x[1]=-9999;
-	this->boundingBox->y[0]=9999;
-	this->boundingBox->y[1]=-9999;
-	this->boundingBox->z[0]=9999;
-	this->boundingBox->z[1]=-9999;
 	this->updateModelMatrix();
-	Mat4* modelMatrix = this->getModelMatrix();
-	Vec3 vertices[8];
-	for(int i = 0; i < 8 ; i++){
-		vertices[i].setX(this->getGeometry()->getBoundingBox()->x[(i & 1 ? 1 :0)]);
-		vertices[i].setY(this->getGeometry()->getBoundingBox()->y[(i & 2 ? 1 :0)]);
-		vertices[i].setZ(this->getGeometry()->getBoundingBox()->z[(i & 4 ? 1 :0)]);
-
-		Vec3* newVert = vertices[i].applyMatrix(modelMatrix,1);
-		this->boundingBox->x[0]=fmin(this->boundingBox->x[0],newVert->getX());
-		this->boundingBox->x[1]=fmax(this->boundingBox->x[1],newVert->getX());
-		this->boundingBox->y[0]=fmin(this->boundingBox->y[0],newVert->getY());
-		this->boundingBox->y[1]=fmax(this->boundingBox->y[1],newVert->getY());
-		this->boundingBox->z[0]=fmin(this->boundingBox->z[0],newVert->getZ());
-		this->boundingBox->z[1]=fmax(this->boundingBox->z[1],newVert->getZ());
-		delete newVert;
+	const GLfloat* m = this->getModelMatrix()->getElements();
+	struct bounds localBounds;
+	this->getLocalBounds(&localBounds);
+	GLfloat center[3] = {
+		(localBounds.x[0] + localBounds.x[1]) * 0.5f,
+		(localBounds.y[0] + localBounds.y[1]) * 0.5f,
+		(localBounds.z[0] + localBounds.z[1]) * 0.5f
+	};
+	GLfloat halfSize[3] = {
+		(localBounds.x[1] - localBounds.x[0]) * 0.5f,
+		(localBounds.y[1] - localBounds.y[0]) * 0.5f,
+		(localBounds.z[1] - localBounds.z[0]) * 0.5f
+	};
+	GLfloat* axes[3] = {this->boundingBox->x,this->boundingBox->y,this->boundingBox->z};
+	for(int row = 0; row < 3; row++){
+		const GLfloat* r = &m[row*4];
+		GLfloat worldCenter = r[0]*center[0] + r[1]*center[1] + r[2]*center[2] + r[3];
+		GLfloat worldHalf = fabs(r[0])*halfSize[0] + fabs(r[1])*halfSize[1] + fabs(r[2])*halfSize[2];
+		axes[row][0] = worldCenter - worldHalf;
+		axes[row][1] = worldCenter + worldHalf;
 	}
 }
 
-
-
+//bounds in the mesh's own space, before the model matrix
+void Mesh::getLocalBounds(BoundingBox bounds){
+	*bounds = *(this->getGeometry()->getBoundingBox());
+}
@@ -1,148 +1,198 @@
 #include "object/Object3D.h"
 #include <cstdlib>
-#include "scene/OctreeNode.h"
 
-Object3D::Object3D(){
+unsigned int Object3D::localMatrixUpdates = 0;
+unsigned int Object3D::worldMatrixUpdates = 0;
+
+Object3D::Object3D() : position(0,0,0), rotation(0,0,0,"XYZ"), quaternion(0,0,0,1), scale(1,1,1){
+	this->localDirty = true;
+	this->worldDirty = true;
+	this->worldVersion = 1;
+	this->parentVersion = 0;
+	this->updateFrame = 0;
 	this->visible = true;
-	this->position = new Vec3(0,0,0);
-	this->rotation = new Euler(0,0,0,"XYZ");
-	this->quaternion = new Quaternion(0,0,0,1);
-	this->scale = new Vec3(1,1,1);
-	this->modelMatrix = Mat4::identityMatrix();
-	this->octreeNode = NULL;
-	this->rotation->quaternion = this->quaternion;
-	this->quaternion->euler=this->rotation;
+	this->rotation.quaternion = &(this->quaternion);
+	this->quaternion.euler = &(this->rotation);
 	this->parent = NULL;
 	this->distanceToCamera = 1;
 	//this->quaternion->setFromEuler(this->rotation,false);
 }
-Object3D::Object3D(const Object3D& object3D){
+Object3D::Object3D(const Object3D& object3D) :
+	position(object3D.position),
+	rotation(object3D.rotation),
+	quaternion(object3D.quaternion),
+	scale(object3D.scale){
+	this->localDirty = true;
+	this->worldDirty = true;
+	this->worldVersion = 1;
+	this->parentVersion = 0;
+	this->updateFrame = 0;
 	this->visible = object3D.visible;
-	this->position = new Vec3(*(object3D.position));
-	this->rotation = new Euler(*(object3D.rotation));
-	this->quaternion = new Quaternion(*(object3D.quaternion));
-	this->scale = new Vec3(*(object3D.scale));
-	this->modelMatrix = Mat4::identityMatrix();
-	this->octreeNode = NULL;
-	this->rotation->quaternion = this->quaternion;
-	this->quaternion->euler=this->rotation;
+	this->rotation.quaternion = &(this->quaternion);
+	this->quaternion.euler = &(this->rotation);
 	this->parent = NULL;
 	this->distanceToCamera = 1;
 }
 
 Object3D::~Object3D(){
-	if (this->position != NULL){
-		delete this->position;
-	}
-	if (this->rotation != NULL){
-		delete this->rotation;
-	}
-	if(this->scale != NULL){
-		delete this->scale;
-	}
-	if(this->quaternion != NULL){
-		delete this->quaternion;
-	}
-	if(this->modelMatrix != NULL)
-		delete this->modelMatrix;
 }
 
 Vec3* Object3D::getPosition(){
-	return this->position;
+	return &(this->position);
 }
 
 Euler* Object3D::getRotation(){
-	return this->rotation;
+	return &(this->rotation);
 }
 
 Vec3* Object3D::getScale(){
-	return this->scale;
+	return &(this->scale);
 }
 
 Quaternion* Object3D::getQuaternion(){
-	return this->quaternion;
+	return &(this->quaternion);
 }
 
-void Object3D::setPosition(Vec3* position){
+void Object3D::setPosition(const Vec3& position){
 	this->position = position;
+	this->markDirty();
 }
 
-void Object3D::setRotation(Euler* rotation){
+void Object3D::setRotation(const Euler& rotation){
 	this->rotation = rotation;
-	//delete previous quaternion in new euler if exists
-	if (rotation->quaternion != NULL)
-		delete[] (rotation->quaternion);
-	rotation->quaternion = this->quaternion;
-
-	//delete the previous euler in the Object's quaternion if exists
-	if(this->quaternion->euler != NULL)
-		delete[] this->quaternion->euler;
-	this->quaternion->euler =rotation;
-	rotation->quaternion->setFromEuler(rotation,false);
+	this->rotation.quaternion = &(this->quaternion);
+	this->quaternion.setFromEuler(&(this->rotation),false);
+	this->markDirty();
 }
 
-void Object3D::setQuaternion(Quaternion* quaternion){
+void Object3D::setQuaternion(const Quaternion& quaternion){
 	this->quaternion = quaternion;
-	//delete previous euler in new quaternion if exists
-	quaternion->euler= this->rotation;
-
-	this->rotation->quaternion = quaternion;
-	quaternion->euler->setFromQuaternion(quaternion,this->rotation->order,false);
+	this->quaternion.euler = &(this->rotation);
+	this->rotation.setFromQuaternion(&(this->quaternion),this->rotation.order,false);
+	this->markDirty();
 }
 
-void Object3D::setScale(Vec3* scale){
+void Object3D::setScale(const Vec3& scale){
 	this->scale = scale;
+	this->markDirty();
 }
 
 Mat4 * Object3D::getModelMatrix(){
-	return this->modelMatrix;
+	return &(this->modelMatrix);
+}
+
+Mat4 * Object3D::getLocalMatrix(){
+	this->updateLocalMatrix();
+	return &(this->localMatrix);
+}
+
+void Object3D::markDirty(){
+	this->localDirty = true;
 }
 
+bool Object3D::transformChanged(){
+	return this->position.getX() != this->localPosition.getX() ||
+	       this->position.getY() != this->localPosition.getY() ||
+	       this->position.getZ() != this->localPosition.getZ() ||
+	       this->quaternion.getX() != this->localQuaternion.getX() ||
+	       this->quaternion.getY() != this->localQuaternion.getY() ||
+	       this->quaternion.getZ() != this->localQuaternion.getZ() ||
+	       this->quaternion.getW() != this->localQuaternion.getW() ||
+	       this->scale.getX() != this->localScale.getX() ||
+	       this->scale.getY() != this->localScale.getY() ||
+	       this->scale.getZ() != this->localScale.getZ();
+}
+
+//translation * rotation * scale written out, the scale multiplies the
+//rotation columns and the translation fills the last column
+void Object3D::updateLocalMatrix(){
+	if(!this->localDirty && !this->transformChanged()) return;
+	this->localMatrix = Mat4::rotationMatrixFromQuaternion(this->quaternion);
+	GLfloat* m = this->localMatrix.getElements();
+	for(int row = 0; row < 3; row++){
+		m[row*4] *= this->scale.getX();
+		m[row*4+1] *= this->scale.getY();
+		m[row*4+2] *= this->scale.getZ();
+	}
+	m[3] = this->position.getX();
+	m[7] = this->position.getY();
+	m[11] = this->position.getZ();
+	this->localPosition = this->position;
+	this->localQuaternion = this->quaternion;
+	this->localScale = this->scale;
+	this->localDirty = false;
+	this->worldDirty = true;
+	Object3D::localMatrixUpdates++;
+}
+
+//the parent must already be up to date
+void Object3D::updateWorldMatrixFromParent(){
+	unsigned int parentVersion = this->parent != NULL ? this->parent->worldVersion : 0;
+	if(!this->worldDirty && parentVersion == this->parentVersion) return;
+	if(this->parent != NULL){
+		this->modelMatrix = this->parent->modelMatrix * this->localMatrix;
+	}
+	else{
+		this->modelMatrix = this->localMatrix;
+	}
+	this->parentVersion = parentVersion;
+	this->worldDirty = false;
+	this->worldVersion++;
+	Object3D::worldMatrixUpdates++;
+}
+
+//brings this object up to date walking towards the root, nothing is
+//recomputed unless this object or one of its ancestors moved
 void Object3D::updateModelMatrix(){
-	Mat4 * translation = Mat4::translationMatrix(
-		this->getPosition()->getX(),
-		this->getPosition()->getY(),
-		this->getPosition()->getZ());
-	Mat4 * rot = Mat4::rotationMatrixFromQuaternion(
-		this->getQuaternion());
-
-	Mat4 * scale = Mat4::scaleMatrix(
-		this->getScale()->getX(),
-		this->getScale()->getY(),
-		this->getScale()->getZ());
-	if(this->modelMatrix !=NULL)
-		delete this->modelMatrix;
-	this->modelMatrix = Mat4::identityMatrix();
-	if(parent != NULL){
+	if(this->parent != NULL){
 		this->parent->updateModelMatrix();
-		this->modelMatrix->crossProduct(this->parent->modelMatrix);
 	}
-	
-	this->modelMatrix->crossProduct(translation);
-	this->modelMatrix->crossProduct(rot);
-	this->modelMatrix->crossProduct(scale);
+	this->updateLocalMatrix();
+	this->updateWorldMatrixFromParent();
+}
+
+//top-down pass over the children list, called once per frame on roots
+void Object3D::updateMatrixHierarchy(){
+	this->updateLocalMatrix();
+	this->updateWorldMatrixFromParent();
+	list<Object3D*>::iterator it = this->objects.begin();
+	list<Object3D*>::iterator end = this->objects.end();
+	for(;it != end;it++){
+		(*it)->updateMatrixHierarchy();
+	}
+}
 
-	delete scale;
-	delete rot;
-	delete translation;
+unsigned int Object3D::getWorldVersion(){
+	return this->worldVersion;
 }
 
-bool Object3D::getVisible(){
-	return this->visible 
-	       && 
-	       (this->octreeNode != NULL ? this->octreeNode->isVisible() : true);
+unsigned int Object3D::getUpdateFrame(){
+	return this->updateFrame;
 }
 
-void Object3D::setVisible(bool visible){
-	this->visible = visible;
+void Object3D::setUpdateFrame(unsigned int updateFrame){
+	this->updateFrame = updateFrame;
+}
+
+unsigned int Object3D::getLocalMatrixUpdates(){
+	return Object3D::localMatrixUpdates;
+}
+
+unsigned int Object3D::getWorldMatrixUpdates(){
+	return Object3D::worldMatrixUpdates;
+}
+
+void Object3D::resetMatrixUpdates(){
+	Object3D::localMatrixUpdates = 0;
+	Object3D::worldMatrixUpdates = 0;
 }
 
-OctreeNode* Object3D::getOctreeNode(){
-	return this->octreeNode;
+bool Object3D::getVisible(){
+	return this->visible;
 }
 
-void Object3D::setOctreeNode(OctreeNode* octreeNode){
-	this->octreeNode = octreeNode;
+void Object3D::setVisible(bool visible){
+	this->visible = visible;
 }
 
 Object3D* Object3D::getParent(){
@@ -151,17 +201,7 @@ Object3D* Object3D::getParent(){
 
 void Object3D::setParent(Object3D* parent){
 	this->parent = parent;
-}
-
-void Object3D::updateOctreeNode(){
-	if(this->octreeNode != NULL){
-		this->octreeNode->updateObjectPosition(this);
-	}
-	list<Object3D*>::iterator it = this->objects.begin();
-	list<Object3D*>::iterator end = this->objects.end();
-	for(;it != end;it++){
-		(*it)->updateOctreeNode();
-	}
+	this->worldDirty = true;
 }
 
 float Object3D::getDistanceToCamera(){
@@ -0,0 +1,281 @@
+#include "render/DrawPool.h"
+#include <cstring>
+#include <cmath>
+
+DrawPool::DrawPool(){
+	this->vertexBuffer = 0;
+	this->elementBuffer = 0;
+	this->vertexArray = 0;
+	this->elementType = GL_UNSIGNED_SHORT;
+	this->commandBuffer = 0;
+	this->commandOffset = 0;
+	this->geometryDirty = false;
+	this->uploadedBytes = 0;
+	for(int type = 0; type < 2; type++){
+		this->instanceBuffers[type] = 0;
+		this->instancesDirty[type] = false;
+		this->unusedInstances[type] = 0;
+	}
+}
+
+DrawPool::~DrawPool(){
+	GLuint buffers[4] = {this->vertexBuffer,this->elementBuffer,this->instanceBuffers[0],this->instanceBuffers[1]};
+	for(int i = 0; i < 4; i++){
+		if(buffers[i] != 0) glDeleteBuffers(1,&(buffers[i]));
+	}
+	if(this->vertexArray != 0) glDeleteVertexArrays(1,&(this->vertexArray));
+}
+
+void DrawPool::begin(){
+	this->frameMeshes.clear();
+}
+
+//material is the multi draw variant the mesh is drawn with
+void DrawPool::add(InstancedMesh* mesh, Material* material){
+	this->frameMeshes.push_back(make_pair(mesh,material));
+}
+
+//geometries are only appended, they are shared by many meshes. a released
+//geometry's vertices and indices stay where they are unused, its id is
+//never asked for again
+PoolRange DrawPool::addGeometry(Geometry* geometry){
+	map<unsigned int,struct poolRange>::iterator it = this->geometries.find(geometry->getId());
+	if(it != this->geometries.end()) return &(it->second);
+	struct poolRange range;
+	range.baseVertex = this->vertices.size() / GEOMETRY_VERTEX_SIZE;
+	range.first = this->elements.size();
+	range.count = geometry->getElements() != NULL ? geometry->getNumElements() : 0;
+	range.version = 0;
+	if(geometry->getVertices() != NULL){
+		this->vertices.insert(this->vertices.end(),geometry->getVertices(),
+		                      geometry->getVertices() + geometry->getNumVertices() * GEOMETRY_VERTEX_SIZE);
+	}
+	if(range.count > 0 && geometry->getElementType() == GL_UNSIGNED_INT){
+		GLuint* elements = (GLuint*)geometry->getElements();
+		this->elements.insert(this->elements.end(),elements,elements + range.count);
+		this->elementType = GL_UNSIGNED_INT;
+	}
+	else if(range.count > 0){
+		GLushort* elements = (GLushort*)geometry->getElements();
+		this->elements.insert(this->elements.end(),elements,elements + range.count);
+	}
+	this->geometryDirty = true;
+	this->geometries[geometry->getId()] = range;
+	return &(this->geometries[geometry->getId()]);
+}
+
+//changed instances are written over the old ones when the count matches,
+//otherwise they go to the end and the old range is left unused
+PoolRange DrawPool::addInstances(InstancedMesh* mesh){
+	InstanceType type = mesh->getInstanceType();
+	map<InstancedMesh*,struct poolRange>& ranges = this->instances[type];
+	map<InstancedMesh*,struct poolRange>::iterator it = ranges.find(mesh);
+	int numInstances = mesh->getNumInstances();
+	if(it != ranges.end() && it->second.version == mesh->getInstanceVersion()) return &(it->second);
+	struct poolRange range;
+	if(it != ranges.end() && it->second.count == numInstances){
+		range = it->second;
+	}
+	else{
+		if(it != ranges.end()) this->unusedInstances[type] += it->second.count;
+		range.first = type == SPHERE_INSTANCE ? this->spheres.size() : this->cylinders.size();
+		range.count = numInstances;
+		range.baseVertex = 0;
+		if(type == SPHERE_INSTANCE) this->spheres.resize(range.first + numInstances);
+		else this->cylinders.resize(range.first + numInstances);
+	}
+	range.version = mesh->getInstanceVersion();
+	if(numInstances > 0){
+		if(type == SPHERE_INSTANCE){
+			memcpy(&(this->spheres[range.first]),mesh->getSpheres(),numInstances * sizeof(struct sphereInstance));
+		}
+		else{
+			memcpy(&(this->cylinders[range.first]),mesh->getCylinders(),numInstances * sizeof(struct cylinderInstance));
+		}
+	}
+	this->instancesDirty[type] = true;
+	ranges[mesh] = range;
+	return &(ranges[mesh]);
+}
+
+//more unused instances than live ones, the buffer is rebuilt from the meshes
+//drawn this frame and the others are added again when they come back
+void DrawPool::compactInstances(InstanceType type){
+	this->instances[type].clear();
+	if(type == SPHERE_INSTANCE) this->spheres.clear();
+	else this->cylinders.clear();
+	this->unusedInstances[type] = 0;
+	int numMeshes = this->frameMeshes.size();
+	for(int i = 0; i < numMeshes; i++){
+		if(this->frameMeshes[i].first->getInstanceType() == type){
+			this->addInstances(this->frameMeshes[i].first);
+		}
+	}
+	this->instancesDirty[type] = true;
+}
+
+void DrawPool::uploadBuffer(GLenum target, GLuint* buffer, const void* data, GLsizeiptr size, GLenum usage){
+	if(*buffer == 0){
+		glGenBuffers(1,buffer);
+	}
+	glBindBuffer(target,*buffer);
+	glBufferData(target,size,data,usage);
+	this->uploadedBytes += size;
+}
+
+//meshes come in draw list order, so meshes sharing a material are already
+//next to each other and each run becomes one group
+void DrawPool::upload(FrameRing* ring){
+	this->uploadedBytes = 0;
+	this->commands.clear();
+	this->draws.clear();
+	this->groups.clear();
+	int numMeshes = this->frameMeshes.size();
+	for(int i = 0; i < numMeshes; i++){
+		this->addInstances(this->frameMeshes[i].first);
+	}
+	for(int type = 0; type < 2; type++){
+		int size = type == SPHERE_INSTANCE ? this->spheres.size() : this->cylinders.size();
+		if(this->unusedInstances[type] > size - this->unusedInstances[type]){
+			this->compactInstances((InstanceType)type);
+		}
+	}
+	for(int i = 0; i < numMeshes; i++){
+		InstancedMesh* mesh = this->frameMeshes[i].first;
+		Material* material = this->frameMeshes[i].second;
+		PoolRange geometry = this->addGeometry(mesh->getGeometry());
+		PoolRange instances = &(this->instances[mesh->getInstanceType()][mesh]);
+		if(geometry->count == 0 || instances->count == 0) continue;
+		if(this->groups.empty() || this->groups.back().material != material){
+			struct drawGroup group;
+			group.material = material;
+			group.type = mesh->getInstanceType();
+			group.firstDraw = this->commands.size();
+			group.numDraws = 0;
+			group.numInstances = 0;
+			group.maxDrawInstances = 0;
+			this->groups.push_back(group);
+		}
+		struct drawCommand command;
+		command.count = geometry->count;
+		command.instanceCount = instances->count;
+		command.firstIndex = geometry->first;
+		command.baseVertex = geometry->baseVertex;
+		command.baseInstance = instances->first;
+		this->commands.push_back(command);
+		//row major like the rest of the renderer, the shader wants columns
+		struct drawData draw;
+		const GLfloat* m = mesh->getModelMatrix()->getElements();
+		for(int row = 0; row < 4; row++){
+			for(int column = 0; column < 4; column++){
+				draw.modelMatrix[column*4 + row] = m[row*4 + column];
+			}
+		}
+		draw.scale = sqrt(m[0]*m[0] + m[4]*m[4] + m[8]*m[8]);
+		draw.padding[0] = 0;
+		draw.padding[1] = 0;
+		draw.padding[2] = 0;
+		this->draws.push_back(draw);
+		this->groups.back().numDraws++;
+		this->groups.back().numInstances += instances->count;
+		if(instances->count > this->groups.back().maxDrawInstances){
+			this->groups.back().maxDrawInstances = instances->count;
+		}
+	}
+	if(this->geometryDirty){
+		this->uploadBuffer(GL_ARRAY_BUFFER,&(this->vertexBuffer),&(this->vertices[0]),
+		                   this->vertices.size() * sizeof(GLfloat),GL_STATIC_DRAW);
+		//indices go through another target, binding the element buffer
+		//would change whatever vertex array is bound. draws add the base
+		//vertex, so 16 bits do as long as every geometry fits in them
+		if(this->elementType == GL_UNSIGNED_INT){
+			this->uploadBuffer(GL_COPY_WRITE_BUFFER,&(this->elementBuffer),this->elements.empty() ? NULL : &(this->elements[0]),
+			                   this->elements.size() * sizeof(GLuint),GL_STATIC_DRAW);
+		}
+		else{
+			vector<GLushort> shortElements(this->elements.begin(),this->elements.end());
+			this->uploadBuffer(GL_COPY_WRITE_BUFFER,&(this->elementBuffer),shortElements.empty() ? NULL : &(shortElements[0]),
+			                   shortElements.size() * sizeof(GLushort),GL_STATIC_DRAW);
+		}
+		if(this->vertexArray == 0){
+			this->vertexArray = GLProgram::makeVertexArray(this->vertexBuffer,this->elementBuffer);
+		}
+		this->geometryDirty = false;
+	}
+	if(this->instancesDirty[SPHERE_INSTANCE] && !this->spheres.empty()){
+		this->uploadBuffer(GL_ARRAY_BUFFER,&(this->instanceBuffers[SPHERE_INSTANCE]),&(this->spheres[0]),
+		                   this->spheres.size() * sizeof(struct sphereInstance),GL_STATIC_DRAW);
+		this->instancesDirty[SPHERE_INSTANCE] = false;
+	}
+	if(this->instancesDirty[CYLINDER_INSTANCE] && !this->cylinders.empty()){
+		this->uploadBuffer(GL_ARRAY_BUFFER,&(this->instanceBuffers[CYLINDER_INSTANCE]),&(this->cylinders[0]),
+		                   this->cylinders.size() * sizeof(struct cylinderInstance),GL_STATIC_DRAW);
+		this->instancesDirty[CYLINDER_INSTANCE] = false;
+	}
+	if(this->commands.empty()) return;
+	//the ring may move to a bigger buffer on any allocation, the buffer is
+	//read right after each one
+	GLsizeiptr size = this->commands.size() * sizeof(struct drawCommand);
+	memcpy(ring->allocate(size,&(this->commandOffset)),&(this->commands[0]),size);
+	ring->flush(this->commandOffset,size);
+	this->uploadedBytes += size;
+	this->commandBuffer = ring->getBuffer();
+	GLintptr offset;
+	size = this->draws.size() * sizeof(struct drawData);
+	memcpy(ring->allocate(size,&offset),&(this->draws[0]),size);
+	ring->bind(GL_SHADER_STORAGE_BUFFER,DRAW_DATA_BINDING,offset,size);
+	this->uploadedBytes += size;
+}
+
+int DrawPool::getNumGroups(){
+	return this->groups.size();
+}
+
+DrawGroup DrawPool::getGroup(int index){
+	return &(this->groups[index]);
+}
+
+int DrawPool::getNumDraws(){
+	return this->commands.size();
+}
+
+int DrawPool::getUploadedBytes(){
+	return this->uploadedBytes;
+}
+
+GLuint DrawPool::getVertexBuffer(){
+	return this->vertexBuffer;
+}
+
+GLuint DrawPool::getElementBuffer(){
+	return this->elementBuffer;
+}
+
+//the shared buffers with the vertex layout every multi draw program reads
+GLuint DrawPool::getVertexArray(){
+	return this->vertexArray;
+}
+
+//type of the uploaded indices, the widest any pooled geometry needs
+GLenum DrawPool::getElementType(){
+	return this->elementType;
+}
+
+GLuint DrawPool::getInstanceBuffer(InstanceType type){
+	return this->instanceBuffers[type];
+}
+
+//size of the instance buffer in instances, unused ranges included
+int DrawPool::getNumInstances(InstanceType type){
+	return type == SPHERE_INSTANCE ? this->spheres.size() : this->cylinders.size();
+}
+
+GLuint DrawPool::getCommandBuffer(){
+	return this->commandBuffer;
+}
+
+//commands start here in the command buffer, which is shared with the rest
+//of the frame
+GLintptr DrawPool::getCommandOffset(){
+	return this->commandOffset;
+}
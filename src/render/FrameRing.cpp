@@ -0,0 +1,157 @@
+#include "render/FrameRing.h"
+
+FrameRing::FrameRing(){
+	this->buffer = 0;
+	this->data = NULL;
+	this->regionSize = 0;
+	this->alignment = 0;
+	this->frame = 0;
+	this->offset = 0;
+	this->persistent = false;
+	this->waits = 0;
+	for(int i = 0; i < FRAME_RING_FRAMES; i++){
+		this->fences[i] = 0;
+	}
+}
+
+FrameRing::~FrameRing(){
+	for(int i = 0; i < FRAME_RING_FRAMES; i++){
+		if(this->fences[i] != 0) glDeleteSync(this->fences[i]);
+	}
+	for(unsigned int i = 0; i < this->retiredBuffers.size(); i++){
+		this->release(this->retiredBuffers[i],this->retiredData[i]);
+	}
+	if(this->buffer != 0){
+		this->release(this->buffer,this->data);
+	}
+}
+
+//regions start at offsets valid for uniform and shader storage bindings
+void FrameRing::create(GLsizeiptr regionSize){
+	if(this->alignment == 0){
+		GLint uniformAlignment = 1;
+		GLint storageAlignment = 1;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&uniformAlignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,&storageAlignment);
+		this->alignment = uniformAlignment > storageAlignment ? uniformAlignment : storageAlignment;
+		if(this->alignment < 1) this->alignment = 1;
+		this->persistent = FrameRing::isPersistentSupported();
+	}
+	this->regionSize = (regionSize + this->alignment - 1) / this->alignment * this->alignment;
+	GLsizeiptr size = this->regionSize * FRAME_RING_FRAMES;
+	glGenBuffers(1,&(this->buffer));
+	glBindBuffer(GL_COPY_WRITE_BUFFER,this->buffer);
+	if(this->persistent){
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER,size,NULL,flags);
+		this->data = (GLubyte*)glMapBufferRange(GL_COPY_WRITE_BUFFER,0,size,flags);
+	}
+	else{
+		glBufferData(GL_COPY_WRITE_BUFFER,size,NULL,GL_STREAM_DRAW);
+		this->data = new GLubyte[size];
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+	this->offset = 0;
+}
+
+//deleting a mapped buffer unmaps it, the gpu keeps the storage alive until
+//the draws reading it are done
+void FrameRing::release(GLuint buffer, GLubyte* data){
+	if(!this->persistent) delete[] data;
+	glDeleteBuffers(1,&buffer);
+}
+
+//the frame keeps what it already wrote in the old buffer and goes on in a
+//new one twice as big. the fences are kept, no region of the new buffer is
+//in use yet but they still pace the frames
+void FrameRing::grow(GLsizeiptr size){
+	this->retiredBuffers.push_back(this->buffer);
+	this->retiredData.push_back(this->data);
+	GLsizeiptr regionSize = this->regionSize * 2;
+	while(regionSize < size) regionSize *= 2;
+	this->create(regionSize);
+}
+
+//waits for the gpu only when it is still reading the region from
+//FRAME_RING_FRAMES frames ago, so the cpu is never further ahead than that
+void FrameRing::begin(){
+	if(this->buffer == 0){
+		this->create(FRAME_RING_INITIAL_SIZE);
+	}
+	for(unsigned int i = 0; i < this->retiredBuffers.size(); i++){
+		this->release(this->retiredBuffers[i],this->retiredData[i]);
+	}
+	this->retiredBuffers.clear();
+	this->retiredData.clear();
+	GLsync fence = this->fences[this->frame];
+	if(fence != 0){
+		if(glClientWaitSync(fence,0,0) == GL_TIMEOUT_EXPIRED){
+			this->waits++;
+			while(glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000000) == GL_TIMEOUT_EXPIRED);
+		}
+		glDeleteSync(fence);
+		this->fences[this->frame] = 0;
+	}
+	this->offset = 0;
+}
+
+//size bytes for the caller to write this frame, offset is where they are
+//in the buffer. the memory may be write combined, it should not be read
+void* FrameRing::allocate(GLsizeiptr size, GLintptr* offset){
+	GLsizeiptr start = (this->offset + this->alignment - 1) / this->alignment * this->alignment;
+	if(start + size > this->regionSize){
+		this->grow(size);
+		start = 0;
+	}
+	this->offset = start + size;
+	*offset = this->frame * this->regionSize + start;
+	return this->data + *offset;
+}
+
+//written data reaches the buffer by itself when it is mapped, otherwise it
+//is uploaded here, before anything else is allocated
+void FrameRing::flush(GLintptr offset, GLsizeiptr size){
+	if(this->persistent) return;
+	glBindBuffer(GL_COPY_WRITE_BUFFER,this->buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER,offset,size,this->data + offset);
+	glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+}
+
+void FrameRing::bind(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size){
+	this->flush(offset,size);
+	glBindBufferRange(target,index,this->buffer,offset,size);
+}
+
+//after the last draw reading this frame's region
+void FrameRing::end(){
+	if(this->persistent){
+		this->fences[this->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+	}
+	this->frame = (this->frame + 1) % FRAME_RING_FRAMES;
+}
+
+GLuint FrameRing::getBuffer(){
+	return this->buffer;
+}
+
+GLsizeiptr FrameRing::getRegionSize(){
+	return this->regionSize;
+}
+
+//bytes written in the current frame so far
+GLsizeiptr FrameRing::getUsedBytes(){
+	return this->offset;
+}
+
+bool FrameRing::isPersistent(){
+	return this->persistent;
+}
+
+//frames that found the gpu still reading their region
+int FrameRing::getWaits(){
+	return this->waits;
+}
+
+bool FrameRing::isPersistentSupported(){
+	return GLEW_ARB_buffer_storage;
+}
@@ -1,16 +1,26 @@
 #include "render/GLProgram.h"
+#include "object/Geometry.h"
 #include <cstdio>
 #include <string.h>
 
 GLProgram::GLProgram(){
 	this->vertexShader =0;
     this->fragmentShader=0;
+    this->tessControlShader = 0;
+    this->tessEvaluationShader = 0;
 	this->program=0;
+    this->retrievable = false;
+    this->attrInstancePosition = -1;
+    this->attrInstanceEnd = -1;
+    this->attrInstanceOffset = -1;
+    this->attrInstanceMaterial = -1;
+    this->attrInstanceEndMaterial = -1;
     this->uniforms = new struct uniforms;
     this->uniforms->unifModelMatrix = 0;
     this->uniforms->unifBlockMatrices =0;
     this->uniforms->unifBlockDirectionalLights=0;
     this->uniforms->unifBlockAmbientLight =0;
+    this->uniforms->unifFirstDraw = -1;
 }
 
 GLuint GLProgram::getVertexShader(){
@@ -79,12 +89,27 @@ GLuint GLProgram::compileShader(GLenum type, char* source){
     return shader;
 }
 
+//names a shader does not declare are ignored
+void GLProgram::bindAttributeLocations(GLuint program){
+    glBindAttribLocation(program, ATTRIBUTE_POSITION, "position");
+    glBindAttribLocation(program, ATTRIBUTE_NORMAL, "normal");
+    glBindAttribLocation(program, ATTRIBUTE_INSTANCE_POSITION, "instancePosition");
+    glBindAttribLocation(program, ATTRIBUTE_INSTANCE_END, "instanceEnd");
+    glBindAttribLocation(program, ATTRIBUTE_INSTANCE_OFFSET, "instanceOffset");
+    glBindAttribLocation(program, ATTRIBUTE_INSTANCE_MATERIAL, "instanceMaterial");
+    glBindAttribLocation(program, ATTRIBUTE_INSTANCE_END_MATERIAL, "instanceEndMaterial");
+}
+
 GLuint GLProgram::linkProgram(GLuint vertexShader, GLuint fragmentShader){
 	GLint programOk;
 
     GLuint program = glCreateProgram();
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
+    GLProgram::bindAttributeLocations(program);
+    if(this->retrievable){
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
     glGetProgramiv(program, GL_LINK_STATUS, &programOk);
     if (!programOk) {
@@ -122,6 +147,46 @@ void GLProgram::setAttrNormal(GLuint attrNormal){
     this->attrNormal = attrNormal;
 }
 
+GLuint GLProgram::getAttrInstancePosition(){
+    return this->attrInstancePosition;
+}
+
+void GLProgram::setAttrInstancePosition(GLuint attrInstancePosition){
+    this->attrInstancePosition = attrInstancePosition;
+}
+
+GLuint GLProgram::getAttrInstanceEnd(){
+    return this->attrInstanceEnd;
+}
+
+void GLProgram::setAttrInstanceEnd(GLuint attrInstanceEnd){
+    this->attrInstanceEnd = attrInstanceEnd;
+}
+
+GLuint GLProgram::getAttrInstanceOffset(){
+    return this->attrInstanceOffset;
+}
+
+void GLProgram::setAttrInstanceOffset(GLuint attrInstanceOffset){
+    this->attrInstanceOffset = attrInstanceOffset;
+}
+
+GLuint GLProgram::getAttrInstanceMaterial(){
+    return this->attrInstanceMaterial;
+}
+
+void GLProgram::setAttrInstanceMaterial(GLuint attrInstanceMaterial){
+    this->attrInstanceMaterial = attrInstanceMaterial;
+}
+
+GLuint GLProgram::getAttrInstanceEndMaterial(){
+    return this->attrInstanceEndMaterial;
+}
+
+void GLProgram::setAttrInstanceEndMaterial(GLuint attrInstanceEndMaterial){
+    this->attrInstanceEndMaterial = attrInstanceEndMaterial;
+}
+
 Uniforms GLProgram::getUniforms(){
     return this->uniforms;
 }
@@ -158,6 +223,26 @@ GLuint GLProgram::linkProgramTessellation(GLuint vertexShader, GLuint fragmentSh
     glAttachShader(program, tessControlShader);
     glAttachShader(program, tessEvaluationShader);
     glAttachShader(program, fragmentShader);
+    GLProgram::bindAttributeLocations(program);
+    if(this->retrievable){
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &programOk);
+    if (!programOk) {
+        fprintf(stderr, "Failed to link shader program:\n");
+        show_info_log(program, glGetProgramiv, glGetProgramInfoLog);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GLuint GLProgram::linkProgramCompute(GLuint computeShader){
+    GLint programOk;
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, computeShader);
     glLinkProgram(program);
     glGetProgramiv(program, GL_LINK_STATUS, &programOk);
     if (!programOk) {
@@ -169,4 +254,75 @@ GLuint GLProgram::linkProgramTessellation(GLuint vertexShader, GLuint fragmentSh
     return program;
 }
 
+//programs linked after this can be read back with glGetProgramBinary
+void GLProgram::setRetrievable(bool retrievable){
+    this->retrievable = retrievable;
+}
+
+//a binary from another driver or version fails to load, the caller then
+//compiles the sources, so nothing is logged
+GLuint GLProgram::loadProgramBinary(GLenum format, const void* binary, GLsizei length){
+    GLint programOk;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary, length);
+    glGetProgramiv(program, GL_LINK_STATUS, &programOk);
+    if (!programOk) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+//every input any material uses, the ones a shader lacks resolve to -1 and
+//the renderer skips them. the uniform blocks go to the binding points the
+//renderer fills: matrices, directional lights, ambient light, point lights
+//and the material table
+void GLProgram::findLocations(){
+    GLuint prog = this->program;
+    this->attrPosition = glGetAttribLocation(prog, "position");
+    this->attrNormal = glGetAttribLocation(prog, "normal");
+    this->attrInstancePosition = glGetAttribLocation(prog, "instancePosition");
+    this->attrInstanceEnd = glGetAttribLocation(prog, "instanceEnd");
+    this->attrInstanceOffset = glGetAttribLocation(prog, "instanceOffset");
+    this->attrInstanceMaterial = glGetAttribLocation(prog, "instanceMaterial");
+    this->attrInstanceEndMaterial = glGetAttribLocation(prog, "instanceEndMaterial");
+    this->uniforms->unifModelMatrix = glGetUniformLocation(prog,"modelMatrix");
+    this->uniforms->unifDiffuseColor = glGetUniformLocation(prog,"material.diffuseColor");
+    //the point material has a plain color uniform
+    if(this->uniforms->unifDiffuseColor == (GLuint)-1){
+        this->uniforms->unifDiffuseColor = glGetUniformLocation(prog,"diffuseColor");
+    }
+    this->uniforms->unifSpecularColor = glGetUniformLocation(prog,"material.specularColor");
+    this->uniforms->unifShininess = glGetUniformLocation(prog,"material.shininess");
+    this->uniforms->unifDistanceToCamera = glGetUniformLocation(prog,"distanceToCamera");
+    this->uniforms->unifFirstDraw = glGetUniformLocation(prog,"firstDraw");
+    const char* blockNames[5] = {"globalMatrices","directionalLights","ambLight","pointLights","materialTable"};
+    GLuint* blocks[5] = {&(this->uniforms->unifBlockMatrices),&(this->uniforms->unifBlockDirectionalLights),
+                         &(this->uniforms->unifBlockAmbientLight),&(this->uniforms->unifBlockPointLights),
+                         &(this->uniforms->unifBlockMaterialTable)};
+    for(int binding = 0; binding < 5; binding++){
+        *(blocks[binding]) = glGetUniformBlockIndex(prog,blockNames[binding]);
+        if(*(blocks[binding]) != GL_INVALID_INDEX){
+            glUniformBlockBinding(prog,*(blocks[binding]),binding);
+        }
+    }
+}
 
+//positions and normals interleaved like Geometry keeps them, read from the
+//locations every program binds. the element buffer is part of the vertex
+//array, so drawing only needs the vertex array bound
+GLuint GLProgram::makeVertexArray(GLuint vertexBuffer, GLuint elementBuffer){
+    GLuint vertexArray;
+    GLsizei stride = GEOMETRY_VERTEX_SIZE * sizeof(GLfloat);
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+    glVertexAttribPointer(ATTRIBUTE_NORMAL, 3, GL_FLOAT, GL_FALSE, stride, (void*)(GEOMETRY_NORMAL_OFFSET * sizeof(GLfloat)));
+    glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+    glBindVertexArray(0);
+    return vertexArray;
+}
\ No newline at end of file
@@ -0,0 +1,405 @@
+#include "render/InstanceCuller.h"
+#include <cmath>
+#include <cstring>
+
+//copies the commands of the pool with no instances, the cull pass counts
+//the survivors back in
+static const char* resetShader =
+	"#version 430\n\
+	layout(local_size_x = 64) in;\n\
+	struct DrawCommand{\n\
+		uint count;\n\
+		uint instanceCount;\n\
+		uint firstIndex;\n\
+		int baseVertex;\n\
+		uint baseInstance;\n\
+	};\n\
+	layout(std430, binding = 2) readonly buffer commandBlock{\n\
+		DrawCommand commands[];\n\
+	};\n\
+	layout(std430, binding = 3) writeonly buffer outputCommandBlock{\n\
+		DrawCommand outputCommands[];\n\
+	};\n\
+	uniform int numDraws;\n\
+	void main(){\n\
+		int draw = int(gl_GlobalInvocationID.x);\n\
+		if(draw >= numDraws) return;\n\
+		DrawCommand command = commands[draw];\n\
+		command.instanceCount = 0u;\n\
+		outputCommands[draw] = command;\n\
+	}";
+
+//one invocation per instance, work groups along y are the draws of a
+//group, instances are copied as raw words so both layouts share the code
+static const char* cullShader =
+	"#version 430\n\
+	layout(local_size_x = 64) in;\n\
+	struct DrawCommand{\n\
+		uint count;\n\
+		uint instanceCount;\n\
+		uint firstIndex;\n\
+		int baseVertex;\n\
+		uint baseInstance;\n\
+	};\n\
+	struct DrawData{\n\
+		mat4 modelMatrix;\n\
+		float scale;\n\
+	};\n\
+	layout(std430, binding = 0) readonly buffer drawBlock{\n\
+		DrawData draws[];\n\
+	};\n\
+	layout(std430, binding = 2) readonly buffer commandBlock{\n\
+		DrawCommand commands[];\n\
+	};\n\
+	layout(std430, binding = 3) buffer outputCommandBlock{\n\
+		DrawCommand outputCommands[];\n\
+	};\n\
+	layout(std430, binding = 4) readonly buffer instanceBlock{\n\
+		uint instances[];\n\
+	};\n\
+	layout(std430, binding = 5) writeonly buffer outputInstanceBlock{\n\
+		uint outputInstances[];\n\
+	};\n\
+	uniform int firstDraw;\n\
+	uniform bool cylinders;\n\
+	uniform vec4 frustumPlanes[6];\n\
+	uniform bool occlusion;\n\
+	uniform mat4 pyramidViewProjection;\n\
+	uniform int pyramidLevels;\n\
+	layout(binding = 0) uniform sampler2D depthPyramid;\n\
+	\n\
+	float word(uint index){\n\
+		return uintBitsToFloat(instances[index]);\n\
+	}\n\
+	\n\
+	vec3 vector(uint index){\n\
+		return vec3(word(index),word(index + 1u),word(index + 2u));\n\
+	}\n\
+	\n\
+	//the box around the sphere as the previous frame saw it, hidden when\n\
+	//its nearest depth is behind everything drawn under it\n\
+	bool occluded(vec3 center, float radius){\n\
+		vec3 ndcMin = vec3(1.0);\n\
+		vec3 ndcMax = vec3(-1.0);\n\
+		for(int i = 0; i < 8; i++){\n\
+			vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0,(i & 2) != 0 ? 1.0 : -1.0,(i & 4) != 0 ? 1.0 : -1.0);\n\
+			vec4 clip = pyramidViewProjection * vec4(corner,1.0);\n\
+			if(clip.w <= 0.0) return false;\n\
+			vec3 ndc = clip.xyz / clip.w;\n\
+			ndcMin = i == 0 ? ndc : min(ndcMin,ndc);\n\
+			ndcMax = i == 0 ? ndc : max(ndcMax,ndc);\n\
+		}\n\
+		if(ndcMin.z < -1.0) return false;\n\
+		vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5,0.0,1.0);\n\
+		vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5,0.0,1.0);\n\
+		//the level where the box spans at most two texels each way\n\
+		ivec2 baseSize = textureSize(depthPyramid,0);\n\
+		vec2 size = (uvMax - uvMin) * vec2(baseSize);\n\
+		int level = clamp(int(ceil(log2(max(max(size.x,size.y),1.0)))),0,pyramidLevels - 1);\n\
+		//sized like glTexStorage2D, textureSize of a level is not reliable\n\
+		//on every driver\n\
+		ivec2 levelSize = max(baseSize >> level,ivec2(1));\n\
+		ivec2 first = min(ivec2(uvMin * vec2(levelSize)),levelSize - 1);\n\
+		ivec2 last = min(ivec2(uvMax * vec2(levelSize)),levelSize - 1);\n\
+		float depth = 0.0;\n\
+		for(int y = first.y; y <= last.y; y++){\n\
+			for(int x = first.x; x <= last.x; x++){\n\
+				depth = max(depth,texelFetch(depthPyramid,ivec2(x,y),level).r);\n\
+			}\n\
+		}\n\
+		return ndcMin.z * 0.5 + 0.5 > depth;\n\
+	}\n\
+	\n\
+	void main(){\n\
+		int draw = firstDraw + int(gl_WorkGroupID.y);\n\
+		uint index = gl_GlobalInvocationID.x;\n\
+		DrawCommand command = commands[draw];\n\
+		if(index >= command.instanceCount) return;\n\
+		uint stride = cylinders ? 12u : 5u;\n\
+		uint source = (command.baseInstance + index) * stride;\n\
+		vec3 center = vector(source);\n\
+		float radius = word(source + 3u);\n\
+		if(cylinders){\n\
+			vec3 end = vector(source + 4u);\n\
+			radius += length(end - center) * 0.5;\n\
+			center = (center + end) * 0.5 + vector(source + 8u);\n\
+		}\n\
+		DrawData data = draws[draw];\n\
+		center = (data.modelMatrix * vec4(center,1.0)).xyz;\n\
+		radius *= data.scale;\n\
+		for(int i = 0; i < 6; i++){\n\
+			if(dot(frustumPlanes[i].xyz,center) + frustumPlanes[i].w < -radius) return;\n\
+		}\n\
+		if(occlusion && occluded(center,radius)) return;\n\
+		uint slot = atomicAdd(outputCommands[draw].instanceCount,1u);\n\
+		uint destination = (command.baseInstance + slot) * stride;\n\
+		for(uint i = 0u; i < stride; i++){\n\
+			outputInstances[destination + i] = instances[source + i];\n\
+		}\n\
+	}";
+
+//farthest depth of the source texels under each destination texel, odd
+//sizes make the last texel cover an extra row or column
+static const char* pyramidShader =
+	"#version 430\n\
+	layout(local_size_x = 8, local_size_y = 8) in;\n\
+	layout(binding = 0) uniform sampler2D source;\n\
+	layout(r32f, binding = 0) writeonly uniform image2D destination;\n\
+	uniform int sourceLevel;\n\
+	uniform ivec2 sourceSize;\n\
+	uniform ivec2 destinationSize;\n\
+	void main(){\n\
+		ivec2 texel = ivec2(gl_GlobalInvocationID.xy);\n\
+		if(any(greaterThanEqual(texel,destinationSize))) return;\n\
+		ivec2 first = texel * sourceSize / destinationSize;\n\
+		ivec2 last = ((texel + 1) * sourceSize - 1) / destinationSize;\n\
+		float depth = 0.0;\n\
+		for(int y = first.y; y <= last.y; y++){\n\
+			for(int x = first.x; x <= last.x; x++){\n\
+				depth = max(depth,texelFetch(source,ivec2(x,y),sourceLevel).r);\n\
+			}\n\
+		}\n\
+		imageStore(destination,texel,vec4(depth));\n\
+	}";
+
+InstanceCuller::InstanceCuller(){
+	this->resetProgram = InstanceCuller::makeProgram(resetShader);
+	this->cullProgram = InstanceCuller::makeProgram(cullShader);
+	this->pyramidProgram = InstanceCuller::makeProgram(pyramidShader);
+	this->commandBuffer = 0;
+	this->commandBufferSize = 0;
+	this->numDraws = 0;
+	for(int type = 0; type < 2; type++){
+		this->instanceBuffers[type] = 0;
+		this->instanceBufferSizes[type] = 0;
+	}
+	this->depthTexture = 0;
+	this->depthFramebuffer = 0;
+	this->pyramidTexture = 0;
+	this->depthFormat = GL_NONE;
+	this->width = 0;
+	this->height = 0;
+	this->pyramidLevels = 0;
+	this->hasPyramid = false;
+	this->occlusion = true;
+}
+
+InstanceCuller::~InstanceCuller(){
+	GLProgram* programs[3] = {this->resetProgram,this->cullProgram,this->pyramidProgram};
+	for(int i = 0; i < 3; i++){
+		glDeleteShader(programs[i]->getVertexShader());
+		glDeleteProgram(programs[i]->getProgram());
+		delete programs[i];
+	}
+	GLuint buffers[3] = {this->commandBuffer,this->instanceBuffers[0],this->instanceBuffers[1]};
+	for(int i = 0; i < 3; i++){
+		if(buffers[i] != 0) glDeleteBuffers(1,&(buffers[i]));
+	}
+	if(this->depthFramebuffer != 0) glDeleteFramebuffers(1,&(this->depthFramebuffer));
+	if(this->depthTexture != 0) glDeleteTextures(1,&(this->depthTexture));
+	if(this->pyramidTexture != 0) glDeleteTextures(1,&(this->pyramidTexture));
+}
+
+//compute programs keep their only shader in the vertex shader slot
+GLProgram* InstanceCuller::makeProgram(const char* source){
+	GLProgram* program = new GLProgram();
+	GLuint shader = program->compileShader(GL_COMPUTE_SHADER,(char*)source);
+	program->setVertexShader(shader);
+	program->setProgram(program->linkProgramCompute(shader));
+	return program;
+}
+
+//buffers only grow, a smaller frame reuses the storage
+void InstanceCuller::reserveBuffer(GLuint* buffer, GLsizeiptr* bufferSize, GLsizeiptr size){
+	if(*buffer == 0){
+		glGenBuffers(1,buffer);
+	}
+	if(size <= *bufferSize) return;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER,*buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER,size,NULL,GL_DYNAMIC_COPY);
+	*bufferSize = size;
+}
+
+//writes the culled commands and instances for every group of the pool, the
+//pool must have uploaded this frame already
+void InstanceCuller::cull(DrawPool* pool, const Frustum& frustum){
+	int numDraws = pool->getNumDraws();
+	this->numDraws = numDraws;
+	if(numDraws == 0) return;
+	this->reserveBuffer(&(this->commandBuffer),&(this->commandBufferSize),numDraws * sizeof(struct drawCommand));
+	this->reserveBuffer(&(this->instanceBuffers[SPHERE_INSTANCE]),&(this->instanceBufferSizes[SPHERE_INSTANCE]),
+	                    pool->getNumInstances(SPHERE_INSTANCE) * sizeof(struct sphereInstance));
+	this->reserveBuffer(&(this->instanceBuffers[CYLINDER_INSTANCE]),&(this->instanceBufferSizes[CYLINDER_INSTANCE]),
+	                    pool->getNumInstances(CYLINDER_INSTANCE) * sizeof(struct cylinderInstance));
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER,CULL_COMMAND_BINDING,pool->getCommandBuffer(),
+	                  pool->getCommandOffset(),numDraws * sizeof(struct drawCommand));
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER,CULL_OUTPUT_COMMAND_BINDING,this->commandBuffer);
+
+	GLuint prog = this->resetProgram->getProgram();
+	glUseProgram(prog);
+	glUniform1i(glGetUniformLocation(prog,"numDraws"),numDraws);
+	glDispatchCompute((numDraws + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE,1,1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	prog = this->cullProgram->getProgram();
+	glUseProgram(prog);
+	GLfloat planes[24];
+	for(int i = 0; i < 6; i++){
+		memcpy(planes + i*4,frustum.getPlane(i),sizeof(GLfloat) * 4);
+	}
+	glUniform4fv(glGetUniformLocation(prog,"frustumPlanes"),6,planes);
+	bool occlusion = this->occlusion && this->hasPyramid;
+	glUniform1i(glGetUniformLocation(prog,"occlusion"),occlusion);
+	if(occlusion){
+		glUniformMatrix4fv(glGetUniformLocation(prog,"pyramidViewProjection"),1,GL_TRUE,
+		                   this->pyramidViewProjection.getElements());
+		glUniform1i(glGetUniformLocation(prog,"pyramidLevels"),this->pyramidLevels);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D,this->pyramidTexture);
+	}
+	GLint unifFirstDraw = glGetUniformLocation(prog,"firstDraw");
+	GLint unifCylinders = glGetUniformLocation(prog,"cylinders");
+	int numGroups = pool->getNumGroups();
+	for(int i = 0; i < numGroups; i++){
+		DrawGroup group = pool->getGroup(i);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,CULL_INSTANCE_BINDING,pool->getInstanceBuffer(group->type));
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER,CULL_OUTPUT_INSTANCE_BINDING,this->instanceBuffers[group->type]);
+		glUniform1i(unifFirstDraw,group->firstDraw);
+		glUniform1i(unifCylinders,group->type == CYLINDER_INSTANCE);
+		glDispatchCompute((group->maxDrawInstances + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE,group->numDraws,1);
+	}
+	//the draws read the results as commands and vertex attributes
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+//the copy of the depth buffer has to match its format to be blit, the
+//default framebuffer names its attachments differently
+static GLint attachmentParameter(GLint framebuffer, GLenum attachment, GLenum parameter){
+	if(framebuffer == 0){
+		attachment = attachment == GL_DEPTH_ATTACHMENT ? GL_DEPTH : GL_STENCIL;
+	}
+	GLint type = GL_NONE;
+	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER,attachment,GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE,&type);
+	if(type == GL_NONE) return 0;
+	GLint value = 0;
+	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER,attachment,parameter,&value);
+	return value;
+}
+
+static GLenum depthFormatOf(GLint framebuffer){
+	GLint depthBits = attachmentParameter(framebuffer,GL_DEPTH_ATTACHMENT,GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE);
+	GLint stencilBits = attachmentParameter(framebuffer,GL_STENCIL_ATTACHMENT,GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE);
+	if(depthBits == 0) return GL_NONE;
+	bool floating = attachmentParameter(framebuffer,GL_DEPTH_ATTACHMENT,GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE) == GL_FLOAT;
+	if(stencilBits > 0) return floating ? GL_DEPTH32F_STENCIL8 : GL_DEPTH24_STENCIL8;
+	if(floating) return GL_DEPTH_COMPONENT32F;
+	if(depthBits == 32) return GL_DEPTH_COMPONENT32;
+	return depthBits == 24 ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT16;
+}
+
+void InstanceCuller::resizePyramid(GLint width, GLint height, GLenum depthFormat){
+	if(this->depthTexture != 0) glDeleteTextures(1,&(this->depthTexture));
+	if(this->pyramidTexture != 0) glDeleteTextures(1,&(this->pyramidTexture));
+	if(this->depthFramebuffer == 0) glGenFramebuffers(1,&(this->depthFramebuffer));
+	this->width = width;
+	this->height = height;
+	this->depthFormat = depthFormat;
+	this->pyramidLevels = 1;
+	while((width >> this->pyramidLevels) > 0 || (height >> this->pyramidLevels) > 0){
+		this->pyramidLevels++;
+	}
+	glGenTextures(1,&(this->depthTexture));
+	glBindTexture(GL_TEXTURE_2D,this->depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D,1,depthFormat,width,height);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+	glGenTextures(1,&(this->pyramidTexture));
+	glBindTexture(GL_TEXTURE_2D,this->pyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D,this->pyramidLevels,GL_R32F,width,height);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+	bool stencil = depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER,this->depthFramebuffer);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+	                       GL_TEXTURE_2D,this->depthTexture,0);
+}
+
+//called once the frame is drawn, the next frame tests its instances
+//against this depth seen through this view
+void InstanceCuller::buildDepthPyramid(const Mat4& viewProjection){
+	GLint viewport[4];
+	GLint framebuffer;
+	glGetIntegerv(GL_VIEWPORT,viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING,&framebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER,framebuffer);
+	GLenum depthFormat = depthFormatOf(framebuffer);
+	this->hasPyramid = false;
+	if(depthFormat == GL_NONE || viewport[2] <= 0 || viewport[3] <= 0) return;
+	if(viewport[2] != this->width || viewport[3] != this->height || depthFormat != this->depthFormat){
+		this->resizePyramid(viewport[2],viewport[3],depthFormat);
+	}
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER,this->depthFramebuffer);
+	glBlitFramebuffer(viewport[0],viewport[1],viewport[0] + this->width,viewport[1] + this->height,
+	                  0,0,this->width,this->height,GL_DEPTH_BUFFER_BIT,GL_NEAREST);
+	GLenum error = glGetError();
+	glBindFramebuffer(GL_FRAMEBUFFER,framebuffer);
+	//a failed copy would leave a depth that hides everything
+	if(error != GL_NO_ERROR) return;
+
+	GLuint prog = this->pyramidProgram->getProgram();
+	glUseProgram(prog);
+	GLint unifSourceLevel = glGetUniformLocation(prog,"sourceLevel");
+	GLint unifSourceSize = glGetUniformLocation(prog,"sourceSize");
+	GLint unifDestinationSize = glGetUniformLocation(prog,"destinationSize");
+	glActiveTexture(GL_TEXTURE0);
+	//level 0 is a copy of the depth, every other level halves the previous
+	GLint sourceWidth = this->width;
+	GLint sourceHeight = this->height;
+	for(int level = 0; level < this->pyramidLevels; level++){
+		GLint levelWidth = this->width >> level > 0 ? this->width >> level : 1;
+		GLint levelHeight = this->height >> level > 0 ? this->height >> level : 1;
+		glBindTexture(GL_TEXTURE_2D,level == 0 ? this->depthTexture : this->pyramidTexture);
+		glBindImageTexture(0,this->pyramidTexture,level,GL_FALSE,0,GL_WRITE_ONLY,GL_R32F);
+		glUniform1i(unifSourceLevel,level == 0 ? 0 : level - 1);
+		glUniform2i(unifSourceSize,sourceWidth,sourceHeight);
+		glUniform2i(unifDestinationSize,levelWidth,levelHeight);
+		glDispatchCompute((levelWidth + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+		                  (levelHeight + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		sourceWidth = levelWidth;
+		sourceHeight = levelHeight;
+	}
+	glBindTexture(GL_TEXTURE_2D,0);
+	this->pyramidViewProjection = viewProjection;
+	this->hasPyramid = true;
+}
+
+//instances the last cull kept, waits for the gpu so it is only meant for
+//checking the pass
+int InstanceCuller::readVisibleInstances(){
+	if(this->numDraws == 0) return 0;
+	vector<struct drawCommand> commands(this->numDraws);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER,this->commandBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER,0,this->numDraws * sizeof(struct drawCommand),&(commands[0]));
+	int visible = 0;
+	for(int i = 0; i < this->numDraws; i++){
+		visible += commands[i].instanceCount;
+	}
+	return visible;
+}
+
+GLuint InstanceCuller::getCommandBuffer(){
+	return this->commandBuffer;
+}
+
+GLuint InstanceCuller::getInstanceBuffer(InstanceType type){
+	return this->instanceBuffers[type];
+}
+
+bool InstanceCuller::getOcclusion(){
+	return this->occlusion;
+}
+
+void InstanceCuller::setOcclusion(bool occlusion){
+	this->occlusion = occlusion;
+}
@@ -0,0 +1,257 @@
+#include "render/ProgramCache.h"
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+ProgramCache* ProgramCache::instance = NULL;
+
+ProgramCache::ProgramCache(){
+	this->compiles = 0;
+	this->hits = 0;
+	this->loads = 0;
+	this->directory = PROGRAM_CACHE_DIRECTORY;
+	this->diskCache = false;
+	this->driverChecked = false;
+}
+
+ProgramCache* ProgramCache::getInstance(){
+	if(ProgramCache::instance == NULL){
+		ProgramCache::instance = new ProgramCache();
+	}
+	return ProgramCache::instance;
+}
+
+//every stage is tagged and sized, so the same text in another stage or a
+//missing stage gives another key
+string ProgramCache::keySources(const char* vertexSource, const char* fragmentSource,
+                                const char* tessControlSource, const char* tessEvaluationSource){
+	const char* sources[4] = {vertexSource,fragmentSource,tessControlSource,tessEvaluationSource};
+	string key;
+	char tag[32];
+	for(int stage = 0; stage < 4; stage++){
+		if(sources[stage] == NULL) continue;
+		sprintf(tag,"%d:%d:",stage,(int)strlen(sources[stage]));
+		key += tag;
+		key += sources[stage];
+	}
+	return key;
+}
+
+//64 bit FNV-1a
+unsigned long long ProgramCache::hashSources(const string& sources){
+	unsigned long long hash = 14695981039346656037ULL;
+	for(unsigned int i = 0; i < sources.size(); i++){
+		hash ^= (unsigned char)sources[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//binaries only load on the driver that saved them, so the vendor, renderer
+//and version are part of the file name and checked when loading. drivers
+//that have no binary formats get no disk cache
+void ProgramCache::checkDriver(){
+	if(this->driverChecked) return;
+	this->driverChecked = true;
+	this->diskCache = false;
+	this->driver.clear();
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+	if(formats == 0 || this->directory.empty()) return;
+	GLenum names[3] = {GL_VENDOR,GL_RENDERER,GL_VERSION};
+	for(int i = 0; i < 3; i++){
+		const GLubyte* name = glGetString(names[i]);
+		if(name != NULL) this->driver += (const char*)name;
+		this->driver += '\n';
+	}
+#ifdef _WIN32
+	_mkdir(this->directory.c_str());
+#else
+	mkdir(this->directory.c_str(),0755);
+#endif
+	this->diskCache = true;
+}
+
+string ProgramCache::binaryPath(const string& sources){
+	char name[32];
+	sprintf(name,"/%016llx.bin",ProgramCache::hashSources(sources + this->driver));
+	return this->directory + name;
+}
+
+//a missing, truncated or mismatched file returns 0 and the program is
+//compiled from its sources
+GLuint ProgramCache::loadBinary(GLProgram* program, const string& sources){
+	if(!this->diskCache) return 0;
+	FILE* file = fopen(this->binaryPath(sources).c_str(),"rb");
+	if(file == NULL) return 0;
+	GLuint prog = 0;
+	struct programBinaryHeader header;
+	if(fread(&header,sizeof(header),1,file) == 1 && header.magic == PROGRAM_BINARY_MAGIC &&
+	   header.version == PROGRAM_BINARY_VERSION &&
+	   header.sourcesLength == sources.size() && header.driverLength == this->driver.size() && header.length > 0){
+		string fileSources(header.sourcesLength,'\0');
+		string fileDriver(header.driverLength,'\0');
+		char* binary = new char[header.length];
+		if(fread(&fileSources[0],1,header.sourcesLength,file) == header.sourcesLength &&
+		   fread(&fileDriver[0],1,header.driverLength,file) == header.driverLength &&
+		   fread(binary,1,header.length,file) == (size_t)header.length &&
+		   fileSources == sources && fileDriver == this->driver){
+			prog = program->loadProgramBinary(header.format,binary,header.length);
+		}
+		delete[] binary;
+	}
+	fclose(file);
+	return prog;
+}
+
+//written to a temporary file first so another run never reads half a file
+void ProgramCache::saveBinary(GLuint prog, const string& sources){
+	if(!this->diskCache) return;
+	GLint length = 0;
+	glGetProgramiv(prog,GL_PROGRAM_BINARY_LENGTH,&length);
+	if(length <= 0) return;
+	char* binary = new char[length];
+	struct programBinaryHeader header;
+	memset(&header,0,sizeof(header));
+	glGetProgramBinary(prog,length,&length,&(header.format),binary);
+	header.magic = PROGRAM_BINARY_MAGIC;
+	header.version = PROGRAM_BINARY_VERSION;
+	header.sourcesLength = sources.size();
+	header.driverLength = this->driver.size();
+	header.length = length;
+	string path = this->binaryPath(sources);
+	string temporary = path + ".tmp";
+	FILE* file = fopen(temporary.c_str(),"wb");
+	if(file != NULL){
+		bool written = fwrite(&header,sizeof(header),1,file) == 1 &&
+		               fwrite(sources.data(),1,sources.size(),file) == sources.size() &&
+		               fwrite(this->driver.data(),1,this->driver.size(),file) == this->driver.size() &&
+		               fwrite(binary,1,length,file) == (size_t)length;
+		written = fclose(file) == 0 && written;
+#ifdef _WIN32
+		if(written) remove(path.c_str());
+#endif
+		written = written && rename(temporary.c_str(),path.c_str()) == 0;
+		if(!written) remove(temporary.c_str());
+	}
+	delete[] binary;
+}
+
+//a hash shared by different sources or a program that fails to link is
+//not cached, the program is built for the caller alone and deleted when it
+//is released. failed sources are compiled again the next time
+GLProgram* ProgramCache::findProgram(const char* vertexSource, const char* fragmentSource,
+                                     const char* tessControlSource, const char* tessEvaluationSource){
+	string sources = ProgramCache::keySources(vertexSource,fragmentSource,tessControlSource,tessEvaluationSource);
+	unsigned long long hash = ProgramCache::hashSources(sources);
+	map<unsigned long long,struct cachedProgram>::iterator it = this->programs.find(hash);
+	if(it != this->programs.end() && it->second.sources == sources){
+		it->second.references++;
+		this->hits++;
+		return it->second.program;
+	}
+	GLProgram* program = new GLProgram();
+	this->checkDriver();
+	GLuint prog = this->loadBinary(program,sources);
+	if(prog != 0){
+		this->loads++;
+	}
+	else{
+		GLuint vertexShader = program->compileShader(GL_VERTEX_SHADER,(char*)vertexSource);
+		GLuint fragmentShader = program->compileShader(GL_FRAGMENT_SHADER,(char*)fragmentSource);
+		program->setVertexShader(vertexShader);
+		program->setFragmentShader(fragmentShader);
+		program->setRetrievable(this->diskCache);
+		if(tessControlSource != NULL){
+			GLuint tessControlShader = program->compileShader(GL_TESS_CONTROL_SHADER,(char*)tessControlSource);
+			GLuint tessEvaluationShader = program->compileShader(GL_TESS_EVALUATION_SHADER,(char*)tessEvaluationSource);
+			program->setTessControlShader(tessControlShader);
+			program->setTessEvaluationShader(tessEvaluationShader);
+			prog = program->linkProgramTessellation(vertexShader,fragmentShader,tessControlShader,tessEvaluationShader);
+		}
+		else{
+			prog = program->linkProgram(vertexShader,fragmentShader);
+		}
+		if(prog != 0){
+			this->saveBinary(prog,sources);
+		}
+		this->compiles++;
+	}
+	program->setProgram(prog);
+	if(prog == 0) return program;
+	program->findLocations();
+	if(it == this->programs.end()){
+		struct cachedProgram entry;
+		entry.program = program;
+		entry.sources = sources;
+		entry.references = 1;
+		this->programs[hash] = entry;
+	}
+	return program;
+}
+
+GLProgram* ProgramCache::getProgram(const char* vertexSource, const char* fragmentSource){
+	return this->findProgram(vertexSource,fragmentSource,NULL,NULL);
+}
+
+GLProgram* ProgramCache::getTessellationProgram(const char* vertexSource, const char* fragmentSource,
+                                                const char* tessControlSource, const char* tessEvaluationSource){
+	return this->findProgram(vertexSource,fragmentSource,tessControlSource,tessEvaluationSource);
+}
+
+void ProgramCache::deleteProgram(GLProgram* program){
+	GLuint shaders[4] = {program->getVertexShader(),program->getFragmentShader(),
+	                     program->getTessControlShader(),program->getTessEvaluationShader()};
+	for(int i = 0; i < 4; i++){
+		if(shaders[i] != 0) glDeleteShader(shaders[i]);
+	}
+	if(program->getProgram() != 0) glDeleteProgram(program->getProgram());
+	delete program;
+}
+
+//programs the cache does not know, like ones given to Material::setProgram,
+//are deleted right away
+void ProgramCache::releaseProgram(GLProgram* program){
+	if(program == NULL) return;
+	map<unsigned long long,struct cachedProgram>::iterator it = this->programs.begin();
+	for(;it != this->programs.end();it++){
+		if(it->second.program != program) continue;
+		it->second.references--;
+		if(it->second.references == 0){
+			ProgramCache::deleteProgram(program);
+			this->programs.erase(it);
+		}
+		return;
+	}
+	ProgramCache::deleteProgram(program);
+}
+
+//where binaries are saved, NULL turns the disk cache off. programs built
+//before this keep their binaries where they were
+void ProgramCache::setDirectory(const char* directory){
+	this->directory = directory != NULL ? directory : "";
+	this->driverChecked = false;
+}
+
+int ProgramCache::getNumPrograms(){
+	return this->programs.size();
+}
+
+//programs compiled and linked from their sources so far
+int ProgramCache::getCompiles(){
+	return this->compiles;
+}
+
+//programs handed out without compiling
+int ProgramCache::getHits(){
+	return this->hits;
+}
+
+//programs loaded from binaries saved by an earlier run
+int ProgramCache::getLoads(){
+	return this->loads;
+}
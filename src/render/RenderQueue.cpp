@@ -0,0 +1,92 @@
+#include "render/RenderQueue.h"
+#include <cstring>
+
+//ids are handed out in the order things are first seen, they only have to
+//keep equal states together, two states sharing an id after it wraps are
+//still told apart by the renderer
+template<class T> static unsigned int stateId(map<T*,unsigned int>& ids, T* state, int bits){
+	typename map<T*,unsigned int>::iterator it = ids.find(state);
+	if(it != ids.end()) return it->second;
+	unsigned int id = ids.size() & ((1u << bits) - 1);
+	ids[state] = id;
+	return id;
+}
+
+//positive floats sort like their bit patterns, the top bits of the
+//pattern are a coarse logarithmic depth
+unsigned long long RenderQueue::makeKey(unsigned int pass, unsigned int program, unsigned int geometry, unsigned int material, float depth){
+	unsigned int depthBits = 0;
+	if(depth > 0){
+		memcpy(&depthBits,&depth,sizeof(float));
+		depthBits >>= 31 - RENDER_KEY_DEPTH_BITS;
+	}
+	unsigned long long key = pass & ((1u << RENDER_KEY_PASS_BITS) - 1);
+	key = (key << RENDER_KEY_PROGRAM_BITS) | (program & ((1u << RENDER_KEY_PROGRAM_BITS) - 1));
+	key = (key << RENDER_KEY_GEOMETRY_BITS) | (geometry & ((1u << RENDER_KEY_GEOMETRY_BITS) - 1));
+	key = (key << RENDER_KEY_MATERIAL_BITS) | (material & ((1u << RENDER_KEY_MATERIAL_BITS) - 1));
+	key = (key << RENDER_KEY_DEPTH_BITS) | (depthBits & ((1u << RENDER_KEY_DEPTH_BITS) - 1));
+	return key;
+}
+
+void RenderQueue::clear(){
+	this->items.clear();
+}
+
+//instanced runs are merged regardless of distance, they get no depth
+void RenderQueue::add(Mesh* mesh, int pass){
+	Material* material = mesh->getMaterial();
+	struct renderItem item;
+	item.key = RenderQueue::makeKey(
+		pass,
+		stateId(this->programIds,material->getProgram(),RENDER_KEY_PROGRAM_BITS),
+		stateId(this->geometryIds,mesh->getGeometry(),RENDER_KEY_GEOMETRY_BITS),
+		stateId(this->materialIds,material,RENDER_KEY_MATERIAL_BITS),
+		pass == RENDER_PASS_OPAQUE ? mesh->getDistanceToCamera() : 0
+	);
+	item.mesh = mesh;
+	this->items.push_back(item);
+}
+
+//least significant digit first radix sort, digits every key shares are
+//skipped so a frame with few states only pays for the depth passes
+void RenderQueue::sort(){
+	int numItems = this->items.size();
+	if(numItems < 2) return;
+	this->sortBuffer.resize(numItems);
+	struct renderItem* source = &(this->items[0]);
+	struct renderItem* destination = &(this->sortBuffer[0]);
+	const int numBuckets = 1 << RENDER_RADIX_BITS;
+	const int keyBits = RENDER_KEY_PASS_BITS + RENDER_KEY_PROGRAM_BITS + RENDER_KEY_GEOMETRY_BITS +
+	                    RENDER_KEY_MATERIAL_BITS + RENDER_KEY_DEPTH_BITS;
+	for(int shift = 0; shift < keyBits; shift += RENDER_RADIX_BITS){
+		int counts[numBuckets];
+		memset(counts,0,sizeof(counts));
+		for(int i = 0; i < numItems; i++){
+			counts[(source[i].key >> shift) & (numBuckets - 1)]++;
+		}
+		if(counts[(source[0].key >> shift) & (numBuckets - 1)] == numItems) continue;
+		int offset = 0;
+		for(int b = 0; b < numBuckets; b++){
+			int count = counts[b];
+			counts[b] = offset;
+			offset += count;
+		}
+		for(int i = 0; i < numItems; i++){
+			destination[counts[(source[i].key >> shift) & (numBuckets - 1)]++] = source[i];
+		}
+		struct renderItem* temp = source;
+		source = destination;
+		destination = temp;
+	}
+	if(source != &(this->items[0])){
+		memcpy(&(this->items[0]),source,numItems * sizeof(struct renderItem));
+	}
+}
+
+int RenderQueue::getNumItems(){
+	return this->items.size();
+}
+
+RenderItem RenderQueue::getItems(){
+	return this->items.empty() ? NULL : &(this->items[0]);
+}
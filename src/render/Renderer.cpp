@@ -5,9 +5,37 @@
 #include "object/Mesh.h"
 #include "scene/Scene.h"
 #include "material/PointMaterial.h"
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+
+Renderer::Renderer() :
+	matricesBlock(0,sizeof(GLfloat) * 32),
+	directionalLightsBlock(1,sizeof(struct dirLightsChunk)),
+	ambientLightBlock(2,sizeof(GLfloat) * 4),
+	pointLightsBlock(3,sizeof(struct pLightsChunk)),
+	materialTableBlock(MATERIAL_TABLE_BINDING,sizeof(struct materialStruct) * MATERIAL_TABLE_SIZE){
+	this->instancing = true;
+	this->culling = true;
+	this->multiDraw = false;
+	this->gpuCulling = false;
+	this->instanceCuller = NULL;
+	this->currentProgram = NULL;
+	this->currentGeometry = NULL;
+	this->currentMaterial = NULL;
+	this->camera = NULL;
+	this->cameraVersion = 0;
+	this->cameraChanged = false;
+	this->ambientLight = NULL;
+	this->ambientLightVersion = 0;
+	this->materialTableVersion = 0;
+	memset(&(this->stats),0,sizeof(struct renderStats));
+}
 
-Renderer::Renderer(){
-	this->vao=0;
+Renderer::~Renderer(){
+	if(this->instanceCuller != NULL){
+		delete this->instanceCuller;
+	}
 }
 
 GLuint Renderer::makeBuffer(GLenum target, void* bufferData, GLsizei bufferSize){
@@ -17,14 +45,6 @@ GLuint Renderer::makeBuffer(GLenum target, void* bufferData, GLsizei bufferSize)
 	glBufferData(target,bufferSize,bufferData, GL_STATIC_DRAW);
 	return buffer;
 }
-GLuint Renderer::makeUBO(void* bufferData, GLsizei bufferSize){
-	GLuint buf;
-	glGenBuffers(1,&buf);
-	glBindBuffer(GL_UNIFORM_BUFFER,buf);
-	glBufferData(GL_UNIFORM_BUFFER,bufferSize,bufferData, GL_STREAM_DRAW);
-	return buf;
-}
-
 GLuint Renderer::makePointBuffer(GLenum target, void* bufferData, GLsizei bufferSize){
 	GLuint buffer;
 	glGenBuffers(1,&buffer);
@@ -33,160 +53,115 @@ GLuint Renderer::makePointBuffer(GLenum target, void* bufferData, GLsizei buffer
 	return buffer;
 }
 
-void Renderer::calculateDirectionalLights(Scene* scene){
-	int bufferSize = sizeof(struct dirLightsChunk);
-	if(scene->getDirectionalLightsUBO() == 0){
-		GLuint buf = makeUBO(NULL, bufferSize);
-		scene->setDirectionalLightsUBO(buf);
-		glBindBufferRange(
-			GL_UNIFORM_BUFFER,//target
-			1,//binding point
-			buf,//data
-			0,//offset
-			bufferSize//size in bytes
-		);
-	}
-	GLint numLights = scene->getDirectionalLights().size();
-	list<DirectionalLight*> lights = scene->getDirectionalLights();
-	list<DirectionalLight*>::iterator itLights = lights.begin();
-	list<DirectionalLight*>::iterator endLights = lights.end();
-	struct dirLightsChunk chunk;
-	chunk.numDirLights = numLights;
-	for(int i=0;itLights != endLights && i<10 ;itLights++ , i++){
-		DirLight light = (*itLights)->getAsStruct(scene->getCamera());
-		memcpy(&(chunk.lights[i]),light,sizeof(struct dirLight));
-		delete light;
+//the lights in order with the version each had, true when they differ from
+//the ones seen last time, which are then replaced
+template<class T> static bool updateLightVersions(list<T*>& lights, vector<pair<Light*,unsigned int> >& versions){
+	bool changed = lights.size() != versions.size();
+	versions.resize(lights.size());
+	typename list<T*>::iterator it = lights.begin();
+	for(int i = 0; it != lights.end(); it++, i++){
+		unsigned int version = (*it)->getVersion();
+		if(versions[i].first != *it || versions[i].second != version){
+			versions[i] = make_pair((Light*)(*it),version);
+			changed = true;
+		}
 	}
+	return changed;
+}
 
-	glBindBuffer(GL_UNIFORM_BUFFER,scene->getDirectionalLightsUBO());
-	glBufferSubData(GL_UNIFORM_BUFFER,0,bufferSize,&chunk);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+//light positions are in view space, a camera change rewrites them too
+void Renderer::calculateDirectionalLights(Scene* scene){
+	list<DirectionalLight*>& lights = scene->getDirectionalLights();
+	bool changed = updateLightVersions(lights,this->directionalLightVersions);
+	if(changed || this->cameraChanged){
+		DirLightsChunk chunk = (DirLightsChunk)this->directionalLightsBlock.map();
+		list<DirectionalLight*>::iterator itLights = lights.begin();
+		list<DirectionalLight*>::iterator endLights = lights.end();
+		chunk->numDirLights = lights.size();
+		for(int i=0;itLights != endLights && i<10 ;itLights++ , i++){
+			(*itLights)->getAsStruct(scene->getCamera(),&(chunk->lights[i]));
+		}
+		this->directionalLightsBlock.unmap();
+		this->stats.uploadedBytes += this->directionalLightsBlock.getSize();
+	}
+	this->directionalLightsBlock.bind();
 }
 
 void Renderer::calculatePointLights(Scene* scene){
-	//static GLuint bufPoint =0;
-	int bufferSize = sizeof(struct pLightsChunk);
-	if(scene->getPointLightsUBO() == 0){
-		GLuint buf = makeUBO(NULL, bufferSize);
-		scene->setPointLightsUBO(buf);
-		glBindBufferRange(
-			GL_UNIFORM_BUFFER,//target
-			3,//binding point
-			buf,//data
-			0,//offset
-			bufferSize//size in bytes
-		);
-	}
-	GLint numLights = scene->getPointLights().size();
-	list<PointLight*> lights = scene->getPointLights();
-	list<PointLight*>::iterator itLights = lights.begin();
-	list<PointLight*>::iterator endLights = lights.end();
-	struct pLightsChunk chunk;
-	chunk.numPLights = numLights;
-
-	/*PointMaterial pMat = PointMaterial();
-	pMat.getDiffuseColor()->setRGB(0.0,0.0,0.0);
-	if(bufPoint == 0){
-		bufPoint = this->makePointBuffer(
-			GL_ARRAY_BUFFER,
-			NULL,
-			3 * sizeof(GLfloat)
-		);
-	}
-	glBindBuffer(GL_ARRAY_BUFFER,bufPoint);
-	glVertexAttribPointer(
-		pMat.getProgram()->getAttrPosition(),//attribute from prgram(position)
-		3,//number of components per vertex
-		GL_FLOAT,//type of data
-		GL_FALSE,//normalized
-		0,//separation between 2 values
-		(void*)0 //offset
-	);
-	glEnableVertexAttribArray(pMat.getProgram()->getAttrPosition());
-	glUseProgram(pMat.getProgram()->getProgram());
-	GLfloat* diffuseColor = pMat.getDiffuseColor()->getAsArray();
-	glUniform4fv(
-		pMat.getProgram()->getUniforms()->unifDiffuseColor,
-		1,
-		diffuseColor
-	);
-	delete diffuseColor;
-	GLfloat pos[3];*/
-
-	for(int i=0;itLights != endLights && i<10 ;itLights++ , i++){
-		PLight light = (*itLights)->getAsStruct(scene->getCamera());
-		memcpy(&(chunk.lights[i]),light,sizeof(struct pLight));
-		delete light;
-		/*pos[0] = (*itLights)->getPosition()->getX();
-		pos[1] = (*itLights)->getPosition()->getY();
-		pos[2] = (*itLights)->getPosition()->getZ();
-		glBufferSubData(GL_ARRAY_BUFFER,0,sizeof(GLfloat)*3,&pos);
-		glDrawArrays(GL_POINTS,0,1);*/
+	list<PointLight*>& lights = scene->getPointLights();
+	bool changed = updateLightVersions(lights,this->pointLightVersions);
+	if(changed || this->cameraChanged){
+		PLightsChunk chunk = (PLightsChunk)this->pointLightsBlock.map();
+		list<PointLight*>::iterator itLights = lights.begin();
+		list<PointLight*>::iterator endLights = lights.end();
+		chunk->numPLights = lights.size();
+		for(int i=0;itLights != endLights && i<10 ;itLights++ , i++){
+			(*itLights)->getAsStruct(scene->getCamera(),&(chunk->lights[i]));
+		}
+		this->pointLightsBlock.unmap();
+		this->stats.uploadedBytes += this->pointLightsBlock.getSize();
 	}
-	/*glDisableVertexAttribArray(pMat.getProgram()->getAttrPosition());
-	delete pMat;
-	delete[] pos;*/
-	glBindBuffer(GL_UNIFORM_BUFFER,scene->getPointLightsUBO());
-	glBufferSubData(GL_UNIFORM_BUFFER,0,bufferSize,&chunk);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	this->pointLightsBlock.bind();
 }
 
 void Renderer::calculateAmbientLights(Scene* scene){
-	if(scene->getAmbientLightUBO() == 0){
-		GLfloat* data = scene->getAmbientLight()->getColor()->getAsArray();
-		GLuint buf = makeUBO(data,sizeof(GLfloat)*4);
-		scene->setAmbientLightUBO(buf);
-		glBindBufferRange(
-			GL_UNIFORM_BUFFER,//target
-			2,//binding point
-			buf,//data
-			0,//offset
-			sizeof(GLfloat) * 4//size in bytes
-		);
-		delete[] data;
+	Light* light = scene->getAmbientLight();
+	if(light != this->ambientLight || light->getVersion() != this->ambientLightVersion){
+		GLfloat* data = (GLfloat*)this->ambientLightBlock.map();
+		light->getColor()->getAsArray(data);
+		this->ambientLightBlock.unmap();
+		this->stats.uploadedBytes += this->ambientLightBlock.getSize();
+		this->ambientLight = light;
+		this->ambientLightVersion = light->getVersion();
 	}
+	this->ambientLightBlock.bind();
 }
 
 void Renderer::calculateGlobalMatrices(Scene* scene){
-	//update UBO TODO: update world matrix only as projection never changes
-	scene->getCamera()->updateWorldMatrix();
-	GLfloat* data = scene->getCamera()->getMatricesArray();
-	if(scene->getCamera()->getMatricesUBO()==0){	
-		GLuint buf = makeUBO(data,sizeof(GLfloat)*32);
-		scene->getCamera()->setMatricesUBO(buf);
-		glBindBufferRange(
-			GL_UNIFORM_BUFFER,//target
-			0,//binding point
-			buf,//data
-			0,//offset
-			sizeof(GLfloat) * 32//size in bytes
-		);
-	}else{
-		glBindBuffer(GL_UNIFORM_BUFFER,scene->getCamera()->getMatricesUBO());
-		glBufferSubData(GL_UNIFORM_BUFFER,0,sizeof(GLfloat)*32, data);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	Camera* camera = scene->getCamera();
+	camera->updateWorldMatrix();
+	this->cameraChanged = camera != this->camera || camera->getVersion() != this->cameraVersion;
+	if(this->cameraChanged){
+		camera->getMatricesArray((GLfloat*)this->matricesBlock.map());
+		this->matricesBlock.unmap();
+		this->stats.uploadedBytes += this->matricesBlock.getSize();
+		this->camera = camera;
+		this->cameraVersion = camera->getVersion();
 	}
-	delete[] data;
+	this->matricesBlock.bind();
+}
+
+//the table is shared by every scene, rows are only added or edited
+void Renderer::updateMaterialTable(){
+	MaterialTable* table = MaterialTable::getInstance();
+	unsigned int version = table->getVersion();
+	if(version != this->materialTableVersion){
+		table->write((MaterialStruct)this->materialTableBlock.map());
+		this->materialTableBlock.unmap();
+		this->stats.uploadedBytes += this->materialTableBlock.getSize();
+		this->materialTableVersion = version;
+	}
+	this->materialTableBlock.bind();
 }
 
 void Renderer::setMaterialUniforms(Material* material){
 	//set diffuse color
-	GLfloat* diffuseColor = material->getDiffuseColor()->getAsArray();
+	GLfloat diffuseColor[4];
+	material->getDiffuseColor()->getAsArray(diffuseColor);
 	glUniform4fv(
 		material->getProgram()->getUniforms()->unifDiffuseColor,
 		1,
 		diffuseColor
 	);
-	delete diffuseColor;
 
 	//set specular color
-	GLfloat* specularColor = material->getSpecularColor()->getAsArray();
+	GLfloat specularColor[4];
+	material->getSpecularColor()->getAsArray(specularColor);
 	glUniform4fv(
 		material->getProgram()->getUniforms()->unifSpecularColor,
 		1,
 		specularColor
 	);
-	delete specularColor;
 
 	//set shininess
 	GLfloat shininess = material->getShininess();
@@ -195,203 +170,483 @@ void Renderer::setMaterialUniforms(Material* material){
 		1,
 		&shininess
 	);
+	this->stats.uniformUploads += 3;
 }
 
-void Renderer::render(Scene * scene){
-	list<Object3D*> objects = scene->getObjects();
-	list<Object3D*>::iterator it = objects.begin();
-	list<Object3D*>::iterator end = objects.end();
-	//vao initialization;
-	if(this->vao == 0){
-		glGenVertexArrays(1, &(this->vao));
-		glBindVertexArray(this->vao);
+//the element buffer is made through another target, binding it would
+//change whatever vertex array is bound
+void Renderer::makeGeometryBuffers(Geometry* geometry){
+	if(geometry->getVertexBuffer() == 0 && geometry->getVertices() != NULL){
+		GLuint buf = this->makeBuffer(GL_ARRAY_BUFFER,
+						geometry->getVertices(),
+						geometry->getNumVertices() * GEOMETRY_VERTEX_SIZE * sizeof(GLfloat)
+						);
+        geometry->setVertexBuffer(buf);
+	}
+	if(geometry->getElementBuffer() == 0 && geometry->getElements() != NULL){
+		GLuint buf = this->makeBuffer(GL_COPY_WRITE_BUFFER,
+						geometry->getElements(),
+						geometry->getNumElements() * geometry->getElementSize()
+						);
+        geometry->setElementBuffer(buf);
 	}
+	if(geometry->getVertexArray() == 0 && geometry->getVertexBuffer() != 0){
+		geometry->setVertexArray(GLProgram::makeVertexArray(geometry->getVertexBuffer(),geometry->getElementBuffer()));
+	}
+}
 
-	//AmbientLight UBO
-	this->calculateAmbientLights(scene);
+//attribute pointers and the element buffer are all in the vertex array
+void Renderer::bindGeometry(Geometry* geometry){
+	glBindVertexArray(geometry->getVertexArray());
+	this->stats.bufferBinds++;
+}
 
-	//Camera UBO initialization
-	this->calculateGlobalMatrices(scene);
+void Renderer::useProgram(GLProgram* program){
+	glUseProgram(program->getProgram());
+	this->stats.programBinds++;
+}
 
-	//DirectionalLightsUBO
+//the instanced paths bind their own state, whatever follows them starts over
+void Renderer::resetState(){
+	this->currentProgram = NULL;
+	this->currentGeometry = NULL;
+	this->currentMaterial = NULL;
+}
 
-	this->calculateDirectionalLights(scene);
+static GLsizei instanceStride(InstanceType type){
+	return type == SPHERE_INSTANCE ? sizeof(struct sphereInstance) : sizeof(struct cylinderInstance);
+}
 
-	//PointLightsUBO
+static void setInstanceAttribute(GLuint attribute, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLintptr offset){
+	if(attribute == (GLuint)-1) return;
+	glVertexAttribPointer(attribute,size,type,normalized,stride,(void*)offset);
+	glVertexAttribDivisor(attribute,1);
+	glEnableVertexAttribArray(attribute);
+}
 
-	this->calculatePointLights(scene);
+//material rows are read as integers, not converted to floats
+static void setInstanceIntegerAttribute(GLuint attribute, GLint size, GLenum type, GLsizei stride, GLintptr offset){
+	if(attribute == (GLuint)-1) return;
+	glVertexAttribIPointer(attribute,size,type,stride,(void*)offset);
+	glVertexAttribDivisor(attribute,1);
+	glEnableVertexAttribArray(attribute);
+}
 
-	for(;it != end;it++){
-		Mesh* mesh= (Mesh*)(*it);
-		if(!mesh->getVisible()) continue;
-		if(mesh->getGeometry()->getVertexBuffer() == 0 && mesh->getGeometry()->getVertices() != NULL){
-			GLuint buf = this->makeBuffer(GL_ARRAY_BUFFER,
-							mesh->getGeometry()->getVertices(),
-							mesh->getGeometry()->getNumVertices() * sizeof(GLfloat)
-							);
-            mesh->getGeometry()->setVertexBuffer(buf);
-		}
-		if(mesh->getGeometry()->getElementBuffer() == 0 && mesh->getGeometry()->getElements() != NULL){
-			GLuint buf = this->makeBuffer(GL_ELEMENT_ARRAY_BUFFER,
-							mesh->getGeometry()->getElements(),
-							mesh->getGeometry()->getNumElements() * sizeof(GLushort)
-							);
-            mesh->getGeometry()->setElementBuffer(buf);
-		}
-		if(mesh->getGeometry()->getNormalBuffer() == 0 && mesh->getGeometry()->getNormals() != NULL){
-			GLuint buf = this->makeBuffer(GL_ELEMENT_ARRAY_BUFFER,
-							mesh->getGeometry()->getNormals(),
-							mesh->getGeometry()->getNumNormals() * sizeof(GLfloat)
-							);
-            mesh->getGeometry()->setNormalBuffer(buf);
-		}
-		//set vertex attribute
-		glBindBuffer(GL_ARRAY_BUFFER,mesh->getGeometry()->getVertexBuffer());
-		glVertexAttribPointer(
-			mesh->getMaterial()->getProgram()->getAttrPosition(),//attribute from prgram(position)
-			3,//number of components per vertex
-			GL_FLOAT,//type of data
-			GL_FALSE,//normalized
-			0,//separation between 2 values
-			(void*)0 //offset
-		);
-		glEnableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrPosition());
-
-		//set normal attribute
-		if(mesh->getGeometry()->getNormalBuffer() != 0){
-			glBindBuffer(GL_ARRAY_BUFFER,mesh->getGeometry()->getNormalBuffer());
-			glVertexAttribPointer(
-				mesh->getMaterial()->getProgram()->getAttrNormal(),//attribute from prgram(position)
-				3,//number of components per vertex
-				GL_FLOAT,//type of data
-				GL_FALSE,//normalized
-				0,//separation between 2 values
-				(void*)0 //offset
-			);
-			glEnableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrNormal());
-		}
-		
-		glUseProgram(mesh->getMaterial()->getProgram()->getProgram());
-
-		//set model matrix
-		mesh->updateModelMatrix();
-		glUniformMatrix4fv(
-			mesh->getMaterial()->getProgram()->getUniforms()->unifModelMatrix,
-			1,
-			GL_TRUE,
-			mesh->getModelMatrix()->getElements()
-		);
-		GLfloat dist = mesh->getDistanceToCamera();
-		glUniform1fv(
-			mesh->getMaterial()->getProgram()->getUniforms()->unifDistanceToCamera,
-			1,
-			&dist
-		);
-		//set material uniforms
-		setMaterialUniforms(mesh->getMaterial());
-		
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,mesh->getGeometry()->getElementBuffer());
-		if(mesh->getMaterial()->getType() == TESS_MATERIAL){
-			glPatchParameteri(GL_PATCH_VERTICES, 3);
-			glDrawElements(
-				GL_PATCHES, //drawing mode
-				mesh->getGeometry()->getNumElements(), //count
-				GL_UNSIGNED_SHORT, //type,
-				(void*)0 //offset
-			);
+static void resetInstanceAttribute(GLuint attribute){
+	if(attribute == (GLuint)-1) return;
+	glVertexAttribDivisor(attribute,0);
+	glDisableVertexAttribArray(attribute);
+}
+
+bool Renderer::isInstanced(Material* material){
+	return material->getType() == INSTANCED_MATERIAL || material->getType() == IMPOSTOR_MATERIAL;
+}
+
+//instances are stored in the mesh's local space, bring them to world space
+//so meshes with different model matrices can share one draw call
+void Renderer::appendInstances(InstancedMesh* mesh){
+	mesh->updateModelMatrix();
+	GLfloat* m = mesh->getModelMatrix()->getElements();
+	//row major, the scale is uniform so any basis column gives it
+	GLfloat scale = sqrt(m[0]*m[0] + m[4]*m[4] + m[8]*m[8]);
+	int numInstances = mesh->getNumInstances();
+	if(numInstances == 0) return;
+	//copy the instances as they are, then transform the positions in place
+	//with the batched kernel striding over the interleaved records
+	if(mesh->getInstanceType() == SPHERE_INSTANCE){
+		int first = this->sphereData.size();
+		this->sphereData.resize(first + numInstances);
+		SphereInstance spheres = &(this->sphereData[first]);
+		memcpy(spheres,mesh->getSpheres(),numInstances * sizeof(struct sphereInstance));
+		int stride = sizeof(struct sphereInstance) / sizeof(GLfloat);
+		Mat4::transformPoints(*(mesh->getModelMatrix()),spheres->position,spheres->position,numInstances,stride);
+		for(int i = 0; i < numInstances; i++){
+			spheres[i].radius *= scale;
 		}
-		else{
-			glDrawElements(
-				GL_TRIANGLES, //drawing mode
-				mesh->getGeometry()->getNumElements(), //count
-				GL_UNSIGNED_SHORT, //type,
-				(void*)0 //offset
-			);
+	}
+	else{
+		int first = this->cylinderData.size();
+		this->cylinderData.resize(first + numInstances);
+		CylinderInstance cylinders = &(this->cylinderData[first]);
+		memcpy(cylinders,mesh->getCylinders(),numInstances * sizeof(struct cylinderInstance));
+		int stride = sizeof(struct cylinderInstance) / sizeof(GLfloat);
+		Mat4::transformPoints(*(mesh->getModelMatrix()),cylinders->start,cylinders->start,numInstances,stride);
+		Mat4::transformPoints(*(mesh->getModelMatrix()),cylinders->end,cylinders->end,numInstances,stride);
+		Mat4::transformPoints(*(mesh->getModelMatrix()),cylinders->offset,cylinders->offset,numInstances,stride,0);
+		for(int i = 0; i < numInstances; i++){
+			cylinders[i].radius *= scale;
 		}
-		
-		glDisableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrPosition());
 	}
-	//this->renderOctreeNode(scene->getOctree());
 }
 
-void Renderer::renderOctreeNode(OctreeNode* node){
-
-	Mesh* mesh = node->getBoundingBox();
-	if(mesh->getGeometry()->getVertexBuffer() == 0 && mesh->getGeometry()->getVertices() != NULL){
-		GLuint buf = this->makeBuffer(GL_ARRAY_BUFFER,
-						mesh->getGeometry()->getVertices(),
-						mesh->getGeometry()->getNumVertices() * sizeof(GLfloat)
-						);
-        mesh->getGeometry()->setVertexBuffer(buf);
+//instances go to the frame ring, offset is where they start in its buffer.
+//they are built in memory first, the ring may be write combined and the
+//transform reads what it writes
+int Renderer::uploadInstances(InstanceType type, GLintptr* offset){
+	int numInstances;
+	GLsizeiptr size;
+	void* data;
+	if(type == SPHERE_INSTANCE){
+		numInstances = this->sphereData.size();
+		size = numInstances * sizeof(struct sphereInstance);
+		data = numInstances > 0 ? &(this->sphereData[0]) : NULL;
 	}
+	else{
+		numInstances = this->cylinderData.size();
+		size = numInstances * sizeof(struct cylinderInstance);
+		data = numInstances > 0 ? &(this->cylinderData[0]) : NULL;
+	}
+	if(numInstances == 0) return 0;
+	memcpy(this->frameRing.allocate(size,offset),data,size);
+	this->frameRing.flush(*offset,size);
+	this->stats.uploadedBytes += size;
+	return numInstances;
+}
 
-	if(mesh->getGeometry()->getElementBuffer() == 0 && mesh->getGeometry()->getElements() != NULL){
-		GLuint buf = this->makeBuffer(GL_ELEMENT_ARRAY_BUFFER,
-						mesh->getGeometry()->getElements(),
-						mesh->getGeometry()->getNumElements() * sizeof(GLushort)
-						);
-        mesh->getGeometry()->setElementBuffer(buf);
+void Renderer::bindInstanceAttributes(GLProgram* program, InstanceType type, GLuint buffer, GLintptr offset){
+	GLsizei stride = instanceStride(type);
+	glBindBuffer(GL_ARRAY_BUFFER,buffer);
+	this->stats.bufferBinds++;
+	//sphere center or cylinder start are read together with the radius as one vec4
+	if(type == SPHERE_INSTANCE){
+		setInstanceAttribute(program->getAttrInstancePosition(),4,GL_FLOAT,GL_FALSE,stride,
+		                     offset + offsetof(struct sphereInstance,position));
+		setInstanceIntegerAttribute(program->getAttrInstanceMaterial(),1,GL_UNSIGNED_INT,stride,
+		                            offset + offsetof(struct sphereInstance,material));
+	}
+	else{
+		setInstanceAttribute(program->getAttrInstancePosition(),4,GL_FLOAT,GL_FALSE,stride,
+		                     offset + offsetof(struct cylinderInstance,start));
+		setInstanceAttribute(program->getAttrInstanceEnd(),3,GL_FLOAT,GL_FALSE,stride,
+		                     offset + offsetof(struct cylinderInstance,end));
+		setInstanceAttribute(program->getAttrInstanceOffset(),3,GL_FLOAT,GL_FALSE,stride,
+		                     offset + offsetof(struct cylinderInstance,offset));
+		setInstanceIntegerAttribute(program->getAttrInstanceMaterial(),1,GL_UNSIGNED_INT,stride,
+		                            offset + offsetof(struct cylinderInstance,material));
+		setInstanceIntegerAttribute(program->getAttrInstanceEndMaterial(),1,GL_UNSIGNED_INT,stride,
+		                            offset + offsetof(struct cylinderInstance,endMaterial));
 	}
+}
 
-	if(mesh->getGeometry()->getNormalBuffer() == 0 && mesh->getGeometry()->getNormals() != NULL){
-		GLuint buf = this->makeBuffer(GL_ELEMENT_ARRAY_BUFFER,
-						mesh->getGeometry()->getNormals(),
-						mesh->getGeometry()->getNumNormals() * sizeof(GLfloat)
-						);
-        mesh->getGeometry()->setNormalBuffer(buf);
+//vertex arrays are shared by every program, leave no divisor behind
+void Renderer::unbindInstanceAttributes(GLProgram* program){
+	resetInstanceAttribute(program->getAttrInstancePosition());
+	resetInstanceAttribute(program->getAttrInstanceEnd());
+	resetInstanceAttribute(program->getAttrInstanceOffset());
+	resetInstanceAttribute(program->getAttrInstanceMaterial());
+	resetInstanceAttribute(program->getAttrInstanceEndMaterial());
+}
+
+void Renderer::renderInstanced(Geometry* geometry, Material* material, vector<InstancedMesh*>& meshes){
+	InstanceType type = meshes[0]->getInstanceType();
+	this->sphereData.clear();
+	this->cylinderData.clear();
+	int numMeshes = meshes.size();
+	for(int i = 0; i < numMeshes; i++){
+		this->appendInstances(meshes[i]);
 	}
-	//set vertex attribute
-
-	glBindBuffer(GL_ARRAY_BUFFER,mesh->getGeometry()->getVertexBuffer());
-	glVertexAttribPointer(
-		mesh->getMaterial()->getProgram()->getAttrPosition(),//attribute from prgram(position)
-		3,//number of components per vertex
-		GL_FLOAT,//type of data
-		GL_FALSE,//normalized
-		0,//separation between 2 values
-		(void*)0 //offset
+	GLintptr offset;
+	int numInstances = this->uploadInstances(type,&offset);
+	if(numInstances == 0) return;
+	GLProgram* program = material->getProgram();
+	this->makeGeometryBuffers(geometry);
+	this->bindGeometry(geometry);
+	this->bindInstanceAttributes(program,type,this->frameRing.getBuffer(),offset);
+	this->useProgram(program);
+	glDrawElementsInstanced(
+		GL_TRIANGLES, //drawing mode
+		geometry->getNumElements(), //count
+		geometry->getElementType(), //type
+		(void*)0, //offset
+		numInstances //instances
 	);
-	glEnableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrPosition());
-
-	//set normal attribute
-	if(mesh->getGeometry()->getNormalBuffer() != 0){
-		glBindBuffer(GL_ARRAY_BUFFER,mesh->getGeometry()->getNormalBuffer());
-		glVertexAttribPointer(
-			mesh->getMaterial()->getProgram()->getAttrNormal(),//attribute from prgram(position)
-			3,//number of components per vertex
-			GL_FLOAT,//type of data
-			GL_FALSE,//normalized
-			0,//separation between 2 values
-			(void*)0 //offset
+	this->unbindInstanceAttributes(program);
+	this->stats.drawCalls++;
+	this->stats.instances += numInstances;
+	this->stats.batches++;
+}
+
+//one draw per instance with the full per object state setup, kept to
+//compare against the batched path
+void Renderer::renderInstancesSeparately(InstancedMesh* mesh){
+	InstanceType type = mesh->getInstanceType();
+	this->sphereData.clear();
+	this->cylinderData.clear();
+	this->appendInstances(mesh);
+	GLintptr offset;
+	int numInstances = this->uploadInstances(type,&offset);
+	if(numInstances == 0) return;
+	Geometry* geometry = mesh->getGeometry();
+	GLProgram* program = mesh->getMaterial()->getProgram();
+	this->makeGeometryBuffers(geometry);
+	for(int i = 0; i < numInstances; i++){
+		this->bindGeometry(geometry);
+		this->bindInstanceAttributes(program,type,this->frameRing.getBuffer(),offset + i * instanceStride(type));
+		this->useProgram(program);
+		glDrawElementsInstanced(
+			GL_TRIANGLES, //drawing mode
+			geometry->getNumElements(), //count
+			geometry->getElementType(), //type
+			(void*)0, //offset
+			1 //instances
 		);
-		glEnableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrNormal());
+		this->stats.drawCalls++;
 	}
+	this->unbindInstanceAttributes(program);
+	this->stats.instances += numInstances;
+}
+
+//every mesh added to the pool this frame, one multi draw per group with
+//the shared buffers bound once for all of its draws, with gpu culling the
+//commands and instances come from the cull pass instead
+void Renderer::renderMultiDraw(const Mat4& viewProjection){
+	this->drawPool.upload(&(this->frameRing));
+	this->stats.uploadedBytes += this->drawPool.getUploadedBytes();
+	int numGroups = this->drawPool.getNumGroups();
+	if(numGroups == 0) return;
+	GLuint commandBuffer = this->drawPool.getCommandBuffer();
+	GLintptr commandOffset = this->drawPool.getCommandOffset();
+	if(this->gpuCulling){
+		if(this->instanceCuller == NULL){
+			this->instanceCuller = new InstanceCuller();
+		}
+		Frustum frustum;
+		frustum.setFromMatrix(viewProjection);
+		this->instanceCuller->cull(&(this->drawPool),frustum);
+		commandBuffer = this->instanceCuller->getCommandBuffer();
+		commandOffset = 0;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER,commandBuffer);
+	glBindVertexArray(this->drawPool.getVertexArray());
+	this->stats.bufferBinds += 2;
+	for(int i = 0; i < numGroups; i++){
+		DrawGroup group = this->drawPool.getGroup(i);
+		GLProgram* program = group->material->getProgram();
+		this->useProgram(program);
+		GLuint instanceBuffer = this->gpuCulling ? this->instanceCuller->getInstanceBuffer(group->type) :
+		                                           this->drawPool.getInstanceBuffer(group->type);
+		this->bindInstanceAttributes(program,group->type,instanceBuffer,0);
+		//gl_DrawIDARB restarts at zero on every call
+		glUniform1i(program->getUniforms()->unifFirstDraw,group->firstDraw);
+		this->stats.uniformUploads++;
+		glMultiDrawElementsIndirect(
+			GL_TRIANGLES, //drawing mode
+			this->drawPool.getElementType(), //type
+			(void*)(commandOffset + group->firstDraw * sizeof(struct drawCommand)), //offset
+			group->numDraws, //commands
+			0 //tightly packed
+		);
+		this->unbindInstanceAttributes(program);
+		this->stats.drawCalls++;
+		this->stats.batches++;
+		this->stats.instances += group->numInstances;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER,0);
+}
 
-	glUseProgram(mesh->getMaterial()->getProgram()->getProgram());
+//program, buffers and material uniforms are only set when they differ from
+//what the previous mesh left bound
+void Renderer::renderMesh(Mesh* mesh){
+	Material* material = mesh->getMaterial();
+	GLProgram* program = material->getProgram();
+	Geometry* geometry = mesh->getGeometry();
+	bool programChanged = program != this->currentProgram;
+	if(programChanged){
+		this->resetState();
+		this->useProgram(program);
+		this->currentProgram = program;
+	}
+	if(programChanged || geometry != this->currentGeometry){
+		this->makeGeometryBuffers(geometry);
+		this->bindGeometry(geometry);
+		this->currentGeometry = geometry;
+	}
+	if(programChanged || material != this->currentMaterial){
+		this->setMaterialUniforms(material);
+		this->currentMaterial = material;
+	}
 
 	//set model matrix
 	mesh->updateModelMatrix();
 	glUniformMatrix4fv(
-		mesh->getMaterial()->getProgram()->getUniforms()->unifModelMatrix,
+		program->getUniforms()->unifModelMatrix,
 		1,
 		GL_TRUE,
 		mesh->getModelMatrix()->getElements()
 	);
-
-	//set material uniforms
-	setMaterialUniforms(mesh->getMaterial());
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,mesh->getGeometry()->getElementBuffer());
-	glDrawElements(
-		GL_LINES, //drawing mode
-		mesh->getGeometry()->getNumElements(), //count
-		GL_UNSIGNED_SHORT, //type,
-		(void*)0 //offset
+	GLfloat dist = mesh->getDistanceToCamera();
+	glUniform1fv(
+		program->getUniforms()->unifDistanceToCamera,
+		1,
+		&dist
 	);
-	glDisableVertexAttribArray(mesh->getMaterial()->getProgram()->getAttrPosition());
-	if(!node->isDivided())return;
-	OctreeNodeIterator it = node->children.begin();
-	OctreeNodeIterator end = node->children.end();
-	for(;it != end;it++){
-		renderOctreeNode((*it));
+	this->stats.uniformUploads += 2;
+
+	if(material->getType() == TESS_MATERIAL){
+		glPatchParameteri(GL_PATCH_VERTICES, 3);
+		glDrawElements(
+			GL_PATCHES, //drawing mode
+			geometry->getNumElements(), //count
+			geometry->getElementType(), //type,
+			(void*)0 //offset
+		);
 	}
+	else{
+		glDrawElements(
+			GL_TRIANGLES, //drawing mode
+			geometry->getNumElements(), //count
+			geometry->getElementType(), //type,
+			(void*)0 //offset
+		);
+	}
+	this->stats.drawCalls++;
+	this->stats.instances++;
 }
+
+void Renderer::render(Scene * scene){
+	memset(&(this->stats),0,sizeof(struct renderStats));
+	this->frameRing.begin();
+
+	//every model matrix is brought up to date once, before anything reads it
+	Object3D::resetMatrixUpdates();
+	scene->updateMatrices();
+
+	//AmbientLight UBO
+	this->calculateAmbientLights(scene);
+
+	//Camera UBO
+	this->calculateGlobalMatrices(scene);
+
+	//only objects touching the view frustum are drawn
+	if(this->culling){
+		scene->cullObjects(this->visibleObjects);
+		this->stats.movedObjects = scene->getOctree()->getStats()->objectsMoved;
+	}
+	else{
+		list<Object3D*> objects = scene->getObjects();
+		this->visibleObjects.assign(objects.begin(),objects.end());
+	}
+	this->stats.culledObjects = scene->getObjects().size() - this->visibleObjects.size();
+
+	//DirectionalLightsUBO
+
+	this->calculateDirectionalLights(scene);
+
+	//PointLightsUBO
+
+	this->calculatePointLights(scene);
+
+	//material table UBO
+
+	this->updateMaterialTable();
+
+	//instanced meshes go after the rest, runs sharing geometry and material
+	//are drawn together
+	this->queue.clear();
+	int numVisible = this->visibleObjects.size();
+	for(int i = 0; i < numVisible; i++){
+		Mesh* mesh= (Mesh*)(this->visibleObjects[i]);
+		if(!mesh->getVisible()) continue;
+		this->stats.meshes++;
+		this->queue.add(mesh,Renderer::isInstanced(mesh->getMaterial()) ? RENDER_PASS_INSTANCED : RENDER_PASS_OPAQUE);
+	}
+	this->queue.sort();
+	this->resetState();
+	this->drawPool.begin();
+	RenderItem items = this->queue.getItems();
+	int numItems = this->queue.getNumItems();
+	for(int i = 0; i < numItems; i++){
+		Mesh* mesh = items[i].mesh;
+		if(!Renderer::isInstanced(mesh->getMaterial())){
+			this->renderMesh(mesh);
+			continue;
+		}
+		this->resetState();
+		Material* multiDrawMaterial = this->multiDraw ? mesh->getMaterial()->getMultiDrawMaterial() : NULL;
+		if(multiDrawMaterial != NULL){
+			mesh->updateModelMatrix();
+			this->drawPool.add((InstancedMesh*)mesh,multiDrawMaterial);
+			continue;
+		}
+		if(!this->instancing){
+			this->renderInstancesSeparately((InstancedMesh*)mesh);
+			continue;
+		}
+		this->batch.clear();
+		int end = i;
+		while(end < numItems && items[end].mesh->getGeometry() == mesh->getGeometry() &&
+		      items[end].mesh->getMaterial() == mesh->getMaterial()){
+			this->batch.push_back((InstancedMesh*)(items[end].mesh));
+			end++;
+		}
+		this->renderInstanced(mesh->getGeometry(),mesh->getMaterial(),this->batch);
+		i = end - 1;
+	}
+	if(this->multiDraw){
+		Camera* camera = scene->getCamera();
+		Mat4 viewProjection = *(camera->getProjectionMatrix()) * *(camera->getWorldMatrix());
+		this->renderMultiDraw(viewProjection);
+		//occluders for the next frame, once everything is in the depth buffer
+		if(this->gpuCulling && this->instanceCuller != NULL){
+			this->instanceCuller->buildDepthPyramid(viewProjection);
+		}
+	}
+	this->resetState();
+	this->frameRing.end();
+	this->stats.localMatrices = Object3D::getLocalMatrixUpdates();
+	this->stats.worldMatrices = Object3D::getWorldMatrixUpdates();
+}
+
+bool Renderer::getInstancing(){
+	return this->instancing;
+}
+
+void Renderer::setInstancing(bool instancing){
+	this->instancing = instancing;
+}
+
+bool Renderer::getCulling(){
+	return this->culling;
+}
+
+void Renderer::setCulling(bool culling){
+	this->culling = culling;
+}
+
+bool Renderer::getMultiDraw(){
+	return this->multiDraw;
+}
+
+//stays off where the driver cannot source the draws from a buffer
+void Renderer::setMultiDraw(bool multiDraw){
+	this->multiDraw = multiDraw && Renderer::isMultiDrawSupported();
+}
+
+bool Renderer::isMultiDrawSupported(){
+	return GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_draw_parameters;
+}
+
+bool Renderer::getGpuCulling(){
+	return this->gpuCulling;
+}
+
+//only used by the multi draw path, which it culls per instance
+void Renderer::setGpuCulling(bool gpuCulling){
+	this->gpuCulling = gpuCulling && Renderer::isGpuCullingSupported();
+}
+
+bool Renderer::isGpuCullingSupported(){
+	return Renderer::isMultiDrawSupported() && GLEW_ARB_compute_shader && GLEW_ARB_shader_image_load_store;
+}
+
+InstanceCuller* Renderer::getInstanceCuller(){
+	return this->instanceCuller;
+}
+
+FrameRing* Renderer::getFrameRing(){
+	return &(this->frameRing);
+}
+
+RenderStats Renderer::getStats(){
+	return &(this->stats);
+}
\ No newline at end of file
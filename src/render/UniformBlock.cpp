@@ -0,0 +1,64 @@
+#include "render/UniformBlock.h"
+
+UniformBlock::UniformBlock(GLuint binding, GLsizeiptr size){
+	this->buffer = 0;
+	this->data = NULL;
+	this->binding = binding;
+	this->size = size;
+	this->stride = size;
+	this->current = 0;
+	this->persistent = false;
+}
+
+UniformBlock::~UniformBlock(){
+	if(this->buffer == 0) return;
+	if(!this->persistent) delete[] this->data;
+	glDeleteBuffers(1,&(this->buffer));
+}
+
+//the copies start at offsets valid for uniform bindings
+void UniformBlock::create(){
+	GLint alignment = 1;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+	if(alignment < 1) alignment = 1;
+	this->stride = (this->size + alignment - 1) / alignment * alignment;
+	this->persistent = FrameRing::isPersistentSupported();
+	GLsizeiptr bufferSize = this->stride * FRAME_RING_FRAMES;
+	glGenBuffers(1,&(this->buffer));
+	glBindBuffer(GL_COPY_WRITE_BUFFER,this->buffer);
+	if(this->persistent){
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER,bufferSize,NULL,flags);
+		this->data = (GLubyte*)glMapBufferRange(GL_COPY_WRITE_BUFFER,0,bufferSize,flags);
+	}
+	else{
+		glBufferData(GL_COPY_WRITE_BUFFER,bufferSize,NULL,GL_DYNAMIC_DRAW);
+		this->data = new GLubyte[bufferSize];
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+}
+
+//the next copy, to be filled with the whole block before unmap
+void* UniformBlock::map(){
+	if(this->buffer == 0){
+		this->create();
+	}
+	this->current = (this->current + 1) % FRAME_RING_FRAMES;
+	return this->data + this->current * this->stride;
+}
+
+void UniformBlock::unmap(){
+	if(this->persistent) return;
+	glBindBuffer(GL_COPY_WRITE_BUFFER,this->buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER,this->current * this->stride,this->size,this->data + this->current * this->stride);
+	glBindBuffer(GL_COPY_WRITE_BUFFER,0);
+}
+
+void UniformBlock::bind(){
+	if(this->buffer == 0) return;
+	glBindBufferRange(GL_UNIFORM_BUFFER,this->binding,this->buffer,this->current * this->stride,this->size);
+}
+
+GLsizeiptr UniformBlock::getSize(){
+	return this->size;
+}
@@ -0,0 +1,505 @@
+#include "scene/BVH.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <functional>
+#include <thread>
+using namespace std;
+
+BVH::BVH(){
+	this->maxRadius = 0;
+	this->numThreads = thread::hardware_concurrency();
+	if(this->numThreads < 1) this->numThreads = 1;
+}
+
+static float surfaceArea(const GLfloat* min, const GLfloat* max){
+	float x = max[0] - min[0];
+	float y = max[1] - min[1];
+	float z = max[2] - min[2];
+	return 2 * (x*y + y*z + z*x);
+}
+
+static void growBounds(GLfloat* min, GLfloat* max, const GLfloat* otherMin, const GLfloat* otherMax){
+	for(int axis = 0; axis < 3; axis++){
+		min[axis] = otherMin[axis] < min[axis] ? otherMin[axis] : min[axis];
+		max[axis] = otherMax[axis] > max[axis] ? otherMax[axis] : max[axis];
+	}
+}
+
+static void emptyBounds(GLfloat* min, GLfloat* max){
+	for(int axis = 0; axis < 3; axis++){
+		min[axis] = FLT_MAX;
+		max[axis] = -FLT_MAX;
+	}
+}
+
+static inline float referenceCentroid(const struct bvhReference* reference, int axis){
+	return (reference->min[axis] + reference->max[axis]) * 0.5f;
+}
+
+//subtrees built on another thread index their own array, right children
+//are moved by where the subtree lands
+static void appendNodes(vector<struct bvhNode>& nodes, const vector<struct bvhNode>& subtree){
+	int offset = nodes.size();
+	int numNodes = subtree.size();
+	for(int i = 0; i < numNodes; i++){
+		nodes.push_back(subtree[i]);
+		if(subtree[i].count == 0) nodes.back().first += offset;
+	}
+}
+
+void BVH::primitiveBounds(int primitive, GLfloat* min, GLfloat* max){
+	const struct bvhPrimitive* p = &(this->primitives[primitive]);
+	for(int axis = 0; axis < 3; axis++){
+		min[axis] = fmin(p->start[axis],p->end[axis]) - p->radius;
+		max[axis] = fmax(p->start[axis],p->end[axis]) + p->radius;
+	}
+}
+
+//binned sah over the three axes, partitions the range and returns where the
+//right child starts or -1 when a leaf is cheaper
+int BVH::findSplit(int first, int count, const GLfloat* centroidMin, const GLfloat* centroidMax, const struct bvhNode* node){
+	if(count == 1) return -1;
+	//small ranges do not need every bin, clearing and sweeping them would
+	//cost more than binning the primitives
+	int numBins = count < BVH_BINS ? count : BVH_BINS;
+	float scale[3];
+	for(int axis = 0; axis < 3; axis++){
+		float extent = centroidMax[axis] - centroidMin[axis];
+		scale[axis] = extent > 0 ? numBins / extent : 0;
+	}
+	//every axis is binned in the same pass over the primitives
+	int binCount[3][BVH_BINS] = {{0}};
+	GLfloat binMin[3][BVH_BINS][3];
+	GLfloat binMax[3][BVH_BINS][3];
+	for(int axis = 0; axis < 3; axis++){
+		for(int b = 0; b < numBins; b++){
+			emptyBounds(binMin[axis][b],binMax[axis][b]);
+		}
+	}
+	for(int i = first; i < first + count; i++){
+		const struct bvhReference* r = &(this->references[i]);
+		for(int axis = 0; axis < 3; axis++){
+			int b = (int)((referenceCentroid(r,axis) - centroidMin[axis]) * scale[axis]);
+			if(b >= numBins) b = numBins - 1;
+			growBounds(binMin[axis][b],binMax[axis][b],r->min,r->max);
+			binCount[axis][b]++;
+		}
+	}
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	int bestBin = 0;
+	for(int axis = 0; axis < 3; axis++){
+		if(scale[axis] == 0) continue;
+		//cost of splitting after bin b, swept from both ends
+		float leftCost[BVH_BINS];
+		GLfloat min[3];
+		GLfloat max[3];
+		emptyBounds(min,max);
+		int numLeft = 0;
+		for(int b = 0; b < numBins - 1; b++){
+			growBounds(min,max,binMin[axis][b],binMax[axis][b]);
+			numLeft += binCount[axis][b];
+			leftCost[b] = numLeft ? surfaceArea(min,max) * numLeft : 0;
+		}
+		emptyBounds(min,max);
+		int numRight = 0;
+		for(int b = numBins - 1; b > 0; b--){
+			growBounds(min,max,binMin[axis][b],binMax[axis][b]);
+			numRight += binCount[axis][b];
+			if(numRight == 0 || numRight == count) continue;
+			float cost = leftCost[b - 1] + surfaceArea(min,max) * numRight;
+			if(cost < bestCost){
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b - 1;
+			}
+		}
+	}
+	float nodeArea = surfaceArea(node->min,node->max);
+	if(bestAxis >= 0){
+		if(count <= BVH_MAX_LEAF && BVH_TRAVERSAL_COST * nodeArea + bestCost >= count * nodeArea){
+			return -1;
+		}
+		int mid = first;
+		for(int i = first; i < first + count; i++){
+			struct bvhReference r = this->references[i];
+			int b = (int)((referenceCentroid(&r,bestAxis) - centroidMin[bestAxis]) * scale[bestAxis]);
+			if(b >= numBins) b = numBins - 1;
+			if(b <= bestBin){
+				this->references[i] = this->references[mid];
+				this->references[mid++] = r;
+			}
+		}
+		if(mid > first && mid < first + count) return mid;
+	}
+	if(count <= BVH_MAX_LEAF) return -1;
+	//every centroid in one place, any even split will do
+	return first + count / 2;
+}
+
+void BVH::buildNode(vector<struct bvhNode>& nodes, int first, int count, int threadDepth){
+	struct bvhNode node;
+	GLfloat centroidMin[3];
+	GLfloat centroidMax[3];
+	emptyBounds(node.min,node.max);
+	emptyBounds(centroidMin,centroidMax);
+	for(int i = first; i < first + count; i++){
+		const struct bvhReference* r = &(this->references[i]);
+		GLfloat c[3];
+		for(int axis = 0; axis < 3; axis++){
+			c[axis] = referenceCentroid(r,axis);
+		}
+		growBounds(node.min,node.max,r->min,r->max);
+		growBounds(centroidMin,centroidMax,c,c);
+	}
+	int index = nodes.size();
+	int mid = this->findSplit(first,count,centroidMin,centroidMax,&node);
+	if(mid < 0){
+		node.first = first;
+		node.count = count;
+		nodes.push_back(node);
+		return;
+	}
+	node.first = 0;
+	node.count = 0;
+	nodes.push_back(node);
+	if(threadDepth > 0 && count >= BVH_PARALLEL_THRESHOLD){
+		//the two halves own disjoint ranges of references, only the node arrays
+		//have to be joined afterwards
+		vector<struct bvhNode> left;
+		vector<struct bvhNode> right;
+		thread worker(&BVH::buildNode,this,ref(left),first,mid - first,threadDepth - 1);
+		this->buildNode(right,mid,first + count - mid,threadDepth - 1);
+		worker.join();
+		appendNodes(nodes,left);
+		nodes[index].first = nodes.size();
+		appendNodes(nodes,right);
+		return;
+	}
+	this->buildNode(nodes,first,mid - first,threadDepth);
+	nodes[index].first = nodes.size();
+	this->buildNode(nodes,mid,first + count - mid,threadDepth);
+}
+
+//primitives are copied and reordered so every leaf is one contiguous range
+void BVH::build(const struct bvhPrimitive* primitives, int numPrimitives){
+	this->primitives.assign(primitives,primitives + numPrimitives);
+	this->nodes.clear();
+	this->maxRadius = 0;
+	if(numPrimitives == 0) return;
+	this->references.resize(numPrimitives);
+	for(int i = 0; i < numPrimitives; i++){
+		this->primitiveBounds(i,this->references[i].min,this->references[i].max);
+		this->references[i].primitive = i;
+		this->maxRadius = fmax(this->maxRadius,primitives[i].radius);
+	}
+	int threadDepth = 0;
+	while((1 << threadDepth) < this->numThreads) threadDepth++;
+	this->nodes.reserve(numPrimitives * 2 / BVH_MAX_LEAF + 1);
+	this->buildNode(this->nodes,0,numPrimitives,threadDepth);
+	for(int i = 0; i < numPrimitives; i++){
+		this->primitives[i] = primitives[this->references[i].primitive];
+	}
+	vector<struct bvhReference>().swap(this->references);
+}
+
+//children always come after their parent, so walking the nodes backwards
+//refits both children before the parent is reached
+void BVH::refit(){
+	int numNodes = this->nodes.size();
+	int numPrimitives = this->primitives.size();
+	this->maxRadius = 0;
+	for(int i = 0; i < numPrimitives; i++){
+		this->maxRadius = fmax(this->maxRadius,this->primitives[i].radius);
+	}
+	for(int i = numNodes - 1; i >= 0; i--){
+		struct bvhNode* node = &(this->nodes[i]);
+		if(node->count > 0){
+			emptyBounds(node->min,node->max);
+			for(int p = node->first; p < node->first + node->count; p++){
+				GLfloat min[3];
+				GLfloat max[3];
+				this->primitiveBounds(p,min,max);
+				growBounds(node->min,node->max,min,max);
+			}
+		}
+		else{
+			struct bvhNode* left = &(this->nodes[i + 1]);
+			struct bvhNode* right = &(this->nodes[node->first]);
+			for(int axis = 0; axis < 3; axis++){
+				node->min[axis] = fmin(left->min[axis],right->min[axis]);
+				node->max[axis] = fmax(left->max[axis],right->max[axis]);
+			}
+		}
+	}
+}
+
+//signed distance to the surface, negative inside
+float BVH::primitiveDistance(const struct bvhPrimitive* primitive, const GLfloat* point){
+	GLfloat pa[3];
+	GLfloat ba[3];
+	float baba = 0;
+	float paba = 0;
+	for(int axis = 0; axis < 3; axis++){
+		pa[axis] = point[axis] - primitive->start[axis];
+		ba[axis] = primitive->end[axis] - primitive->start[axis];
+		baba += ba[axis] * ba[axis];
+		paba += pa[axis] * ba[axis];
+	}
+	float h = baba > 0 ? fmin(fmax(paba / baba,0.0f),1.0f) : 0;
+	float distance = 0;
+	for(int axis = 0; axis < 3; axis++){
+		float d = pa[axis] - ba[axis] * h;
+		distance += d * d;
+	}
+	return sqrt(distance) - primitive->radius;
+}
+
+static float intersectSphere(const GLfloat* center, float radius, const GLfloat* origin, const GLfloat* direction){
+	GLfloat oc[3] = {origin[0] - center[0],origin[1] - center[1],origin[2] - center[2]};
+	float b = oc[0]*direction[0] + oc[1]*direction[1] + oc[2]*direction[2];
+	float c = oc[0]*oc[0] + oc[1]*oc[1] + oc[2]*oc[2] - radius * radius;
+	float h = b*b - c;
+	if(h < 0) return -1;
+	return -b - sqrt(h);
+}
+
+//distance along a normalized ray to the first surface, 0 when the origin is
+//inside and -1 on a miss, capsules are the side of the cylinder plus a
+//sphere on each end
+float BVH::intersectPrimitive(const struct bvhPrimitive* primitive, const GLfloat* origin, const GLfloat* direction){
+	if(BVH::primitiveDistance(primitive,origin) <= 0) return 0;
+	float best = intersectSphere(primitive->start,primitive->radius,origin,direction);
+	if(primitive->type == SPHERE_PRIMITIVE) return best < 0 ? -1 : best;
+	float end = intersectSphere(primitive->end,primitive->radius,origin,direction);
+	if(end >= 0 && (best < 0 || end < best)) best = end;
+	GLfloat ba[3];
+	GLfloat oa[3];
+	float baba = 0;
+	float bard = 0;
+	float baoa = 0;
+	float rdoa = 0;
+	float oaoa = 0;
+	for(int axis = 0; axis < 3; axis++){
+		ba[axis] = primitive->end[axis] - primitive->start[axis];
+		oa[axis] = origin[axis] - primitive->start[axis];
+		baba += ba[axis] * ba[axis];
+		bard += ba[axis] * direction[axis];
+		baoa += ba[axis] * oa[axis];
+		rdoa += direction[axis] * oa[axis];
+		oaoa += oa[axis] * oa[axis];
+	}
+	float a = baba - bard * bard;
+	if(a > 1e-8 * baba){
+		float b = baba * rdoa - baoa * bard;
+		float c = baba * oaoa - baoa * baoa - primitive->radius * primitive->radius * baba;
+		float h = b*b - a*c;
+		if(h >= 0){
+			float t = (-b - sqrt(h)) / a;
+			float y = baoa + t * bard;
+			if(t >= 0 && y > 0 && y < baba && (best < 0 || t < best)) best = t;
+		}
+	}
+	return best < 0 ? -1 : best;
+}
+
+bool BVH::intersectBox(const struct bvhNode* node, const GLfloat* origin, const GLfloat* invDirection, float maxDistance, float* entry){
+	float tmin = 0;
+	float tmax = maxDistance;
+	for(int axis = 0; axis < 3; axis++){
+		float t1 = (node->min[axis] - origin[axis]) * invDirection[axis];
+		float t2 = (node->max[axis] - origin[axis]) * invDirection[axis];
+		//fmin and fmax drop the nan of a ray lying on a slab plane
+		tmin = fmax(tmin,fmin(t1,t2));
+		tmax = fmin(tmax,fmax(t1,t2));
+	}
+	*entry = tmin;
+	return tmin <= tmax;
+}
+
+float BVH::boxDistance(const struct bvhNode* node, const GLfloat* point){
+	float distance = 0;
+	for(int axis = 0; axis < 3; axis++){
+		float d = fmax(fmax(node->min[axis] - point[axis],point[axis] - node->max[axis]),0.0f);
+		distance += d * d;
+	}
+	return sqrt(distance);
+}
+
+//nearest hit, children are visited front to back and nodes starting past
+//the best hit so far are skipped
+bool BVH::raycast(const GLfloat* origin, const GLfloat* direction, float maxDistance, BVHHit hit){
+	if(this->nodes.empty()) return false;
+	float length = sqrt(direction[0]*direction[0] + direction[1]*direction[1] + direction[2]*direction[2]);
+	if(length == 0) return false;
+	GLfloat dir[3] = {direction[0] / length,direction[1] / length,direction[2] / length};
+	GLfloat invDir[3] = {1.0f / dir[0],1.0f / dir[1],1.0f / dir[2]};
+	int stack[BVH_STACK_SIZE];
+	float stackEntry[BVH_STACK_SIZE];
+	int stackSize = 0;
+	float best = maxDistance;
+	bool found = false;
+	float entry;
+	if(!BVH::intersectBox(&(this->nodes[0]),origin,invDir,best,&entry)) return false;
+	stack[stackSize] = 0;
+	stackEntry[stackSize++] = entry;
+	while(stackSize > 0){
+		stackSize--;
+		if(stackEntry[stackSize] > best) continue;
+		const struct bvhNode* node = &(this->nodes[stack[stackSize]]);
+		if(node->count > 0){
+			for(int p = node->first; p < node->first + node->count; p++){
+				float t = BVH::intersectPrimitive(&(this->primitives[p]),origin,dir);
+				if(t >= 0 && t < best){
+					best = t;
+					hit->primitive = p;
+					hit->index = this->primitives[p].index;
+					hit->type = this->primitives[p].type;
+					hit->distance = t;
+					found = true;
+				}
+			}
+			continue;
+		}
+		int children[2] = {stack[stackSize] + 1,node->first};
+		float entries[2];
+		bool hits[2];
+		for(int c = 0; c < 2; c++){
+			hits[c] = BVH::intersectBox(&(this->nodes[children[c]]),origin,invDir,best,&(entries[c]));
+		}
+		//the nearer child goes on top
+		int nearChild = entries[0] <= entries[1] ? 0 : 1;
+		for(int c = 1; c >= 0; c--){
+			int child = c == 0 ? nearChild : 1 - nearChild;
+			if(!hits[child] || stackSize >= BVH_STACK_SIZE) continue;
+			stack[stackSize] = children[child];
+			stackEntry[stackSize++] = entries[child];
+		}
+	}
+	return found;
+}
+
+bool BVH::compareHits(const struct bvhHit& h1, const struct bvhHit& h2){
+	return h1.distance < h2.distance;
+}
+
+//every primitive along the ray, nearest first
+int BVH::raycastAll(const GLfloat* origin, const GLfloat* direction, float maxDistance, vector<struct bvhHit>& hits){
+	hits.clear();
+	if(this->nodes.empty()) return 0;
+	float length = sqrt(direction[0]*direction[0] + direction[1]*direction[1] + direction[2]*direction[2]);
+	if(length == 0) return 0;
+	GLfloat dir[3] = {direction[0] / length,direction[1] / length,direction[2] / length};
+	GLfloat invDir[3] = {1.0f / dir[0],1.0f / dir[1],1.0f / dir[2]};
+	int stack[BVH_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0){
+		int index = stack[--stackSize];
+		const struct bvhNode* node = &(this->nodes[index]);
+		float entry;
+		if(!BVH::intersectBox(node,origin,invDir,maxDistance,&entry)) continue;
+		if(node->count > 0){
+			for(int p = node->first; p < node->first + node->count; p++){
+				float t = BVH::intersectPrimitive(&(this->primitives[p]),origin,dir);
+				if(t < 0 || t > maxDistance) continue;
+				struct bvhHit hit;
+				hit.primitive = p;
+				hit.index = this->primitives[p].index;
+				hit.type = this->primitives[p].type;
+				hit.distance = t;
+				hits.push_back(hit);
+			}
+			continue;
+		}
+		if(stackSize + 2 > BVH_STACK_SIZE) continue;
+		stack[stackSize++] = node->first;
+		stack[stackSize++] = index + 1;
+	}
+	sort(hits.begin(),hits.end(),BVH::compareHits);
+	return hits.size();
+}
+
+//primitive with the nearest surface, a node can not hold anything closer
+//than its box distance minus the largest radius
+bool BVH::closestPrimitive(const GLfloat* point, float maxDistance, BVHHit hit){
+	if(this->nodes.empty()) return false;
+	int stack[BVH_STACK_SIZE];
+	float stackBound[BVH_STACK_SIZE];
+	int stackSize = 0;
+	float best = maxDistance;
+	bool found = false;
+	stack[stackSize] = 0;
+	stackBound[stackSize++] = BVH::boxDistance(&(this->nodes[0]),point) - this->maxRadius;
+	while(stackSize > 0){
+		stackSize--;
+		if(stackBound[stackSize] >= best) continue;
+		const struct bvhNode* node = &(this->nodes[stack[stackSize]]);
+		if(node->count > 0){
+			for(int p = node->first; p < node->first + node->count; p++){
+				float distance = BVH::primitiveDistance(&(this->primitives[p]),point);
+				if(distance < best){
+					best = distance;
+					hit->primitive = p;
+					hit->index = this->primitives[p].index;
+					hit->type = this->primitives[p].type;
+					hit->distance = distance;
+					found = true;
+				}
+			}
+			continue;
+		}
+		int children[2] = {stack[stackSize] + 1,node->first};
+		float bounds[2];
+		for(int c = 0; c < 2; c++){
+			bounds[c] = BVH::boxDistance(&(this->nodes[children[c]]),point) - this->maxRadius;
+		}
+		int nearChild = bounds[0] <= bounds[1] ? 0 : 1;
+		for(int c = 1; c >= 0; c--){
+			int child = c == 0 ? nearChild : 1 - nearChild;
+			if(bounds[child] >= best || stackSize >= BVH_STACK_SIZE) continue;
+			stack[stackSize] = children[child];
+			stackBound[stackSize++] = bounds[child];
+		}
+	}
+	return found;
+}
+
+BVHPrimitive BVH::getPrimitives(){
+	return this->primitives.empty() ? NULL : &(this->primitives[0]);
+}
+
+int BVH::getNumPrimitives(){
+	return this->primitives.size();
+}
+
+BVHNode BVH::getNodes(){
+	return this->nodes.empty() ? NULL : &(this->nodes[0]);
+}
+
+int BVH::getNumNodes(){
+	return this->nodes.size();
+}
+
+int BVH::getNumThreads(){
+	return this->numThreads;
+}
+
+void BVH::setNumThreads(int numThreads){
+	this->numThreads = numThreads < 1 ? 1 : numThreads;
+}
+
+void BVH::getBounds(GLfloat* min, GLfloat* max){
+	if(this->nodes.empty()){
+		for(int axis = 0; axis < 3; axis++){
+			min[axis] = 0;
+			max[axis] = 0;
+		}
+		return;
+	}
+	for(int axis = 0; axis < 3; axis++){
+		min[axis] = this->nodes[0].min[axis];
+		max[axis] = this->nodes[0].max[axis];
+	}
+}
@@ -1,106 +1,100 @@
-
 #include <cstdlib>
+#include <cstring>
 #include "scene/Camera.h"
 #include "math/Mat4.h"
 #include "object/Object3D.h"
 
 Mat4* Camera::getProjectionMatrix(){
-	return this->projectionMatrix;
+	return &(this->projectionMatrix);
 }
 
-void Camera::setProjectionMatrix(Mat4* mat){
+void Camera::setProjectionMatrix(const Mat4& mat){
 	this->projectionMatrix = mat;
+	this->version++;
 }
 
 Mat4* Camera::getWorldMatrix(){
-	return this->worldMatrix;
+	return &(this->worldMatrix);
 }
 
-void Camera::setWorldMatrix(Mat4* mat){
+void Camera::setWorldMatrix(const Mat4& mat){
 	this->worldMatrix = mat;
+	this->version++;
 }
 
-GLuint Camera::getMatricesUBO(){
-	return this->matricesUBO;
-}
-
-void Camera::setMatricesUBO(GLuint ubo){
-	this->matricesUBO = ubo;
+Camera::Camera():Object3D(), projectionMatrix(0), worldMatrix(0){
+	this->hasTarget = false;
+	this->version = 0;
+	this->viewWorldVersion = 0;
+	this->viewHasTarget = false;
 }
 
-Camera::Camera():Object3D(){
-	this->projectionMatrix = new Mat4(0);
-	this->worldMatrix = new Mat4(0);
-	this->matricesUBO = 0;
-	this->target = NULL;
+//matrices must hold 32 floats: world then projection, transposed for GL
+//they are written element by element, matrices is usually mapped memory
+void Camera::getMatricesArray(GLfloat* matrices){
+	const GLfloat* world = this->worldMatrix.getElements();
+	const GLfloat* projection = this->projectionMatrix.getElements();
+	for(int row = 0; row < 4; row++){
+		for(int column = 0; column < 4; column++){
+			matrices[column*4 + row] = world[row*4 + column];
+			matrices[16 + column*4 + row] = projection[row*4 + column];
+		}
+	}
 }
 
-GLfloat* Camera::getMatricesArray(){
-	GLfloat* matrices = new GLfloat[32];
-	Mat4 * worldTraspose = this->worldMatrix->getTraspose();
-	Mat4 * projectionTraspose = this->projectionMatrix->getTraspose();
-	memcpy(matrices,worldTraspose->getElements(),sizeof(GLfloat)*16);
-	memcpy(matrices+16,projectionTraspose->getElements(),sizeof(GLfloat)*16);
-	delete worldTraspose;
-	delete projectionTraspose;
-	return matrices;
+bool Camera::targetChanged(){
+	if(this->hasTarget != this->viewHasTarget) return true;
+	return this->hasTarget && (this->target.getX() != this->viewTarget.getX() ||
+	                           this->target.getY() != this->viewTarget.getY() ||
+	                           this->target.getZ() != this->viewTarget.getZ());
 }
 
+//rebuilt only when the camera moved or its target changed since last time
 void Camera::updateWorldMatrix(){
 	this->updateModelMatrix();
-	Mat4 * translation = Mat4::translationMatrix(
-		this->getPosition()->getX() * -1,
-		this->getPosition()->getY() * -1,
-		this->getPosition()->getZ() * -1);
-
-	Mat4 * rot;
-	if(this->target == NULL){
-		Quaternion* q = this->getQuaternion()->inverse();
-		rot = Mat4::rotationMatrixFromQuaternion(q);
-		delete q;
+	if(this->getWorldVersion() == this->viewWorldVersion && !this->targetChanged()) return;
+	Vec3* position = this->getPosition();
+	Vec3* scale = this->getScale();
+	this->worldMatrix = Mat4::scaleMatrix(
+		1 / scale->getX(),
+		1 / scale->getY(),
+		1 / scale->getZ());
+	if(!this->hasTarget){
+		this->worldMatrix *= Mat4::rotationMatrixFromQuaternion(this->getQuaternion()->inverse());
 	}
 	else{
-		rot = this->lookAt();
-	}
-
-	Mat4 * scale = Mat4::scaleMatrix(
-		1 / this->getScale()->getX(),
-		1 / this->getScale()->getY(),
-		1 / this->getScale()->getZ());
-	if(this->worldMatrix !=NULL){
-		delete this->worldMatrix;
+		this->worldMatrix *= this->lookAt();
 	}
-	this->worldMatrix = Mat4::identityMatrix();
-	this->worldMatrix->crossProduct(scale);
-	this->worldMatrix->crossProduct(rot);
-	this->worldMatrix->crossProduct(translation);
-
-	
-	delete scale;
-	delete rot;
-	delete translation;
+	this->worldMatrix *= Mat4::translationMatrix(
+		position->getX() * -1,
+		position->getY() * -1,
+		position->getZ() * -1);
+	this->viewWorldVersion = this->getWorldVersion();
+	this->viewTarget = this->target;
+	this->viewHasTarget = this->hasTarget;
+	this->version++;
 }
 
 Vec3* Camera::getTarget(){
-	return this->target;
+	return this->hasTarget ? &(this->target) : NULL;
 }
 
-void Camera::setTarget(Vec3* target){
+void Camera::setTarget(const Vec3& target){
 	this->target = target;
+	this->hasTarget = true;
+}
+
+void Camera::clearTarget(){
+	this->hasTarget = false;
+}
+
+Mat4 Camera::lookAt(){
+	return Mat4::lookAt(*(this->getPosition()), this->target, Vec3(0.0,1.0,0.0));
 }
 
-Mat4* Camera::lookAt(){
-	Vec3* up = new Vec3(0.0,1.0,0.0);
-	Mat4* rot = Mat4::lookAt(this->getPosition(), this->target,up);
-	delete up;
-	return rot;
+unsigned int Camera::getVersion(){
+	return this->version;
 }
 
 Camera::~Camera(){
-	if(this->projectionMatrix != NULL)
-		delete this->projectionMatrix;
-	if(this->worldMatrix != NULL)
-		delete this->worldMatrix;
-	if(this->target != NULL)
-		delete this->target;
 }
\ No newline at end of file
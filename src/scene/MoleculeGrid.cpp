@@ -0,0 +1,22 @@
+#include "scene/MoleculeGrid.h"
+#include <cmath>
+
+void MoleculeGrid::place(Object3D* object, int index, int dim){
+	int i = index / (dim*dim);
+	int j = index / dim % dim;
+	int k = index % dim;
+	object->getPosition()->set(-dim*10/2.0 + 10*i,-dim*12/2.0 + 12*j,-dim*8/2.0 + 8*k);
+}
+
+//bobs around the grid position, time is in milliseconds
+void MoleculeGrid::move(Object3D* object, int index, int dim, int time){
+	int i = index / (dim*dim);
+	int j = index / dim % dim;
+	int k = index % dim;
+	float phase = time * 0.002 + index;
+	object->getPosition()->set(
+		-dim*10/2.0 + 10*i + 3*sin(phase),
+		-dim*12/2.0 + 12*j + 3*cos(phase * 0.7),
+		-dim*8/2.0 + 8*k + 2*sin(phase * 1.3)
+	);
+}
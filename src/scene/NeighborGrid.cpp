@@ -0,0 +1,109 @@
+#include "scene/NeighborGrid.h"
+#include <cmath>
+#include <cfloat>
+
+NeighborGrid::NeighborGrid(float cellSize){
+	this->cellSize = cellSize;
+	this->invCellSize = 1.0 / cellSize;
+	this->origin[0] = 0;
+	this->origin[1] = 0;
+	this->origin[2] = 0;
+	this->tableMask = 0;
+}
+
+void NeighborGrid::cellCoords(float x, float y, float z, int* cell){
+	cell[0] = (int)floor((x - this->origin[0]) * this->invCellSize);
+	cell[1] = (int)floor((y - this->origin[1]) * this->invCellSize);
+	cell[2] = (int)floor((z - this->origin[2]) * this->invCellSize);
+}
+
+unsigned int NeighborGrid::hashCell(int* cell){
+	return ((unsigned int)cell[0] * 73856093u ^
+	        (unsigned int)cell[1] * 19349663u ^
+	        (unsigned int)cell[2] * 83492791u) & this->tableMask;
+}
+
+unsigned long long NeighborGrid::packCell(int* cell){
+	//21 bits per axis, enough for any box the hash table can index
+	return ((unsigned long long)(cell[0] & 0x1fffff) << 42) |
+	       ((unsigned long long)(cell[1] & 0x1fffff) << 21) |
+	        (unsigned long long)(cell[2] & 0x1fffff);
+}
+
+void NeighborGrid::build(const float* positions, int numPoints){
+	this->origin[0] = FLT_MAX;
+	this->origin[1] = FLT_MAX;
+	this->origin[2] = FLT_MAX;
+	for(int i = 0; i < numPoints; i++){
+		this->origin[0] = fmin(this->origin[0],positions[i*3]);
+		this->origin[1] = fmin(this->origin[1],positions[i*3+1]);
+		this->origin[2] = fmin(this->origin[2],positions[i*3+2]);
+	}
+	unsigned int tableSize = 1;
+	while(tableSize < (unsigned int)numPoints * 2) tableSize <<= 1;
+	this->tableMask = tableSize - 1;
+
+	//counting sort of the points by hashed cell
+	vector<unsigned int> pointHash(numPoints);
+	vector<unsigned long long> pointKey(numPoints);
+	this->cellStart.assign(tableSize + 1,0);
+	for(int i = 0; i < numPoints; i++){
+		int cell[3];
+		this->cellCoords(positions[i*3],positions[i*3+1],positions[i*3+2],cell);
+		pointHash[i] = this->hashCell(cell);
+		pointKey[i] = NeighborGrid::packCell(cell);
+		this->cellStart[pointHash[i] + 1]++;
+	}
+	for(unsigned int i = 0; i < tableSize; i++){
+		this->cellStart[i + 1] += this->cellStart[i];
+	}
+	vector<int> fill(this->cellStart.begin(),this->cellStart.end() - 1);
+	this->sortedIndices.resize(numPoints);
+	this->sortedKeys.resize(numPoints);
+	this->sortedPositions.resize(numPoints * 3);
+	for(int i = 0; i < numPoints; i++){
+		int slot = fill[pointHash[i]]++;
+		this->sortedIndices[slot] = i;
+		this->sortedKeys[slot] = pointKey[i];
+		this->sortedPositions[slot*3] = positions[i*3];
+		this->sortedPositions[slot*3+1] = positions[i*3+1];
+		this->sortedPositions[slot*3+2] = positions[i*3+2];
+	}
+}
+
+void NeighborGrid::query(float x, float y, float z, float radius, vector<int>* result){
+	if(this->sortedIndices.empty()) return;
+	int minCell[3];
+	int maxCell[3];
+	this->cellCoords(x - radius,y - radius,z - radius,minCell);
+	this->cellCoords(x + radius,y + radius,z + radius,maxCell);
+	float radiusSq = radius * radius;
+	int cell[3];
+	for(cell[0] = minCell[0]; cell[0] <= maxCell[0]; cell[0]++){
+		for(cell[1] = minCell[1]; cell[1] <= maxCell[1]; cell[1]++){
+			for(cell[2] = minCell[2]; cell[2] <= maxCell[2]; cell[2]++){
+				unsigned int hash = this->hashCell(cell);
+				unsigned long long key = NeighborGrid::packCell(cell);
+				int end = this->cellStart[hash + 1];
+				for(int i = this->cellStart[hash]; i < end; i++){
+					//different cells can share a bucket, skip the ones not queried
+					if(this->sortedKeys[i] != key) continue;
+					float dx = this->sortedPositions[i*3] - x;
+					float dy = this->sortedPositions[i*3+1] - y;
+					float dz = this->sortedPositions[i*3+2] - z;
+					if(dx*dx + dy*dy + dz*dz <= radiusSq){
+						result->push_back(this->sortedIndices[i]);
+					}
+				}
+			}
+		}
+	}
+}
+
+int NeighborGrid::getNumPoints(){
+	return this->sortedIndices.size();
+}
+
+float NeighborGrid::getCellSize(){
+	return this->cellSize;
+}
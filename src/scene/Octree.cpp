@@ -0,0 +1,314 @@
+#include "scene/Octree.h"
+#include "object/Mesh.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+Octree::Octree(const Vec3& center, float size, int depth){
+	this->center[0] = center.getX();
+	this->center[1] = center.getY();
+	this->center[2] = center.getZ();
+	this->size = size;
+	this->depth = 0;
+	this->overflowHead = OCTREE_NONE;
+	this->numOverflow = 0;
+	memset(&(this->stats),0,sizeof(struct cullStats));
+	this->setDepth(depth);
+}
+
+//a subtree rooted at level l holds 1 + 8 + ... + 8^(depth-l) nodes
+void Octree::generateNodes(){
+	this->subtreeSize.assign(this->depth + 2,0);
+	this->subtreeSize[this->depth] = 1;
+	for(int level = this->depth - 1; level >= 0; level--){
+		this->subtreeSize[level] = 1 + 8 * this->subtreeSize[level + 1];
+	}
+	int numNodes = this->subtreeSize[0];
+	this->nodes.resize(numNodes);
+	memset(&(this->nodes[0]),0,sizeof(struct octant) * numNodes);
+	for(int i = 0; i < numNodes; i++){
+		this->nodes[i].firstEntry = OCTREE_NONE;
+	}
+	this->nodes[0].center[0] = this->center[0];
+	this->nodes[0].center[1] = this->center[1];
+	this->nodes[0].center[2] = this->center[2];
+	this->nodes[0].halfSize = this->size / 2;
+	this->nodes[0].parent = OCTREE_NONE;
+	//parents come before their children so one pass fills every node
+	for(int i = 0; i < numNodes; i++){
+		struct octant* node = &(this->nodes[i]);
+		if(node->level == this->depth) continue;
+		GLfloat childHalf = node->halfSize / 2;
+		for(int child = 0; child < 8; child++){
+			struct octant* childNode = &(this->nodes[i + 1 + child * this->subtreeSize[node->level + 1]]);
+			childNode->center[0] = node->center[0] + (child & 1 ? childHalf : -childHalf);
+			childNode->center[1] = node->center[1] + (child & 2 ? childHalf : -childHalf);
+			childNode->center[2] = node->center[2] + (child & 4 ? childHalf : -childHalf);
+			childNode->halfSize = childHalf;
+			childNode->level = node->level + 1;
+			childNode->parent = i;
+		}
+	}
+	this->entries.clear();
+	this->overflowHead = OCTREE_NONE;
+	this->numOverflow = 0;
+}
+
+//the level comes from the box size and the cell from its center, the
+//morton digits of the cell walk the depth first layout down to the node
+int Octree::findNode(const GLfloat* min, const GLfloat* max){
+	GLfloat boxCenter[3];
+	GLfloat extent = 0;
+	GLfloat half = this->size / 2;
+	for(int axis = 0; axis < 3; axis++){
+		boxCenter[axis] = (min[axis] + max[axis]) * 0.5;
+		extent = fmax(extent,(max[axis] - min[axis]) * 0.5);
+		if(fabs(boxCenter[axis] - this->center[axis]) > half) return OCTREE_NONE;
+	}
+	if(extent > half * (OCTREE_LOOSENESS - 1)) return OCTREE_NONE;
+	int level = 0;
+	while(level < this->depth && extent <= half * 0.5 * (OCTREE_LOOSENESS - 1)){
+		half *= 0.5;
+		level++;
+	}
+	int cells = 1 << level;
+	GLfloat cellSize = this->size / cells;
+	int cell[3];
+	for(int axis = 0; axis < 3; axis++){
+		cell[axis] = (int)floor((boxCenter[axis] - this->center[axis] + this->size / 2) / cellSize);
+		cell[axis] = cell[axis] < 0 ? 0 : (cell[axis] >= cells ? cells - 1 : cell[axis]);
+	}
+	int index = 0;
+	for(int l = 0; l < level; l++){
+		int bit = level - 1 - l;
+		int child = ((cell[0] >> bit) & 1) |
+		            (((cell[1] >> bit) & 1) << 1) |
+		            (((cell[2] >> bit) & 1) << 2);
+		index += 1 + child * this->subtreeSize[l + 1];
+	}
+	return index;
+}
+
+//an object stays in its node while its box is inside the loose bounds
+bool Octree::entryFits(struct octreeEntry* entry){
+	if(entry->node == OCTREE_NONE){
+		return this->findNode(entry->min,entry->max) == OCTREE_NONE;
+	}
+	struct octant* node = &(this->nodes[entry->node]);
+	GLfloat loose = node->halfSize * OCTREE_LOOSENESS;
+	for(int axis = 0; axis < 3; axis++){
+		if(entry->min[axis] < node->center[axis] - loose ||
+		   entry->max[axis] > node->center[axis] + loose){
+			return false;
+		}
+	}
+	return true;
+}
+
+void Octree::readBounds(struct octreeEntry* entry){
+	BoundingBox box = ((Mesh*)(entry->object))->getBoundingBox();
+	entry->min[0] = box->x[0];
+	entry->min[1] = box->y[0];
+	entry->min[2] = box->z[0];
+	entry->max[0] = box->x[1];
+	entry->max[1] = box->y[1];
+	entry->max[2] = box->z[1];
+	entry->version = entry->object->getWorldVersion();
+}
+
+//entries are pushed at the head of the node list, the branch counts of
+//every ancestor follow so empty subtrees are still skipped when culling
+void Octree::link(int index, int node){
+	struct octreeEntry* entry = &(this->entries[index]);
+	GLint* head = node == OCTREE_NONE ? &(this->overflowHead) : &(this->nodes[node].firstEntry);
+	entry->node = node;
+	entry->prev = OCTREE_NONE;
+	entry->next = *head;
+	if(*head != OCTREE_NONE){
+		this->entries[*head].prev = index;
+	}
+	*head = index;
+	if(node == OCTREE_NONE){
+		this->numOverflow++;
+		return;
+	}
+	this->nodes[node].numObjects++;
+	for(int ancestor = node; ancestor != OCTREE_NONE; ancestor = this->nodes[ancestor].parent){
+		this->nodes[ancestor].branchObjects++;
+	}
+}
+
+void Octree::unlink(int index){
+	struct octreeEntry* entry = &(this->entries[index]);
+	GLint* head = entry->node == OCTREE_NONE ? &(this->overflowHead) : &(this->nodes[entry->node].firstEntry);
+	if(entry->prev != OCTREE_NONE){
+		this->entries[entry->prev].next = entry->next;
+	}
+	else{
+		*head = entry->next;
+	}
+	if(entry->next != OCTREE_NONE){
+		this->entries[entry->next].prev = entry->prev;
+	}
+	if(entry->node == OCTREE_NONE){
+		this->numOverflow--;
+		return;
+	}
+	this->nodes[entry->node].numObjects--;
+	for(int ancestor = entry->node; ancestor != OCTREE_NONE; ancestor = this->nodes[ancestor].parent){
+		this->nodes[ancestor].branchObjects--;
+	}
+}
+
+void Octree::build(list<Object3D*>& objects){
+	int numNodes = this->nodes.size();
+	for(int i = 0; i < numNodes; i++){
+		this->nodes[i].firstEntry = OCTREE_NONE;
+		this->nodes[i].numObjects = 0;
+		this->nodes[i].branchObjects = 0;
+	}
+	this->overflowHead = OCTREE_NONE;
+	this->numOverflow = 0;
+	this->entries.resize(objects.size());
+	list<Object3D*>::iterator it = objects.begin();
+	for(int i = 0; it != objects.end(); i++, it++){
+		struct octreeEntry* entry = &(this->entries[i]);
+		entry->object = *it;
+		this->readBounds(entry);
+		this->link(i,this->findNode(entry->min,entry->max));
+	}
+}
+
+//batched once per frame: only objects whose world matrix changed read
+//their bounds again and only those that left their node are relinked,
+//returns how many were relinked
+int Octree::update(){
+	this->stats.objectsUpdated = 0;
+	this->stats.objectsMoved = 0;
+	int numEntries = this->entries.size();
+	for(int i = 0; i < numEntries; i++){
+		struct octreeEntry* entry = &(this->entries[i]);
+		if(entry->object->getWorldVersion() == entry->version) continue;
+		this->readBounds(entry);
+		this->stats.objectsUpdated++;
+		if(this->entryFits(entry)) continue;
+		this->unlink(i);
+		this->link(i,this->findNode(entry->min,entry->max));
+		this->stats.objectsMoved++;
+	}
+	return this->stats.objectsMoved;
+}
+
+void Octree::testObjects(const Frustum& frustum, int first, int mask, vector<Object3D*>& visible){
+	for(int i = first; i != OCTREE_NONE; i = this->entries[i].next){
+		struct octreeEntry* entry = &(this->entries[i]);
+		if(frustum.classifyBounds(entry->min,entry->max,mask) != FRUSTUM_OUTSIDE){
+			visible.push_back(entry->object);
+		}
+		this->stats.objectsTested++;
+	}
+}
+
+//every object of a subtree that is completely inside the frustum
+void Octree::appendBranch(int node, vector<Object3D*>& visible){
+	int end = node + this->subtreeSize[this->nodes[node].level];
+	int i = node;
+	while(i < end){
+		struct octant* current = &(this->nodes[i]);
+		if(current->branchObjects == 0){
+			i += this->subtreeSize[current->level];
+			continue;
+		}
+		for(int e = current->firstEntry; e != OCTREE_NONE; e = this->entries[e].next){
+			visible.push_back(this->entries[e].object);
+		}
+		i++;
+	}
+}
+
+//one linear pass over the nodes, a culled, empty or fully visible node
+//skips its whole subtree and planes a parent is inside of are not tested
+//again for its children, nodes are tested with their loose bounds
+int Octree::cull(const Frustum& frustum, vector<Object3D*>& visible){
+	int masks[OCTREE_MAX_DEPTH + 2];
+	int numNodes = this->nodes.size();
+	visible.clear();
+	this->stats.nodesVisited = 0;
+	this->stats.objectsTested = 0;
+	masks[0] = FRUSTUM_ALL_PLANES;
+	int i = 0;
+	while(i < numNodes){
+		struct octant* node = &(this->nodes[i]);
+		if(node->branchObjects == 0){
+			i += this->subtreeSize[node->level];
+			continue;
+		}
+		this->stats.nodesVisited++;
+		GLfloat loose = node->halfSize * OCTREE_LOOSENESS;
+		GLfloat halfSize[3] = {loose,loose,loose};
+		int mask = frustum.classifyBox(node->center,halfSize,masks[node->level]);
+		if(mask == FRUSTUM_OUTSIDE){
+			i += this->subtreeSize[node->level];
+			continue;
+		}
+		if(mask == 0){
+			this->appendBranch(i,visible);
+			i += this->subtreeSize[node->level];
+			continue;
+		}
+		this->testObjects(frustum,node->firstEntry,mask,visible);
+		masks[node->level + 1] = mask;
+		i++;
+	}
+	this->testObjects(frustum,this->overflowHead,FRUSTUM_ALL_PLANES,visible);
+	this->stats.visibleObjects = visible.size();
+	return visible.size();
+}
+
+int Octree::getDepth(){
+	return this->depth;
+}
+
+//regenerates the nodes, build has to be called again
+void Octree::setDepth(int depth){
+	this->depth = depth < 0 ? 0 : (depth > OCTREE_MAX_DEPTH ? OCTREE_MAX_DEPTH : depth);
+	this->generateNodes();
+}
+
+float Octree::getSize(){
+	return this->size;
+}
+
+int Octree::getNumNodes(){
+	return this->nodes.size();
+}
+
+int Octree::getNumObjects(){
+	return this->entries.size();
+}
+
+Octant Octree::getNode(int index){
+	return &(this->nodes[index]);
+}
+
+CullStats Octree::getStats(){
+	return &(this->stats);
+}
+
+void Octree::print(){
+	int numNodes = this->nodes.size();
+	int i = 0;
+	while(i < numNodes){
+		struct octant* node = &(this->nodes[i]);
+		if(node->branchObjects == 0){
+			i += this->subtreeSize[node->level];
+			continue;
+		}
+		for(int level = 0; level < node->level; level++){
+			printf("  ");
+		}
+		printf("node:%d\tobjects:%d branch:%d\n",i,node->numObjects,node->branchObjects);
+		i++;
+	}
+	printf("outside root:%d\n",this->numOverflow);
+}
@@ -5,16 +5,13 @@ using namespace std;
 
 Scene::Scene(){
 	this->camera = new Camera();
-	Mat4* mat = this->camera->getProjectionMatrix(); 
 	this->camera->setProjectionMatrix(Mat4::perspectiveMatrix(30.0, 1280.0/720.0, 0.1, 100.0));
-	delete mat;
 	this->camera->getPosition()->setZ(12.0);
 	this->ambientLight = new Light();
 	this->ambientLight->getColor()->setRGB(0.01,0.01,0.01);
-	this->directionalLightsUBO = 0;
-	this->pointLightsUBO=0;
-	this->ambientLightUBO = 0;
-	this->octree = new OctreeNode(new Vec3(0,0,0),128);
+	this->octree = new Octree(Vec3(0,0,0),128);
+	this->octreeDirty = true;
+	this->matrixFrame = 0;
 }
 
 list<Object3D*> Scene::getObjects(){
@@ -36,6 +33,7 @@ void Scene::addDirectionalLight(DirectionalLight* light){
 void Scene::addObject(Object3D* o){
 	if(find(this->objects.begin(),this->objects.end(), o) == this->objects.end()){
 		this->objects.push_back(o);
+		this->octreeDirty = true;
 		//this->addedObjects.push_back(o);
 
 		list<Object3D*>::iterator it = find(this->removedObjects.begin(),this->removedObjects.end(),o);
@@ -50,6 +48,7 @@ void Scene::removeObject(Object3D* o){
 	list<Object3D*>::iterator it = find(this->objects.begin(),this->objects.end(), o);
 	if(it != this->objects.end()){
 		this->objects.erase(it);
+		this->octreeDirty = true;
 		this->removedObjects.push_back(o);
 
 		it = find(this->addedObjects.begin(),this->addedObjects.end(), o);
@@ -75,27 +74,11 @@ void Scene::setAmbientLight(Light* ambientLight){
 	this->ambientLight = ambientLight;
 }
 
-list<DirectionalLight*> Scene::getDirectionalLights(){
+list<DirectionalLight*>& Scene::getDirectionalLights(){
 	return this->directionalLights;
 }
 
-GLuint Scene::getDirectionalLightsUBO(){
-	return this->directionalLightsUBO;
-}
-
-GLuint Scene::getAmbientLightUBO(){
-	return this->ambientLightUBO;
-}
-
-void Scene::setDirectionalLightsUBO(GLuint directionalLightsUBO){
-	this->directionalLightsUBO = directionalLightsUBO;
-}
-
-void Scene::setAmbientLightUBO(GLuint ambientLightUBO){
-	this->ambientLightUBO = ambientLightUBO;
-}
-
-list<PointLight*> Scene::getPointLights(){
+list<PointLight*>& Scene::getPointLights(){
 	return this->pointLights;
 }
 
@@ -103,15 +86,7 @@ void Scene::addPointLight(PointLight* pointLight){
 	this->pointLights.push_back(pointLight);
 }
 
-GLuint Scene::getPointLightsUBO(){
-	return this->pointLightsUBO;
-}
-
-void Scene::setPointLightsUBO(GLuint pointLightsUBO){
-	this->pointLightsUBO = pointLightsUBO;
-}
-
-OctreeNode* Scene::getOctree(){
+Octree* Scene::getOctree(){
 	return this->octree;
 }
 
@@ -154,14 +129,52 @@ Scene::~Scene(){
 	if(this->ambientLight != NULL){
 		delete (this->ambientLight);
 	}
+	delete this->octree;
 }
 
 void Scene::generateOctree(){
-	list<Object3D*> objects = this->objects;
-	list<Object3D*>::iterator it = objects.begin();
-	list<Object3D*>::iterator end = objects.end();
-	for(;it != end;it++){
-		this->octree->addObject(*it);
+	this->octree->build(this->objects);
+	this->octreeDirty = false;
+}
+
+Frustum* Scene::getFrustum(){
+	return &(this->frustum);
+}
+
+//objects whose bounds touch the camera frustum, the camera world matrix and
+//every model matrix have to be up to date, moved objects are updated in the
+//octree here and a full build only happens when objects were added or removed
+int Scene::cullObjects(vector<Object3D*>& visible){
+	if(this->octreeDirty){
+		this->generateOctree();
+	}
+	else{
+		this->octree->update();
 	}
-	this->octree->generateTreeMesh();
+	this->frustum.setFromMatrix(*(this->camera->getProjectionMatrix()) * *(this->camera->getWorldMatrix()));
+	int numVisible = this->octree->cull(this->frustum,visible);
+	Vec3* cameraPosition = this->camera->getPosition();
+	for(int i = 0; i < numVisible; i++){
+		const GLfloat* model = visible[i]->getModelMatrix()->getElements();
+		visible[i]->setDistanceToCamera(cameraPosition->distance(Vec3(model[3],model[7],model[11])));
+	}
+	return numVisible;
 }
+
+//one top-down pass per frame: each root is updated once together with its
+//children, however many of them were added to the scene
+void Scene::updateMatrices(){
+	this->matrixFrame++;
+	list<Object3D*>::iterator it = this->objects.begin();
+	list<Object3D*>::iterator end = this->objects.end();
+	for(;it != end;it++){
+		Object3D* root = *it;
+		while(root->getParent() != NULL){
+			root = root->getParent();
+		}
+		if(root->getUpdateFrame() != this->matrixFrame){
+			root->setUpdateFrame(this->matrixFrame);
+			root->updateMatrixHierarchy();
+		}
+	}
+}
\ No newline at end of file